@@ -0,0 +1,51 @@
+#ifndef APP_COMPONENTS_HPP
+#define APP_COMPONENTS_HPP
+
+#include <rg/renderer/model/BoundingSphere.hpp>
+#include <rg/renderer/model/Model.hpp>
+#include <rg/renderer/model/Transform.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <memory>
+
+namespace app {
+
+// Entities are positioned with an rg::Transform component, and cameras are
+// stored as app::Camera components.
+
+struct Renderable {
+    std::shared_ptr<rg::Model> model;
+    float shininess = 32.0f;
+};
+
+// Derived from the Transform of a Renderable once per frame, so that every
+// camera can share it
+struct WorldTransform {
+    glm::mat4 model_matrix{1.0f};
+    glm::mat4 normal_matrix{1.0f};
+    rg::BoundingSphere bounds;
+};
+
+// Renderables which are drawn with the light shader in a flat color
+struct Emissive {
+    glm::vec3 color{1.0f};
+};
+
+struct RigidBody {
+    glm::vec3 velocity{0.0f}; // meters per second
+    float radius = 0.25f;     // meters
+};
+
+// Attaches a spotlight from the light subsystem to an entity
+struct Light {
+    unsigned int spotlight = 0;
+    // Relative to the entity's transform
+    glm::vec3 offset{0.0f};
+    glm::vec3 direction{0.0f, 0.0f, -1.0f};
+};
+
+} // namespace app
+
+#endif // APP_COMPONENTS_HPP
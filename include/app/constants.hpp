@@ -1,15 +1,19 @@
 #ifndef RG_CONSTANTS_HPP
 #define RG_CONSTANTS_HPP
 
+#include <cstddef>
 #include <string>
 
 namespace app {
 
 extern const char* TITLE;
+extern const char* SCENE; // relative to the resource directory
 extern const unsigned int WINDOW_WIDTH;
 extern const unsigned int WINDOW_HEIGHT;
 extern const float CAMERA_SPEED; // meters per second
 extern const float CAMERA_SENSITIVITY;
+extern const std::size_t UPLOAD_RING_SIZE; // bytes
+extern const std::size_t TEXTURE_BUDGET;   // bytes
 
 } // namespace app
 
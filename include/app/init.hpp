@@ -2,13 +2,15 @@
 #define RG_INIT_HPP
 
 #include <app/state.hpp>
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+#include <rg/scene/SceneFile.hpp>
 
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 
 namespace app {
 
-void init();
+void init(const std::string& scene_path);
 
 // Graphics
 // ---------
@@ -25,16 +27,17 @@ void APIENTRY glDebugOutput(GLenum source, GLenum type, unsigned int id,
 
 // Scene initialization
 // --------------------
-void initScene();
+void initScene(const rg::scene::SceneFile& scene);
 void initObjects();
-void initCameras();
-void initShaders();
+void initCameras(const rg::scene::SceneFile& scene);
+void initShaders(rg::ShaderCompiler& compiler);
+void finishShaders(rg::ShaderCompiler& compiler);
 void initSkybox();
-void initModels();
-void setScene();
-void placeCameras();
-void placeObjects();
-void placeLights();
+void initModels(const rg::scene::SceneFile& scene);
+void setScene(const rg::scene::SceneFile& scene);
+void placeCameras(const rg::scene::SceneFile& scene);
+void placeObjects(const rg::scene::SceneFile& scene);
+void placeLights(const rg::scene::SceneFile& scene);
 
 // Callbacks
 // ---------
@@ -48,6 +51,8 @@ namespace util {
 
 std::string resource(const std::string& path);
 std::string readFile(const std::string& path);
+// In one batch, empty where a file could not be read
+std::vector<std::string> readFiles(const std::vector<std::string>& paths);
 
 } // namespace util
 
@@ -0,0 +1,35 @@
+#ifndef APP_SNAPSHOT_HPP
+#define APP_SNAPSHOT_HPP
+
+#include <rg/renderer/DrawList.hpp>
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/light/lights.hpp>
+
+#include <array>
+#include <vector>
+
+namespace app {
+
+// Everything the render thread needs to draw one simulated frame. Written by
+// the simulation thread and never modified once published.
+struct FrameSnapshot {
+    unsigned long frame = 0;
+
+    std::array<rg::View, 4> views;
+    unsigned int active_camera = 0;
+    bool multiple_cameras = true;
+    // With culling on the GPU, draw_lists[0] holds every renderable and is
+    // shared by all the cameras
+    bool gpu_culling = false;
+
+    std::vector<rg::DirectionalLight> directional_lights;
+    std::vector<rg::PointLight> point_lights;
+    std::vector<rg::SpotLight> spotlights;
+
+    // Only the lists of the cameras being shown are filled
+    std::array<rg::DrawList, 4> draw_lists;
+};
+
+} // namespace app
+
+#endif // APP_SNAPSHOT_HPP
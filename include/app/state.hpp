@@ -3,18 +3,37 @@
 
 #include <GLFW/glfw3.h>
 
+#include <app/components.hpp>
 #include <app/constants.hpp>
-#include <app/objects/Ball.hpp>
+#include <app/snapshot.hpp>
 #include <app/objects/Camera.hpp>
-#include <app/objects/Floor.hpp>
-#include <app/objects/Lamp.hpp>
+#include <rg/ecs/Registry.hpp>
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/jobs/TripleBuffer.hpp>
+#include <rg/renderer/LodSelector.hpp>
+#include <rg/renderer/command/CommandBuffer.hpp>
+#include <rg/renderer/command/CommandSubmitter.hpp>
+#include <rg/renderer/buffer/GeometryArena.hpp>
+#include <rg/renderer/buffer/UploadRing.hpp>
+#include <rg/renderer/camera/DepthPyramid.hpp>
 #include <rg/renderer/camera/Surface.hpp>
 #include <rg/renderer/light/lights.hpp>
+#include <rg/renderer/model/AssetReloader.hpp>
+#include <rg/renderer/model/MaterialLibrary.hpp>
 #include <rg/renderer/model/Model.hpp>
+#include <rg/renderer/model/ModelCache.hpp>
 #include <rg/renderer/model/Skybox.hpp>
+#include <rg/renderer/shader/ProgramCache.hpp>
 #include <rg/renderer/shader/Shader.hpp>
+#include <rg/renderer/shader/ShaderReloader.hpp>
+#include <rg/renderer/shader/ShaderVariants.hpp>
+#include <rg/util/ResourcePack.hpp>
 
 #include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace app {
@@ -27,8 +46,14 @@ struct TimeState {
 };
 
 struct CameraState {
-    std::array<Camera*, 4> cameras{nullptr};
+    // Entities holding the Camera components
+    std::array<rg::ecs::Entity, 4> cameras{rg::ecs::NULL_ENTITY,
+                                           rg::ecs::NULL_ENTITY,
+                                           rg::ecs::NULL_ENTITY,
+                                           rg::ecs::NULL_ENTITY};
     std::array<rg::Surface*, 4> surfaces{nullptr};
+    // Built from the depth of the surfaces, for occlusion culling
+    std::array<rg::DepthPyramid*, 4> depth_pyramids{nullptr};
     unsigned int active_camera = 0;
     bool multiple_cameras = true;
 
@@ -46,9 +71,6 @@ struct CameraState {
 
     Behaviour behaviour;
 
-    Camera& get_active_camera();
-    [[nodiscard]] const Camera& get_active_camera() const;
-
     ~CameraState();
 };
 
@@ -66,6 +88,8 @@ struct LightState {
     std::vector<rg::DirectionalLight>* directional{nullptr};
     std::vector<rg::PointLight>* point{nullptr};
     std::vector<rg::SpotLight>* spotlight{nullptr};
+    // Index of the spotlight which follows the active camera, -1 if none
+    int camera_spotlight = -1;
 
     ~LightState();
 };
@@ -80,30 +104,83 @@ struct State {
     MouseState mouse_subsystem;
     LightState light_subsystem;
 
-    // The shader used to draw most objects
-    rg::Shader* shader = nullptr;
+    // The resources mapped from a single file, if it was built
+    rg::util::ResourcePack* resource_pack = nullptr;
+
+    // Linked programs saved between runs
+    rg::ProgramCache* program_cache = nullptr;
+    // Rebuilds the shaders when their sources change
+    rg::ShaderReloader* shader_reloader = nullptr;
+    // The variants of the shader used to draw most objects
+    rg::ShaderVariants* shaders = nullptr;
     // The shader used to draw skyboxes
     rg::Shader* skybox_shader = nullptr;
     // The shader used to draw framebuffers
     rg::Shader* surface_shader = nullptr;
     // The shader used to draw light sources
     rg::Shader* light_shader = nullptr;
+    // The compute shader which culls the draws on the GPU
+    rg::Shader* cull_shader = nullptr;
+    // The compute shader which builds the depth pyramids
+    rg::Shader* depth_pyramid_shader = nullptr;
+    // The compute shaders of the post chains: bloom, then the composite
+    // which maps the surfaces to the screen
+    rg::Shader* bloom_shader = nullptr;
+    rg::Shader* post_shader = nullptr;
 
     rg::Skybox* skybox = nullptr;
 
-    Ball* ball = nullptr;
-    Lamp* lamp = nullptr;
-    Floor* floor = nullptr;
+    // Vertices and indices of every model
+    rg::GeometryArena* geometry = nullptr;
+    // Staging memory for the textures streamed in by the material library
+    rg::UploadRing* upload_ring = nullptr;
+    // Textures and materials of every model
+    rg::MaterialLibrary* materials = nullptr;
+    // Imported and optimized models saved between runs
+    rg::ModelCache* model_cache = nullptr;
+    // Models shared between the entities, by name
+    std::unordered_map<std::string, std::shared_ptr<rg::Model>> models;
+    // Reloads the models and textures when their files change
+    rg::AssetReloader* asset_reloader = nullptr;
+    // All objects in the scene and their components
+    rg::ecs::Registry registry;
+
+    // Runs the per-frame systems across the cores; created on the thread
+    // which owns the GL context
+    rg::JobSystem* jobs = nullptr;
+    // Frames travel from the simulation thread to the render thread here
+    rg::TripleBuffer<FrameSnapshot> frames;
+    // Guards the input written by the callbacks on the render thread and
+    // consumed by the simulation thread: the camera behaviour, deltas and
+    // selection, enable_simulation and gpu_culling
+    std::mutex input_mutex;
+    // Recorded from the draw lists on the workers
+    std::array<rg::CommandBuffer, 4> command_buffers;
+    // The levels of detail of each camera's items
+    std::array<rg::LodSelector, 4> lod_selectors;
+    // Replays the command buffers on the GL thread
+    rg::CommandSubmitter* submitter = nullptr;
 
     // Controls whether the physics simulation will happen
     // in the current frame
     bool enable_simulation = true;
+    // Controls whether the scene is drawn with multi draw indirect or with a
+    // draw per mesh. Only used on the render thread.
+    bool multi_draw_indirect = true;
+    // Controls whether the draws are culled on the GPU, against the frustum
+    // and the previous frame's depth, instead of on the CPU. Implies multi
+    // draw indirect.
+    bool gpu_culling = false;
 
 #ifdef ENABLE_DEBUG
     rg::Model* debug_cube;
     rg::Shader* debug_shader;
 #endif // ENABLE_DEBUG
 
+    Camera& get_camera(unsigned int index);
+    Camera& get_active_camera();
+    [[nodiscard]] const Camera& get_active_camera() const;
+
     ~State();
 };
 
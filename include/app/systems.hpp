@@ -0,0 +1,41 @@
+#ifndef APP_SYSTEMS_HPP
+#define APP_SYSTEMS_HPP
+
+#include <app/components.hpp>
+#include <rg/ecs/Registry.hpp>
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/renderer/DrawList.hpp>
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/light/lights.hpp>
+
+#include <vector>
+
+namespace app {
+
+void physicsSystem(rg::ecs::Registry& registry, rg::JobSystem& jobs,
+                   float delta);
+/**
+ * Move the spotlights attached to entities along with them and tint the
+ * emissive parts of those entities to match the light.
+ */
+void lightSystem(rg::ecs::Registry& registry,
+                 std::vector<rg::SpotLight>& spotlights);
+/**
+ * Update the WorldTransform of every renderable from its Transform.
+ */
+void transformSystem(rg::ecs::Registry& registry, rg::JobSystem& jobs);
+/**
+ * Fill the list with the renderables visible from the view. Only reads the
+ * registry, so several views can be culled at the same time.
+ */
+void cullSystem(const rg::ecs::Registry& registry, const rg::View& view,
+                rg::JobSystem& jobs, rg::DrawList& list);
+/**
+ * Fill the list with every renderable, for culling on the GPU.
+ */
+void collectSystem(const rg::ecs::Registry& registry, rg::JobSystem& jobs,
+                   rg::DrawList& list);
+
+} // namespace app
+
+#endif // APP_SYSTEMS_HPP
@@ -0,0 +1,115 @@
+#ifndef RG_ECS_POOL_HPP
+#define RG_ECS_POOL_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rg::ecs {
+
+using Entity = std::uint32_t;
+inline constexpr Entity NULL_ENTITY = std::numeric_limits<Entity>::max();
+
+/**
+ * Sparse set of entities. The dense array holds the entities packed together
+ * and the sparse array maps an entity to its slot in the dense array, so
+ * lookups are O(1) and iteration only touches live elements.
+ */
+class SparseSet {
+public:
+    SparseSet() = default;
+    SparseSet(const SparseSet& other) = delete;
+    SparseSet operator=(const SparseSet& other) = delete;
+    virtual ~SparseSet() = default;
+
+    [[nodiscard]] bool contains(Entity entity) const;
+    [[nodiscard]] std::size_t index(Entity entity) const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] const std::vector<Entity>& entities() const;
+
+    virtual void remove(Entity entity) = 0;
+
+protected:
+    /**
+     * Append the entity to the dense array.
+     * @return the slot the entity now occupies
+     */
+    std::size_t insert(Entity entity);
+    /**
+     * Swap the entity with the last one in the dense array and pop it.
+     * @return the slot the entity occupied before removal
+     */
+    std::size_t erase(Entity entity);
+
+private:
+    static constexpr std::size_t EMPTY = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t> sparse_;
+    std::vector<Entity> dense_;
+};
+
+/**
+ * Contiguous storage for all components of type T. Components are stored in
+ * the same order as the entities in the dense array of the sparse set.
+ */
+template <class T>
+class Pool : public SparseSet {
+public:
+    // Replaces the component in place if the entity already has one
+    template <class... Args>
+    T& emplace(Entity entity, Args&&... args) {
+        if (contains(entity)) {
+            T& component = components_[index(entity)];
+            component = make(std::forward<Args>(args)...);
+            return component;
+        }
+
+        insert(entity);
+        if constexpr (std::is_aggregate_v<T>)
+            components_.push_back(T{std::forward<Args>(args)...});
+        else
+            components_.emplace_back(std::forward<Args>(args)...);
+        return components_.back();
+    }
+
+    void remove(Entity entity) override {
+        std::size_t slot = erase(entity);
+        if (slot != components_.size() - 1)
+            components_[slot] = std::move(components_.back());
+        components_.pop_back();
+    }
+
+    T& get(Entity entity) {
+        return components_[index(entity)];
+    }
+
+    [[nodiscard]] const T& get(Entity entity) const {
+        return components_[index(entity)];
+    }
+
+    std::vector<T>& components() {
+        return components_;
+    }
+
+    [[nodiscard]] const std::vector<T>& components() const {
+        return components_;
+    }
+
+private:
+    std::vector<T> components_;
+
+    template <class... Args>
+    static T make(Args&&... args) {
+        if constexpr (std::is_aggregate_v<T>)
+            return T{std::forward<Args>(args)...};
+        else
+            return T(std::forward<Args>(args)...);
+    }
+};
+
+} // namespace rg::ecs
+
+#endif // RG_ECS_POOL_HPP
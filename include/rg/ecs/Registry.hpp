@@ -0,0 +1,129 @@
+#ifndef RG_ECS_REGISTRY_HPP
+#define RG_ECS_REGISTRY_HPP
+
+#include <rg/ecs/Pool.hpp>
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace rg::ecs {
+
+namespace detail {
+
+std::size_t nextTypeIndex();
+
+template <class T>
+std::size_t typeIndex() {
+    static const std::size_t index = nextTypeIndex();
+    return index;
+}
+
+} // namespace detail
+
+class Registry {
+public:
+    Registry() = default;
+    Registry(const Registry& other) = delete;
+    Registry operator=(const Registry& other) = delete;
+
+    Entity create();
+    /**
+     * Remove all components of the entity and recycle its id. Handles to a
+     * destroyed entity must not be used afterwards.
+     */
+    void destroy(Entity entity);
+    [[nodiscard]] bool valid(Entity entity) const;
+    [[nodiscard]] std::size_t alive() const;
+
+    template <class T, class... Args>
+    T& emplace(Entity entity, Args&&... args) {
+        return pool<T>().emplace(entity, std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    void remove(Entity entity) {
+        auto& p = pool<T>();
+        if (p.contains(entity))
+            p.remove(entity);
+    }
+
+    template <class T>
+    [[nodiscard]] bool has(Entity entity) const {
+        const auto* p = find<T>();
+        return p != nullptr && p->contains(entity);
+    }
+
+    template <class T>
+    T& get(Entity entity) {
+        return pool<T>().get(entity);
+    }
+
+    template <class T>
+    [[nodiscard]] const T& get(Entity entity) const {
+        return find<T>()->get(entity);
+    }
+
+    template <class T>
+    Pool<T>& pool() {
+        std::size_t index = detail::typeIndex<T>();
+        if (index >= pools_.size())
+            pools_.resize(index + 1);
+        if (pools_[index] == nullptr)
+            pools_[index] = std::make_unique<Pool<T>>();
+        return static_cast<Pool<T>&>(*pools_[index]);
+    }
+
+    /**
+     * @return the pool for T, or nullptr if no T was ever emplaced
+     */
+    template <class T>
+    [[nodiscard]] const Pool<T>* find() const {
+        std::size_t index = detail::typeIndex<T>();
+        if (index >= pools_.size())
+            return nullptr;
+        return static_cast<const Pool<T>*>(pools_[index].get());
+    }
+
+    /**
+     * Call f(entity, t, rest...) for every entity that has all of the listed
+     * components. Iteration walks the dense arrays of T in order, so T should
+     * be the component with the fewest instances.
+     */
+    template <class T, class... Rest, class F>
+    void each(F&& f) {
+        auto& main = pool<T>();
+        auto rest = std::forward_as_tuple(pool<Rest>()...);
+        const auto& entities = main.entities();
+        auto& components = main.components();
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+            Entity e = entities[i];
+            if ((std::get<Pool<Rest>&>(rest).contains(e) && ...))
+                f(e, components[i], std::get<Pool<Rest>&>(rest).get(e)...);
+        }
+    }
+
+    template <class T, class... Rest, class F>
+    void each(F&& f) const {
+        const auto* main = find<T>();
+        if (main == nullptr || ((find<Rest>() == nullptr) || ...))
+            return;
+
+        const auto& entities = main->entities();
+        const auto& components = main->components();
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+            Entity e = entities[i];
+            if ((find<Rest>()->contains(e) && ...))
+                f(e, components[i], find<Rest>()->get(e)...);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<SparseSet>> pools_;
+    std::vector<Entity> free_;
+    std::vector<bool> alive_;
+};
+
+} // namespace rg::ecs
+
+#endif // RG_ECS_REGISTRY_HPP
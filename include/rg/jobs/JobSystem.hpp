@@ -0,0 +1,148 @@
+#ifndef RG_JOBS_JOBSYSTEM_HPP
+#define RG_JOBS_JOBSYSTEM_HPP
+
+#include <rg/jobs/WorkStealingDeque.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rg {
+
+class JobCounter;
+
+namespace detail {
+
+struct Job {
+    std::function<void()> task;
+    JobCounter* counter;
+};
+
+} // namespace detail
+
+/**
+ * Counts the unfinished jobs of a group. Jobs started with a counter
+ * increment it, and decrement it once they are done, so waiting on the
+ * counter waits on every job of the group. Jobs which depend on the group
+ * are held on the counter and queued once it drops to zero.
+ */
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter& other) = delete;
+    JobCounter operator=(const JobCounter& other) = delete;
+    // Waits for the job which brought the counter to zero to let go of it
+    ~JobCounter();
+
+    [[nodiscard]] bool done() const {
+        return pending_.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<unsigned int> pending_{0};
+    // The last job of the group decrements under the lock, so that a
+    // dependent job is either held here before it or sees the counter done
+    mutable std::mutex mutex_;
+    mutable std::vector<detail::Job*> continuations_;
+};
+
+/**
+ * A pool of worker threads, each with its own work-stealing deque. The thread
+ * that creates the system owns a deque as well and takes part in the work
+ * while it waits. Any other thread may submit jobs, which are then handed to
+ * the workers through a shared queue.
+ */
+class JobSystem {
+public:
+    /**
+     * @param workers The number of background threads, 0 runs every job on
+     * the waiting thread
+     */
+    explicit JobSystem(unsigned int workers = defaultWorkerCount());
+    JobSystem(const JobSystem& other) = delete;
+    JobSystem operator=(const JobSystem& other) = delete;
+    ~JobSystem();
+
+    // One less than the number of hardware threads, leaving a core for the
+    // thread which owns the GL context
+    static unsigned int defaultWorkerCount();
+
+    [[nodiscard]] unsigned int worker_count() const;
+
+    void run(std::function<void()> job, JobCounter& counter);
+    /**
+     * Run the job once every job counted by the dependency has finished.
+     * Until then it is held on the dependency rather than queued, so no
+     * thread blocks on its behalf.
+     */
+    void run_after(const JobCounter& dependency, std::function<void()> job,
+                   JobCounter& counter);
+    /**
+     * Execute pending jobs on the calling thread until the counter drops to
+     * zero. Safe to call from inside a job.
+     */
+    void wait(const JobCounter& counter);
+
+    /**
+     * Call f(begin, end) over [0, count) split into chunks of at most grain
+     * elements, and wait for all of them.
+     */
+    template <class F>
+    void parallel_for(std::size_t count, std::size_t grain, F&& f) {
+        if (count == 0)
+            return;
+        grain = std::max<std::size_t>(grain, 1);
+        if (count <= grain || workers_.empty()) {
+            f(std::size_t{0}, count);
+            return;
+        }
+
+        JobCounter counter;
+        // The calling thread takes the first chunk itself
+        for (std::size_t begin = grain; begin < count; begin += grain) {
+            std::size_t end = std::min(begin + grain, count);
+            run([&f, begin, end] { f(begin, end); }, counter);
+        }
+        f(std::size_t{0}, grain);
+        wait(counter);
+    }
+
+private:
+    using Job = detail::Job;
+
+    using Deque = WorkStealingDeque<Job*>;
+
+    // Index 0 belongs to the thread that created the system
+    std::vector<std::unique_ptr<Deque>> deques_;
+    std::vector<std::thread> workers_;
+
+    // Jobs submitted from threads that do not own a deque
+    std::mutex shared_mutex_;
+    std::deque<Job*> shared_;
+
+    std::atomic<int> queued_{0};
+    std::atomic<bool> stop_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    void submit(Job* job);
+    void execute(Job* job);
+    // Decrement the counter and queue its held jobs if it dropped to zero
+    void finish(JobCounter& counter);
+    Job* take(int own);
+    void work(int index);
+    [[nodiscard]] int deque_index() const;
+};
+
+} // namespace rg
+
+#endif // RG_JOBS_JOBSYSTEM_HPP
@@ -0,0 +1,69 @@
+#ifndef RG_JOBS_TRIPLEBUFFER_HPP
+#define RG_JOBS_TRIPLEBUFFER_HPP
+
+#include <array>
+#include <atomic>
+
+namespace rg {
+
+/**
+ * Hands values from one producer thread to one consumer thread without
+ * locking. The producer always has a buffer to write into and the consumer
+ * always reads the latest complete one; values the consumer never got to
+ * are dropped.
+ */
+template <class T>
+class TripleBuffer {
+public:
+    TripleBuffer() : buffers_{}, middle_{1}, write_{0}, read_{2} {
+    }
+
+    TripleBuffer(const TripleBuffer& other) = delete;
+    TripleBuffer operator=(const TripleBuffer& other) = delete;
+
+    // Producer
+    // --------
+
+    T& write_buffer() {
+        return buffers_[write_];
+    }
+
+    // Make the write buffer the latest value and continue in an older one
+    void publish() {
+        write_ = middle_.exchange(write_ | FRESH, std::memory_order_acq_rel) &
+                 INDEX;
+    }
+
+    // Consumer
+    // --------
+
+    /**
+     * Switch the read buffer to the latest published value.
+     * @return false if nothing was published since the last call
+     */
+    bool acquire() {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        read_ = middle_.exchange(read_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    [[nodiscard]] const T& read_buffer() const {
+        return buffers_[read_];
+    }
+
+private:
+    static constexpr unsigned int INDEX = 0b011U;
+    static constexpr unsigned int FRESH = 0b100U;
+
+    std::array<T, 3> buffers_;
+    // Index of the buffer between the two threads, and whether it holds a
+    // value the consumer has not seen yet
+    std::atomic<unsigned int> middle_;
+    unsigned int write_;
+    unsigned int read_;
+};
+
+} // namespace rg
+
+#endif // RG_JOBS_TRIPLEBUFFER_HPP
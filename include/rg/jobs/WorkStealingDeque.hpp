@@ -0,0 +1,99 @@
+#ifndef RG_JOBS_WORKSTEALINGDEQUE_HPP
+#define RG_JOBS_WORKSTEALINGDEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace rg {
+
+/**
+ * Fixed-capacity Chase-Lev deque. The owning thread pushes and pops at the
+ * bottom, any other thread may steal from the top. Memory orderings follow
+ * Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+ *
+ * T must be a pointer type; nullptr is returned when there is nothing to take.
+ */
+template <class T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(std::int64_t capacity)
+            : top_{0}, bottom_{0}, capacity_{capacity}, mask_{capacity - 1},
+              buffer_{std::make_unique<std::atomic<T>[]>(capacity)} {
+        // capacity has to be a power of two for the index mask to work
+    }
+
+    WorkStealingDeque(const WorkStealingDeque& other) = delete;
+    WorkStealingDeque operator=(const WorkStealingDeque& other) = delete;
+
+    /**
+     * Owner only.
+     * @return false if the deque is full
+     */
+    bool push(T item) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= capacity_)
+            return false;
+
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Owner only. Takes the most recently pushed item.
+     */
+    T pop() {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last item, race against the thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /**
+     * Any thread. Takes the oldest item.
+     */
+    T steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        T item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<std::int64_t> top_;
+    alignas(64) std::atomic<std::int64_t> bottom_;
+    std::int64_t capacity_;
+    std::int64_t mask_;
+    std::unique_ptr<std::atomic<T>[]> buffer_;
+};
+
+} // namespace rg
+
+#endif // RG_JOBS_WORKSTEALINGDEQUE_HPP
@@ -0,0 +1,44 @@
+#ifndef RG_RENDERER_DRAWLIST_HPP
+#define RG_RENDERER_DRAWLIST_HPP
+
+#include <rg/renderer/model/Model.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rg {
+
+// Everything needed to draw a model without touching the scene, so draw lists
+// can be built away from the thread which owns the GL context.
+struct DrawItem {
+    // Stays the same across frames, for what is kept per item
+    std::uint32_t id;
+    const Model* model;
+    glm::mat4 model_matrix;
+    glm::mat4 normal_matrix;
+    float shininess;
+};
+
+struct EmissiveDrawItem {
+    std::uint32_t id;
+    const Model* model;
+    glm::mat4 model_matrix;
+    glm::vec3 color;
+};
+
+struct DrawList {
+    std::vector<DrawItem> lit;
+    std::vector<EmissiveDrawItem> emissive;
+
+    void clear() {
+        lit.clear();
+        emissive.clear();
+    }
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_DRAWLIST_HPP
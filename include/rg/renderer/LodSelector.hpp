@@ -0,0 +1,53 @@
+#ifndef RG_RENDERER_LODSELECTOR_HPP
+#define RG_RENDERER_LODSELECTOR_HPP
+
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/model/Mesh.hpp>
+#include <rg/renderer/model/Model.hpp>
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace rg {
+
+/**
+ * Picks the levels of detail of the items seen from a view, so that their
+ * simplification error stays under MAX_SCREEN_ERROR pixels. The scale an
+ * item was drawn at is kept until its size on the screen changes by more
+ * than HYSTERESIS, so items near a switching distance do not flicker between
+ * levels. One per view, used by one thread at a time.
+ */
+class LodSelector {
+public:
+    static constexpr float MAX_SCREEN_ERROR = 1.0f;
+    static constexpr float HYSTERESIS = 0.2f;
+
+    // Start a frame of the view, on a surface height pixels tall
+    void begin(const View& view, unsigned int height);
+    /**
+     * Pixels per model space unit of the item with the id, which has to stay
+     * the same across frames.
+     */
+    float scale(std::uint32_t id, const Model& model,
+                const glm::mat4& model_matrix);
+    // The level of the mesh of an item at the scale
+    [[nodiscard]] static std::uint32_t select(const Mesh& mesh, float scale);
+
+private:
+    struct Entry {
+        float scale;
+        std::uint64_t frame;
+    };
+
+    std::unordered_map<std::uint32_t, Entry> entries_;
+    View view_;
+    // Pixels per world space unit at a distance of one
+    float pixels_ = 0.0f;
+    std::uint64_t frame_ = 0;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_LODSELECTOR_HPP
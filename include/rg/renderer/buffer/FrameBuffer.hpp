@@ -28,11 +28,20 @@ public:
      * @return texture id
      */
     unsigned int get_color_texture() const;
+    /**
+     * id of the depth texture for the regular framebuffer, updated by blit()
+     * like the color texture.
+     * @return texture id
+     */
+    unsigned int get_depth_texture() const;
+    [[nodiscard]] unsigned int get_width() const;
+    [[nodiscard]] unsigned int get_height() const;
 
 private:
     unsigned int framebuffer_id_;
     unsigned int intermediate_framebuffer_id_;
     unsigned int screen_color_texture_id_;
+    unsigned int screen_depth_texture_id_;
 
     unsigned int width_, height_;
 };
@@ -0,0 +1,77 @@
+#ifndef RG_RENDERER_BUFFER_GEOMETRYARENA_HPP
+#define RG_RENDERER_BUFFER_GEOMETRYARENA_HPP
+
+#include <rg/renderer/buffer/RangeAllocator.hpp>
+#include <rg/renderer/buffer/VertexLayout.hpp>
+
+#include <cstdint>
+
+namespace rg {
+
+// Where a mesh lives inside a GeometryArena
+struct GeometryRange {
+    std::uint32_t base_vertex;
+    std::uint32_t vertex_count;
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+};
+
+// A level of detail of a mesh: a part of the indices of its range, drawn with
+// all of its vertices
+struct MeshLod {
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    // Farthest the surface may be from the full detail one, in model space
+    float error;
+};
+
+/**
+ * Large vertex and index buffers shared by every mesh of one vertex layout,
+ * with a single vertex array describing them. Meshes get ranges of the
+ * buffers and draw with a base vertex, so switching meshes needs no VAO or
+ * buffer changes. The buffers grow when they run out of space. Indices are
+ * 16-bit, so a mesh may have at most MAX_MESH_VERTICES vertices.
+ */
+class GeometryArena {
+public:
+    using Index = std::uint16_t;
+    static constexpr std::uint32_t MAX_MESH_VERTICES = 65536;
+
+    GeometryArena(VertexLayout layout, std::uint32_t vertex_capacity,
+                  std::uint32_t index_capacity);
+    GeometryArena(const GeometryArena& other) = delete;
+    GeometryArena operator=(const GeometryArena& other) = delete;
+    GeometryArena(GeometryArena&& other) noexcept;
+    GeometryArena& operator=(GeometryArena&& other) noexcept;
+    ~GeometryArena();
+
+    /**
+     * Copy the mesh into the arena. Indices are relative to the mesh's own
+     * vertices.
+     */
+    GeometryRange allocate(const void* vertices, std::uint32_t vertex_count,
+                           const Index* indices, std::uint32_t index_count);
+    void free(const GeometryRange& range);
+
+    void bind() const;
+    void unbind() const;
+    [[nodiscard]] unsigned int vertex_array_id() const;
+    [[nodiscard]] unsigned int index_buffer_id() const;
+    [[nodiscard]] const VertexLayout& layout() const;
+
+private:
+    VertexLayout layout_;
+    RangeAllocator vertices_;
+    RangeAllocator indices_;
+    unsigned int vertex_array_id_;
+    unsigned int vertex_buffer_id_;
+    unsigned int index_buffer_id_;
+
+    void release();
+    void growVertices(std::uint32_t capacity);
+    void growIndices(std::uint32_t capacity);
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_BUFFER_GEOMETRYARENA_HPP
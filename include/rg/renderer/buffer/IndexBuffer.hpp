@@ -5,6 +5,10 @@
 
 namespace rg {
 
+/**
+ * Indices which all fit in 16 bits are stored as GL_UNSIGNED_SHORT, the
+ * others as GL_UNSIGNED_INT. Draw with type().
+ */
 class IndexBuffer {
 public:
     IndexBuffer();
@@ -18,10 +22,13 @@ public:
     void bind() const;
     void unbind() const;
     [[nodiscard]] unsigned int count() const;
+    // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    [[nodiscard]] unsigned int type() const;
 
 private:
     unsigned int buffer_id_;
     unsigned int indices_;
+    unsigned int type_;
 };
 
 } // namespace rg
@@ -0,0 +1,41 @@
+#ifndef RG_RENDERER_BUFFER_RANGEALLOCATOR_HPP
+#define RG_RENDERER_BUFFER_RANGEALLOCATOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace rg {
+
+/**
+ * First-fit free-list allocator over [0, capacity) in arbitrary units. Freed
+ * ranges are merged with their free neighbours. Only does the bookkeeping;
+ * the memory itself lives elsewhere, e.g. in a GL buffer.
+ */
+class RangeAllocator {
+public:
+    struct Range {
+        std::uint32_t offset;
+        std::uint32_t size;
+    };
+
+    explicit RangeAllocator(std::uint32_t capacity);
+
+    [[nodiscard]] std::optional<Range> allocate(std::uint32_t size);
+    void free(Range range);
+    // Extend the capacity, the new space at the end becomes free
+    void grow(std::uint32_t capacity);
+
+    [[nodiscard]] std::uint32_t capacity() const;
+    [[nodiscard]] std::uint32_t used() const;
+
+private:
+    // Free ranges by offset
+    std::map<std::uint32_t, std::uint32_t> free_;
+    std::uint32_t capacity_;
+    std::uint32_t used_;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_BUFFER_RANGEALLOCATOR_HPP
@@ -0,0 +1,85 @@
+#ifndef RG_RENDERER_BUFFER_UPLOADRING_HPP
+#define RG_RENDERER_BUFFER_UPLOADRING_HPP
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace rg {
+
+/**
+ * A persistently mapped GL_PIXEL_UNPACK_BUFFER used as a ring of staging
+ * memory for texture uploads. Any thread may allocate a region and copy
+ * pixels into it, and the GL thread then uploads from the region's offset
+ * without the driver copying or waiting. A region is reused once a fence
+ * placed after the upload reading it has signalled.
+ */
+class UploadRing {
+public:
+    struct Region {
+        // Position in the ring, counted since it was created
+        std::size_t begin;
+        std::size_t size;
+        // Mapped memory to write the pixels to
+        unsigned char* data;
+    };
+
+    explicit UploadRing(std::size_t capacity);
+    UploadRing(const UploadRing& other) = delete;
+    UploadRing operator=(const UploadRing& other) = delete;
+    ~UploadRing();
+
+    /**
+     * Any thread may allocate. Never blocks.
+     * @return std::nullopt if the ring has no room right now
+     */
+    std::optional<Region> allocate(std::size_t size);
+
+    // Bind to GL_PIXEL_UNPACK_BUFFER, where the uploads read from
+    void bind() const;
+    void unbind() const;
+    // The pointer argument which makes an upload read the region
+    [[nodiscard]] const void* offset(const Region& region) const;
+
+    /**
+     * The uploads reading the region have been issued. The region is
+     * reclaimed after the next fence().
+     */
+    void retire(const Region& region);
+    // Fence the regions retired since the last call
+    void fence();
+    // Reclaim the regions whose fences signalled. Never blocks.
+    void reclaim();
+
+private:
+    struct Block {
+        std::size_t begin;
+        std::size_t end;
+        bool done;
+    };
+
+    struct Fence {
+        void* sync;
+        std::vector<std::size_t> regions;
+    };
+
+    std::size_t capacity_;
+    unsigned int buffer_id_;
+    unsigned char* data_;
+
+    std::mutex mutex_;
+    // Allocated and not yet reclaimed, by their begin
+    std::deque<Block> blocks_;
+    std::size_t head_;
+    std::size_t tail_;
+
+    // Only touched on the GL thread
+    std::vector<std::size_t> retired_;
+    std::deque<Fence> fences_;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_BUFFER_UPLOADRING_HPP
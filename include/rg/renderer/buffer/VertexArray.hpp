@@ -16,10 +16,25 @@ public:
     ~VertexArray();
     void bind() const;
     void unbind() const;
+    [[nodiscard]] unsigned int id() const;
     void recordLayout(const VertexBuffer& vb, const VertexLayout& layout) const;
+    // Without building a VertexLayout, from offsets known at compile time
+    template <class Layout>
+    void recordLayout(const VertexBuffer& vb) const {
+        bind();
+        vb.bind();
+        for (unsigned int i = 0; i < Layout::count; ++i)
+            recordAttribute(i, Layout::counts[i], Layout::types[i],
+                            Layout::normalized[i], Layout::stride,
+                            Layout::offsets[i]);
+    }
 
 private:
     unsigned int array_id_;
+
+    void recordAttribute(unsigned int index, unsigned int count,
+                         unsigned int type, bool normalized,
+                         unsigned int stride, std::size_t offset) const;
 };
 
 } // namespace rg
@@ -1,19 +1,69 @@
 #ifndef RG_RENDERER_BUFFER_VERTEXLAYOUT_HPP
 #define RG_RENDERER_BUFFER_VERTEXLAYOUT_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <vector>
 
 namespace rg {
 
-enum class ElementType { FLOAT, UNSIGNED_INT };
+// INT_2_10_10_10_REV packs a whole four component element into 32 bits
+enum class ElementType {
+    FLOAT,
+    HALF_FLOAT,
+    INT_2_10_10_10_REV,
+    SHORT,
+    BYTE,
+    UNSIGNED_INT
+};
 struct LayoutElement;
 class VertexLayout;
 
 namespace util {
 
-std::size_t size(const ElementType& type);
-unsigned int intValue(const ElementType& type);
+// Of one component, or of the whole element for the packed types
+constexpr std::size_t size(const ElementType& type) {
+    switch (type) {
+        case ElementType::FLOAT:
+            return sizeof(float);
+        case ElementType::HALF_FLOAT:
+        case ElementType::SHORT:
+            return sizeof(std::int16_t);
+        case ElementType::INT_2_10_10_10_REV:
+            return sizeof(std::uint32_t);
+        case ElementType::BYTE:
+            return sizeof(std::int8_t);
+        case ElementType::UNSIGNED_INT:
+            return sizeof(unsigned int);
+    }
+    return 0;
+}
+
+constexpr bool isPacked(const ElementType& type) {
+    return type == ElementType::INT_2_10_10_10_REV;
+}
+
+// The GL enum of the type. Spelled out so that this header does without glad,
+// VertexLayout.cpp checks them.
+constexpr unsigned int intValue(const ElementType& type) {
+    switch (type) {
+        case ElementType::FLOAT:
+            return 0x1406;
+        case ElementType::HALF_FLOAT:
+            return 0x140B;
+        case ElementType::INT_2_10_10_10_REV:
+            return 0x8D9F;
+        case ElementType::SHORT:
+            return 0x1402;
+        case ElementType::BYTE:
+            return 0x1400;
+        case ElementType::UNSIGNED_INT:
+            return 0x1405;
+    }
+    return 0;
+}
 
 } // namespace util
 
@@ -33,15 +83,63 @@ public:
     VertexLayout(std::initializer_list<LayoutElement> elements);
 
     void push(LayoutElement element);
-    [[nodiscard]] std::vector<unsigned int> offsets() const;
+    [[nodiscard]] const std::vector<unsigned int>& offsets() const;
     [[nodiscard]] unsigned int stride() const;
     [[nodiscard]] const std::vector<LayoutElement>& get_elements() const;
 
 private:
     std::vector<LayoutElement> elements_;
+    std::vector<unsigned int> offsets_;
     unsigned int stride_;
 };
 
+// An element of a StaticVertexLayout
+template <ElementType Type, unsigned int Count, bool Normalized = false>
+struct Attribute {
+    static constexpr ElementType type = Type;
+    static constexpr unsigned int count = Count;
+    static constexpr bool normalized = Normalized;
+    static constexpr unsigned int size = static_cast<unsigned int>(
+            util::isPacked(Type) ? util::size(Type) : Count * util::size(Type));
+
+    static_assert(!util::isPacked(Type) || Count == 4,
+                  "packed attributes have four components");
+};
+
+/**
+ * A vertex layout which is known at compile time: the attributes, in order
+ * and without gaps between them. Vertex structs name theirs as Layout and
+ * check it against their members with static_assert.
+ */
+template <class... Attributes>
+struct StaticVertexLayout {
+    static constexpr std::size_t count = sizeof...(Attributes);
+    static constexpr std::array<unsigned int, count> sizes{Attributes::size...};
+    static constexpr std::array<unsigned int, count> counts{
+            Attributes::count...};
+    static constexpr std::array<unsigned int, count> types{
+            util::intValue(Attributes::type)...};
+    static constexpr std::array<bool, count> normalized{
+            Attributes::normalized...};
+    static constexpr unsigned int stride = (0U + ... + Attributes::size);
+
+    static constexpr std::array<unsigned int, count> offsets = [] {
+        std::array<unsigned int, count> result{};
+        unsigned int offset = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            result[i] = offset;
+            offset += sizes[i];
+        }
+        return result;
+    }();
+
+    // For what takes a VertexLayout, e.g. a GeometryArena
+    static VertexLayout layout() {
+        return {LayoutElement{Attributes::type, Attributes::count,
+                              Attributes::normalized}...};
+    }
+};
+
 } // namespace rg
 
 #endif // RG_RENDERER_BUFFER_VERTEXLAYOUT_HPP
@@ -0,0 +1,47 @@
+#ifndef RG_RENDERER_CAMERA_DEPTHPYRAMID_HPP
+#define RG_RENDERER_CAMERA_DEPTHPYRAMID_HPP
+
+#include <rg/renderer/shader/Shader.hpp>
+
+namespace rg {
+
+/**
+ * A mipmapped R32F copy of a depth buffer in which every texel holds the
+ * farthest depth of the texels it covers one level down. Anything nearer
+ * than the farthest depth of its screen rectangle may be visible, anything
+ * farther is hidden.
+ */
+class DepthPyramid {
+public:
+    DepthPyramid(unsigned int width, unsigned int height);
+    DepthPyramid(const DepthPyramid& other) = delete;
+    DepthPyramid operator=(const DepthPyramid& other) = delete;
+    DepthPyramid(DepthPyramid&& other) noexcept;
+    DepthPyramid& operator=(DepthPyramid&& other) noexcept;
+    ~DepthPyramid();
+
+    /**
+     * Rebuild every level from a depth texture of the same size, using the
+     * reduction compute program.
+     */
+    void build(const Shader& reduce, unsigned int depth_texture);
+    // The pyramid no longer matches the previous frame
+    void invalidate();
+
+    [[nodiscard]] bool is_valid() const;
+    [[nodiscard]] unsigned int get_texture() const;
+    [[nodiscard]] unsigned int get_width() const;
+    [[nodiscard]] unsigned int get_height() const;
+    [[nodiscard]] unsigned int get_levels() const;
+
+private:
+    unsigned int texture_id_;
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int levels_;
+    bool valid_;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_CAMERA_DEPTHPYRAMID_HPP
@@ -0,0 +1,28 @@
+#ifndef RG_RENDERER_CAMERA_FRUSTUM_HPP
+#define RG_RENDERER_CAMERA_FRUSTUM_HPP
+
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/model/BoundingSphere.hpp>
+
+#include <glm/vec4.hpp>
+
+#include <array>
+
+namespace rg {
+
+class Frustum {
+public:
+    explicit Frustum(const View& view);
+
+    [[nodiscard]] bool intersects(const BoundingSphere& sphere) const;
+    // Normalized, in the order left, right, bottom, top, near, far
+    [[nodiscard]] const std::array<glm::vec4, 6>& get_planes() const;
+
+private:
+    // left, right, bottom, top, near, far; normals point inside
+    std::array<glm::vec4, 6> planes_;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_CAMERA_FRUSTUM_HPP
@@ -0,0 +1,71 @@
+#ifndef RG_RENDERER_CAMERA_POSTCHAIN_HPP
+#define RG_RENDERER_CAMERA_POSTCHAIN_HPP
+
+#include <rg/renderer/shader/Shader.hpp>
+
+#include <array>
+
+namespace rg {
+
+// GPU time of each pass of a PostChain, in milliseconds
+struct PostTimings {
+    double bloom_down = 0.0;
+    double bloom_up = 0.0;
+    double composite = 0.0;
+};
+
+/**
+ * Turns the HDR color of a surface into the image shown on the screen, with
+ * compute programs. Bloom is built in a pyramid of ever smaller levels: the
+ * bright texels are filtered down level by level, then each level adds the
+ * one below it on the way back up. The last upsample is fused with the
+ * exposure, tonemapping and gamma into a single pass which writes an RGBA8
+ * texture.
+ */
+class PostChain {
+public:
+    PostChain(unsigned int width, unsigned int height);
+    PostChain(const PostChain& other) = delete;
+    PostChain operator=(const PostChain& other) = delete;
+    PostChain(PostChain&& other) noexcept;
+    PostChain& operator=(PostChain&& other) noexcept;
+    ~PostChain();
+
+    /**
+     * Run every pass on a color texture of the same size. Each pass is timed
+     * with timestamp queries, which are read back a few frames later so that
+     * the CPU never waits on them.
+     */
+    void apply(const Shader& bloom, const Shader& composite,
+               unsigned int color_texture);
+
+    // Of the latest frame whose queries came back
+    [[nodiscard]] const PostTimings& get_timings() const;
+    [[nodiscard]] unsigned int get_output_texture() const;
+    [[nodiscard]] unsigned int get_width() const;
+    [[nodiscard]] unsigned int get_height() const;
+
+private:
+    // Frames whose queries may still be in flight
+    static constexpr unsigned int QUERY_FRAMES = 3;
+    // Before, between and after the passes
+    static constexpr unsigned int TIMESTAMPS = 4;
+
+    unsigned int bloom_texture_;
+    unsigned int output_texture_;
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int levels_;
+    std::array<unsigned int, QUERY_FRAMES * TIMESTAMPS> queries_;
+    unsigned int frame_;
+    PostTimings timings_;
+
+    void dispatch(unsigned int width, unsigned int height) const;
+    // Read the queries of the frame about to be reused, if they came back
+    void collect();
+    void release();
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_CAMERA_POSTCHAIN_HPP
@@ -2,6 +2,7 @@
 #define RG_RENDERER_CAMERA_SURFACE_HPP
 
 #include <rg/renderer/buffer/FrameBuffer.hpp>
+#include <rg/renderer/camera/PostChain.hpp>
 #include <rg/renderer/model/Mesh.hpp>
 
 #include <glm/mat4x4.hpp>
@@ -20,10 +21,20 @@ public:
     Surface(unsigned int width, unsigned int height);
     Surface(unsigned int width, unsigned int height,
             std::shared_ptr<MeshVertexData> quad);
+    // Draws the output of the post chain, as of the last resolve
     void draw(const Shader& shader) const;
     void draw(const Shader& shader, const DrawDirectives& directives) const;
     void bind() const;
     void unbind() const;
+    /**
+     * Resolve the multisampled colors and depth, then run the post chain on
+     * the colors. Unbinds all framebuffers.
+     */
+    void resolve(const Shader& bloom, const Shader& composite);
+    [[nodiscard]] unsigned int get_depth_texture() const;
+    [[nodiscard]] const PostChain& get_post_chain() const;
+    [[nodiscard]] unsigned int get_width() const;
+    [[nodiscard]] unsigned int get_height() const;
 
     struct ScreenDirectives {
         glm::vec2 origin;
@@ -54,7 +65,10 @@ public:
 
 private:
     FrameBuffer fb_;
-    Mesh quad_;
+    PostChain post_;
+    std::shared_ptr<MeshVertexData> quad_;
+
+    void drawQuad(const Shader& shader) const;
 };
 
 } // namespace rg
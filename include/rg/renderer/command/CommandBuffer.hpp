@@ -0,0 +1,214 @@
+#ifndef RG_RENDERER_COMMAND_COMMANDBUFFER_HPP
+#define RG_RENDERER_COMMAND_COMMANDBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace rg {
+
+enum class CommandType : std::uint8_t {
+    BIND_PROGRAM,
+    BIND_UNIFORM_RANGE,
+    BIND_STORAGE_RANGE,
+    BIND_VERTEX_ARRAY,
+    BIND_TEXTURE,
+    DRAW_ELEMENTS,
+    DRAW_ELEMENTS_INSTANCED,
+    MULTI_DRAW_ELEMENTS_INDIRECT,
+    MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+    DISPATCH_COMPUTE,
+    MEMORY_BARRIER,
+};
+
+// Commands
+// --------
+// Objects are referred to by their raw ids, so recording needs neither the
+// GL context nor the wrapper objects.
+
+struct BindProgram {
+    std::uint32_t program;
+};
+
+// Ranges of the command buffer's own data
+struct BindUniformRange {
+    std::uint32_t binding;
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct BindStorageRange {
+    std::uint32_t binding;
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct BindVertexArray {
+    std::uint32_t vertex_array;
+};
+
+struct BindTexture {
+    std::uint32_t unit;
+    std::uint32_t texture;
+    std::uint32_t target; // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, ...
+};
+
+struct DrawElements {
+    std::uint32_t count;
+    std::uint32_t first; // in indices
+    std::int32_t base_vertex;
+};
+
+struct DrawElementsInstanced {
+    std::uint32_t count;
+    std::uint32_t first;
+    std::int32_t base_vertex;
+    std::uint32_t instances;
+    std::uint32_t base_instance;
+};
+
+// Layout defined by GL for glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    std::uint32_t count;
+    std::uint32_t instance_count;
+    std::uint32_t first_index;
+    std::int32_t base_vertex;
+    std::uint32_t base_instance;
+};
+
+// An array of DrawElementsIndirectCommand in the command buffer's data
+struct MultiDrawElementsIndirect {
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+// Like MultiDrawElementsIndirect, with the number of draws read by the GPU
+// from the data at count_offset
+struct MultiDrawElementsIndirectCount {
+    std::uint32_t offset;
+    std::uint32_t count_offset;
+    std::uint32_t max_count;
+};
+
+struct DispatchCompute {
+    std::uint32_t groups_x;
+    std::uint32_t groups_y;
+    std::uint32_t groups_z;
+};
+
+struct Barrier {
+    std::uint32_t barriers; // GL_*_BARRIER_BIT
+};
+
+struct Command {
+    CommandType type;
+    union {
+        BindProgram bind_program;
+        BindUniformRange bind_uniform_range;
+        BindStorageRange bind_storage_range;
+        BindVertexArray bind_vertex_array;
+        BindTexture bind_texture;
+        DrawElements draw_elements;
+        DrawElementsInstanced draw_elements_instanced;
+        MultiDrawElementsIndirect multi_draw_elements_indirect;
+        MultiDrawElementsIndirectCount multi_draw_elements_indirect_count;
+        DispatchCompute dispatch_compute;
+        Barrier memory_barrier;
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<Command>);
+
+/**
+ * A recorded stream of draw commands along with the data they refer to:
+ * uniform blocks, shader storage arrays and indirect draws. Recording is
+ * plain memory writes, so any thread may record a buffer; the buffer is then
+ * executed on the thread which owns the GL context.
+ */
+class CommandBuffer {
+public:
+    // Data ranges are aligned for the strictest
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT and
+    // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT found in practice
+    static constexpr std::size_t DATA_ALIGNMENT = 256;
+
+    // Keeps the allocations for the next recording
+    void clear();
+
+    void bind_program(std::uint32_t program);
+    /**
+     * Copy the block into the uniform data and bind it to the binding point
+     * for the commands that follow.
+     */
+    template <class T>
+    void bind_uniforms(std::uint32_t binding, const T& block) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::size_t offset = allocateData(sizeof(T));
+        std::memcpy(data_.data() + offset, &block, sizeof(T));
+
+        Command command{CommandType::BIND_UNIFORM_RANGE, {}};
+        command.bind_uniform_range = {binding,
+                                      static_cast<std::uint32_t>(offset),
+                                      static_cast<std::uint32_t>(sizeof(T))};
+        commands_.push_back(command);
+    }
+    /**
+     * Copy the array into the data and bind it to the shader storage binding
+     * point for the commands that follow.
+     */
+    template <class T>
+    void bind_storage(std::uint32_t binding, const T* items,
+                      std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::size_t size = count * sizeof(T);
+        std::size_t offset = allocateData(size);
+        if (size > 0)
+            std::memcpy(data_.data() + offset, items, size);
+
+        Command command{CommandType::BIND_STORAGE_RANGE, {}};
+        command.bind_storage_range = {binding,
+                                      static_cast<std::uint32_t>(offset),
+                                      static_cast<std::uint32_t>(size)};
+        commands_.push_back(command);
+    }
+    /**
+     * Allocate zeroed data for the GPU to write, and bind it to the shader
+     * storage binding point.
+     * @return the offset of the data
+     */
+    std::uint32_t bind_storage(std::uint32_t binding, std::size_t size);
+    void bind_vertex_array(std::uint32_t vertex_array);
+    void bind_texture(std::uint32_t unit, std::uint32_t texture,
+                      std::uint32_t target);
+    void draw_elements(std::uint32_t count, std::uint32_t first = 0,
+                       std::int32_t base_vertex = 0);
+    void draw_elements_instanced(std::uint32_t count, std::uint32_t instances,
+                                 std::uint32_t first = 0,
+                                 std::int32_t base_vertex = 0,
+                                 std::uint32_t base_instance = 0);
+    // Copies the draws into the data
+    void multi_draw_elements_indirect(
+            const DrawElementsIndirectCommand* draws, std::size_t count);
+    // The draws and their count are in the data, written by the GPU
+    void multi_draw_elements_indirect_count(std::uint32_t offset,
+                                            std::uint32_t count_offset,
+                                            std::uint32_t max_count);
+    void dispatch_compute(std::uint32_t groups_x, std::uint32_t groups_y = 1,
+                          std::uint32_t groups_z = 1);
+    void memory_barrier(std::uint32_t barriers);
+
+    [[nodiscard]] const std::vector<Command>& commands() const;
+    [[nodiscard]] const std::vector<std::byte>& data() const;
+
+private:
+    std::vector<Command> commands_;
+    std::vector<std::byte> data_;
+
+    std::size_t allocateData(std::size_t size);
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_COMMAND_COMMANDBUFFER_HPP
@@ -0,0 +1,34 @@
+#ifndef RG_RENDERER_COMMAND_COMMANDSUBMITTER_HPP
+#define RG_RENDERER_COMMAND_COMMANDSUBMITTER_HPP
+
+#include <rg/renderer/command/CommandBuffer.hpp>
+
+#include <cstddef>
+
+namespace rg {
+
+/**
+ * Executes command buffers on the GL thread. The data of each buffer is
+ * uploaded into a single GL buffer, which serves as the uniform, shader
+ * storage and indirect draw buffer. State which is already bound is not bound
+ * again.
+ */
+class CommandSubmitter {
+public:
+    CommandSubmitter();
+    CommandSubmitter(const CommandSubmitter& other) = delete;
+    CommandSubmitter operator=(const CommandSubmitter& other) = delete;
+    CommandSubmitter(CommandSubmitter&& other) noexcept;
+    CommandSubmitter& operator=(CommandSubmitter&& other) noexcept;
+    ~CommandSubmitter();
+
+    void submit(const CommandBuffer& commands);
+
+private:
+    unsigned int buffer_id_;
+    std::size_t capacity_;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_COMMAND_COMMANDSUBMITTER_HPP
@@ -0,0 +1,83 @@
+#ifndef RG_RENDERER_MODEL_ASSETRELOADER_HPP
+#define RG_RENDERER_MODEL_ASSETRELOADER_HPP
+
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/renderer/buffer/GeometryArena.hpp>
+#include <rg/renderer/model/MaterialLibrary.hpp>
+#include <rg/renderer/model/Model.hpp>
+#include <rg/util/FileWatcher.hpp>
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+/**
+ * Reloads the watched models and the textures of the material library when
+ * their files in a directory change. Only the changed assets are imported or
+ * decoded again and the results are uploaded between frames. Models are
+ * imported on threads of their own. The changed textures are read in one
+ * batch and decoded by jobs as their reads complete. Models and materials
+ * keep their addresses and indices, so nothing which refers to them has to
+ * know.
+ */
+class AssetReloader {
+public:
+    /**
+     * Without a job system the textures are read and decoded on the calling
+     * thread. The job system has to be destroyed before the reloader, since
+     * running decodes write into it.
+     */
+    AssetReloader(std::string directory, GeometryArena& arena,
+                  MaterialLibrary& library, JobSystem* jobs = nullptr);
+    AssetReloader(const AssetReloader& other) = delete;
+    AssetReloader operator=(const AssetReloader& other) = delete;
+    // Waits for the imports still running
+    ~AssetReloader() = default;
+
+    // The model is reloaded when its file or a .mtl next to it changes
+    void watch(Model& model);
+
+    /**
+     * Upload the assets which finished loading, and start loading the ones
+     * whose files changed. Call on the thread with the GL context, before
+     * recording and before MaterialLibrary::update().
+     */
+    void update();
+
+private:
+    struct Import {
+        Model* model;
+        std::future<ModelData> data;
+    };
+
+    // Textures which changed together. The images may only be read once
+    // the counter is done.
+    struct Decodes {
+        JobCounter counter;
+        std::vector<std::string> paths;
+        std::vector<std::optional<MaterialLibrary::Image>> images;
+    };
+
+    std::string directory_;
+    util::FileWatcher watcher_;
+    GeometryArena& arena_;
+    MaterialLibrary& library_;
+    JobSystem* jobs_;
+    std::vector<Model*> models_;
+
+    std::vector<Import> imports_;
+    std::vector<std::unique_ptr<Decodes>> decodes_;
+
+    void commit();
+    void start(const std::vector<std::string>& changed);
+    // Read the textures in one batch and decode each once it is read
+    void decodeTextures(std::unique_ptr<Decodes> decodes);
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_ASSETRELOADER_HPP
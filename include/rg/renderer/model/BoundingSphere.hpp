@@ -0,0 +1,21 @@
+#ifndef RG_RENDERER_MODEL_BOUNDINGSPHERE_HPP
+#define RG_RENDERER_MODEL_BOUNDINGSPHERE_HPP
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace rg {
+
+struct BoundingSphere {
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+
+    /**
+     * The sphere enclosing this one after the model matrix is applied.
+     */
+    [[nodiscard]] BoundingSphere transformed(const glm::mat4& model) const;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_BOUNDINGSPHERE_HPP
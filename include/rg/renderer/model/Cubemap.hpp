@@ -1,6 +1,8 @@
 #ifndef RG_RENDERER_MODEL_CUBEMAP_HPP
 #define RG_RENDERER_MODEL_CUBEMAP_HPP
 
+#include <rg/jobs/JobSystem.hpp>
+
 #include <string>
 #include <vector>
 
@@ -9,7 +11,10 @@ namespace rg {
 class Cubemap {
 public:
     Cubemap();
-    Cubemap(const std::string& path, const std::vector<std::string>& faces);
+    // The faces are read in one batch and decoded by jobs as their reads
+    // complete, or one after the other without them
+    Cubemap(const std::string& path, const std::vector<std::string>& faces,
+            JobSystem* jobs = nullptr);
     ~Cubemap();
 
     Cubemap(const Cubemap& other) = delete;
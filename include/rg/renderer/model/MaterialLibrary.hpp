@@ -0,0 +1,273 @@
+#ifndef RG_RENDERER_MODEL_MATERIALLIBRARY_HPP
+#define RG_RENDERER_MODEL_MATERIALLIBRARY_HPP
+
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/renderer/buffer/UploadRing.hpp>
+#include <rg/util/FileLoader.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace rg {
+
+// A layer of one of the library's texture arrays
+struct TextureSlot {
+    std::uint32_t array;
+    std::uint32_t layer;
+};
+
+struct Material {
+    TextureSlot diffuse;
+    TextureSlot specular;
+    // The ShaderFeatures the material needs, out of MATERIAL_FEATURES
+    std::uint32_t features;
+};
+
+// Bytes of texture memory taken by the arrays
+struct TextureResidency {
+    std::size_t resident;
+    // What would be resident if every request was met
+    std::size_t requested;
+    std::size_t budget;
+};
+
+/**
+ * Owns every model texture, packed into GL_TEXTURE_2D_ARRAYs with one array
+ * per size and format, and the materials which refer to them. The layers of
+ * the materials are mirrored in a shader storage buffer, so a draw only
+ * carries a material index. Only the arrays have to be bound, and meshes
+ * whose textures share arrays can be drawn together.
+ *
+ * The top mip levels of an array are only resident while its textures appear
+ * large enough on screen to need them. Arrays start with the levels up to
+ * STREAM_START_SIZE, the size at which their textures are seen is requested
+ * while recording, and update() streams in the higher levels on workers.
+ * Over the budget, the top levels of the arrays requested least recently
+ * are dropped.
+ */
+class MaterialLibrary {
+public:
+    // Texels along the larger side of the top level arrays start with
+    static constexpr unsigned int STREAM_START_SIZE = 64;
+
+    // Decoded RGBA pixels
+    struct Image {
+        unsigned int width;
+        unsigned int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    /**
+     * Decode the image without touching GL, so it may run on any thread.
+     * @return std::nullopt if the image could not be loaded
+     */
+    static std::optional<Image> decode(const std::string& path);
+    // Decode the contents of the image file at the path, if it was read
+    static std::optional<Image>
+    decode(const std::string& path, std::optional<std::string_view> contents);
+
+    /**
+     * Creates the default textures: white for diffuse, black for specular.
+     * Streamed images are read in one batch per update() and staged in the
+     * ring, or in client memory without one. They are decoded by jobs as
+     * their reads complete, or on the calling thread without a job system.
+     * The ring has to outlive the library. The job system has to be
+     * destroyed before it, since running decodes write into the library.
+     */
+    explicit MaterialLibrary(UploadRing* ring = nullptr,
+                             JobSystem* jobs = nullptr);
+    MaterialLibrary(const MaterialLibrary& other) = delete;
+    MaterialLibrary operator=(const MaterialLibrary& other) = delete;
+    MaterialLibrary(MaterialLibrary&& other) noexcept;
+    MaterialLibrary& operator=(MaterialLibrary&& other) noexcept;
+    ~MaterialLibrary();
+
+    /**
+     * Load the image into the array of its size, once per path.
+     * @return std::nullopt if the image could not be loaded
+     */
+    std::optional<TextureSlot> load(const std::string& path);
+    /**
+     * Like load(), but only the size of the image is read now. The layer is
+     * mid grey until a worker has decoded the image into the upload ring,
+     * and update() uploads it.
+     */
+    std::optional<TextureSlot> stream(const std::string& path);
+    /**
+     * The textures of the material are seen size pixels across this frame.
+     * Any thread may call it while recording, update() takes the requests.
+     */
+    void request(std::uint32_t material, unsigned int size);
+    void set_budget(std::size_t bytes);
+    // Whether the image at the path was loaded
+    [[nodiscard]] bool contains(const std::string& path) const;
+    /**
+     * Replace the loaded image at the path. An image of the same size is
+     * written over its layer, otherwise it gets a layer of the array of its
+     * size and the materials using the old one are pointed at it, keeping
+     * their indices. The old layer stays allocated until the library is
+     * destroyed. Call update() afterwards.
+     */
+    void reload(const std::string& path, const Image& image);
+    /**
+     * @return the index of the material, which is added if it is new
+     */
+    std::uint32_t add(const Material& material);
+
+    /**
+     * Upload the streamed images and mip levels which were decoded, start
+     * streaming the levels requested since the last call within the budget,
+     * generate the mipmaps of the arrays which got new layers, and upload
+     * the materials if they changed. Call every frame, before recording.
+     */
+    void update();
+    // Bind the materials to MATERIAL_STORAGE_BINDING
+    void bind() const;
+
+    [[nodiscard]] const Material& get(std::uint32_t material) const;
+    // The distinct features of the materials
+    [[nodiscard]] std::vector<std::uint32_t> get_feature_sets() const;
+    [[nodiscard]] unsigned int get_array_texture(std::uint32_t array) const;
+    [[nodiscard]] TextureSlot white() const;
+    [[nodiscard]] TextureSlot black() const;
+    // As of the last update()
+    [[nodiscard]] const TextureResidency& get_residency() const;
+
+private:
+    struct TextureArray {
+        unsigned int texture_id;
+        unsigned int width;
+        unsigned int height;
+        unsigned int format;
+        // Of the full chain, from width and height
+        unsigned int levels;
+        // Top levels which are not resident
+        unsigned int dropped;
+        std::uint32_t layers;
+        std::uint32_t capacity;
+        bool dirty;
+        bool promoting;
+        // Changes whenever the layers or the storage change, so that
+        // promotions started before know that they are out of date
+        std::uint32_t generation;
+        // The update() during which the array was last requested
+        std::uint64_t last_used;
+        // The image path of each layer, empty for the default textures
+        std::vector<std::string> sources;
+
+        // Of the top resident level
+        [[nodiscard]] unsigned int resident_width() const;
+        [[nodiscard]] unsigned int resident_height() const;
+        // Of the levels below the dropped ones, for the whole capacity
+        [[nodiscard]] std::size_t bytes(unsigned int dropped_levels) const;
+    };
+
+    using ArrayKey = std::tuple<unsigned int, unsigned int, unsigned int>;
+
+    // The pixels of a streamed image, in the ring if it had room
+    struct Pixels {
+        unsigned int width;
+        unsigned int height;
+        std::optional<UploadRing::Region> region;
+        std::vector<unsigned char> fallback;
+    };
+
+    // Images decoded by jobs, by layer. The pixels may only be read once
+    // the decodes are done.
+    struct Decodes {
+        JobCounter counter;
+        std::vector<std::optional<Pixels>> layers;
+        // Set while files wait for the next batch of reads
+        bool queued = false;
+        // Counts the job which reads the batch and starts the decodes
+        std::shared_ptr<JobCounter> reads;
+
+        [[nodiscard]] bool done() const;
+    };
+
+    struct Stream {
+        TextureSlot slot;
+        std::unique_ptr<Decodes> decodes;
+    };
+
+    // New storage for an array with fewer dropped levels, filled by workers
+    struct Promotion {
+        std::uint32_t array;
+        std::uint32_t generation;
+        unsigned int dropped;
+        unsigned int texture_id;
+        // Empty for the layers without a source
+        std::unique_ptr<Decodes> decodes;
+    };
+
+    std::vector<TextureArray> arrays_;
+    std::map<ArrayKey, std::uint32_t> array_indices_;
+    std::unordered_map<std::string, TextureSlot> loaded_;
+    std::vector<Material> materials_;
+    // Materials by their slots, each packed as array << 32 | layer, and
+    // their features
+    using MaterialKey = std::tuple<std::uint64_t, std::uint64_t, std::uint32_t>;
+    std::map<MaterialKey, std::uint32_t> material_indices_;
+    bool materials_changed_;
+    unsigned int buffer_id_;
+    TextureSlot white_;
+    TextureSlot black_;
+    UploadRing* ring_;
+    JobSystem* jobs_;
+    std::vector<Stream> streams_;
+
+    // The largest size requested for each array since the last update()
+    std::deque<std::atomic<std::uint32_t>> wanted_;
+    std::vector<Promotion> promotions_;
+    // The files of the decodes started since the last update(), read in one
+    // batch by it
+    std::vector<util::FileJob> reads_;
+    std::vector<Decodes*> queued_;
+    TextureResidency residency_;
+    std::uint64_t frame_;
+
+    Stream startStream(TextureSlot slot, const std::string& path,
+                       const TextureArray& array);
+    // Decode the image into the layer of the decodes with a job once its
+    // file is read, scaled down to the top resident level of the array
+    void startDecode(Decodes& decodes, std::size_t layer, std::string path,
+                     const TextureArray& array);
+    // Read the files of the started decodes in one batch, on a job
+    void submitReads();
+
+    TextureSlot reserveLayer(unsigned int width, unsigned int height,
+                             std::string source);
+    TextureSlot addLayer(const Image& image, std::string source);
+    // Write the top level of the layer in the texture of the array
+    void upload(unsigned int texture_id, std::uint32_t layer,
+                const Pixels& pixels);
+    void finishStreams();
+    void finishPromotions();
+    // Start the promotions the requests call for, evicting to stay within
+    // the budget
+    void balance();
+    void promote(std::uint32_t index, unsigned int dropped);
+    // Drop the top level of the array requested least recently, other than
+    // the one given. Adjusts resident, and returns false if none can drop.
+    bool evictLeastRecent(std::uint32_t keep, std::size_t& resident);
+    void evict(TextureArray& array);
+    std::uint32_t arrayFor(unsigned int width, unsigned int height);
+    unsigned int allocate(const TextureArray& array, unsigned int dropped,
+                          std::uint32_t capacity) const;
+    void grow(TextureArray& array);
+    void release();
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_MATERIALLIBRARY_HPP
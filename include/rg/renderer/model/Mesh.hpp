@@ -1,13 +1,19 @@
 #ifndef RG_RENDERER_MODEL_MESH_HPP
 #define RG_RENDERER_MODEL_MESH_HPP
 
+#include <rg/renderer/buffer/GeometryArena.hpp>
 #include <rg/renderer/buffer/IndexBuffer.hpp>
 #include <rg/renderer/buffer/VertexArray.hpp>
 #include <rg/renderer/buffer/VertexBuffer.hpp>
-#include <rg/renderer/model/Texture.hpp>
+#include <rg/renderer/command/CommandBuffer.hpp>
+#include <rg/renderer/model/MaterialLibrary.hpp>
+#include <rg/renderer/model/Meshlet.hpp>
+#include <rg/renderer/model/Vertex.hpp>
 #include <rg/renderer/shader/Shader.hpp>
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace rg {
 
@@ -17,15 +23,59 @@ struct MeshVertexData {
     IndexBuffer index_buffer;
 };
 
+// A range of a GeometryArena along with the material it is drawn with. The
+// arena and the material library have to outlive the mesh. Its vertices are
+// PackedVertex, positioned by the quantization. The levels of detail are
+// parts of the range's indices, the first one being the full mesh, which is
+// also split into meshlets for culling.
 class Mesh {
 public:
-    Mesh(std::shared_ptr<MeshVertexData> vertices,
-         std::vector<std::shared_ptr<Texture>> textures);
+    Mesh(const GeometryArena& arena, GeometryRange range,
+         VertexQuantization quantization, std::vector<MeshLod> lods,
+         std::vector<Meshlet> meshlets, const MaterialLibrary& library,
+         std::uint32_t material);
+    // At full detail
     void draw(const Shader& shader) const;
+    /**
+     * Record the draw of the level of detail, with the texture arrays of the
+     * material bound to their fixed texture units. The base instance selects
+     * the per draw data.
+     */
+    void record(CommandBuffer& commands, std::uint32_t base_instance,
+                std::uint32_t lod = 0) const;
+    // Only the texture binds of record()
+    void record_textures(CommandBuffer& commands) const;
+    // The draw as an element of a multi draw
+    [[nodiscard]] DrawElementsIndirectCommand
+    indirect(std::uint32_t base_instance, std::uint32_t lod = 0) const;
+    // The draw of one of the meshlets as an element of a multi draw
+    [[nodiscard]] DrawElementsIndirectCommand
+    indirect(std::uint32_t base_instance, const Meshlet& meshlet) const;
+    // The coarsest level of detail whose error is at most max_error
+    [[nodiscard]] std::uint32_t select_lod(float max_error) const;
+
+    [[nodiscard]] std::uint32_t vertex_array_id() const;
+    // Where the vertices and indices are in the arena
+    [[nodiscard]] const GeometryRange& range() const;
+    [[nodiscard]] const VertexQuantization& quantization() const;
+    [[nodiscard]] const std::vector<MeshLod>& lods() const;
+    // Empty for meshes made without them
+    [[nodiscard]] const std::vector<Meshlet>& meshlets() const;
+    // Index into the material library
+    [[nodiscard]] std::uint32_t material() const;
+    // Equal for meshes whose textures are in the same arrays
+    [[nodiscard]] std::uint64_t texture_key() const;
+    // The ShaderFeatures of the material
+    [[nodiscard]] std::uint32_t features() const;
 
 private:
-    std::shared_ptr<MeshVertexData> vertices_;
-    std::vector<std::shared_ptr<Texture>> textures_;
+    const GeometryArena* arena_;
+    GeometryRange range_;
+    VertexQuantization quantization_;
+    std::vector<MeshLod> lods_;
+    std::vector<Meshlet> meshlets_;
+    const MaterialLibrary* library_;
+    std::uint32_t material_;
 };
 
 } // namespace rg
@@ -0,0 +1,110 @@
+#ifndef RG_RENDERER_MODEL_MESHOPTIMIZER_HPP
+#define RG_RENDERER_MODEL_MESHOPTIMIZER_HPP
+
+#include <rg/renderer/buffer/GeometryArena.hpp>
+#include <rg/renderer/model/Meshlet.hpp>
+#include <rg/renderer/model/Vertex.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rg {
+
+// The entries of the post-transform vertex cache simulated for the stats
+constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+// How often a FIFO post-transform vertex cache misses on an index order
+struct VertexCacheStats {
+    std::uint64_t transforms = 0;
+    std::uint64_t triangles = 0;
+    std::uint64_t vertices = 0;
+
+    // Transformed vertices per triangle, 0.5 at best and 3 at worst
+    [[nodiscard]] float acmr() const;
+    // Transformed vertices per vertex, 1 at best
+    [[nodiscard]] float atvr() const;
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other);
+};
+
+VertexCacheStats
+analyzeVertexCache(const std::vector<unsigned int>& indices,
+                   std::size_t vertex_count,
+                   unsigned int cache_size = VERTEX_CACHE_SIZE);
+
+/**
+ * Reorder the triangles so that consecutive ones share vertices, for the
+ * post-transform cache. Greedy, after Tom Forsyth's linear-speed vertex cache
+ * optimisation: vertices are scored by their position in a simulated LRU
+ * cache and by how many triangles still use them.
+ */
+void optimizeVertexCache(std::vector<unsigned int>& indices,
+                         std::size_t vertex_count);
+
+/**
+ * Reorder runs of the triangles so that the ones facing away from the center
+ * of the mesh are drawn first, and hide fewer fragments behind them. A run
+ * ends where the cache order starts afresh, so the cache stays as efficient.
+ * Call after optimizeVertexCache().
+ */
+void optimizeOverdraw(std::vector<unsigned int>& indices,
+                      const std::vector<Vertex>& vertices);
+
+/**
+ * Reorder the vertices by their first use in the indices, so that fetching
+ * them walks memory forwards. Vertices no triangle uses are dropped.
+ */
+void optimizeVertexFetch(std::vector<Vertex>& vertices,
+                         std::vector<unsigned int>& indices);
+
+/**
+ * Collapse edges until at most target_index_count indices are left, or every
+ * collapse would move the surface by more than max_error. Only the indices
+ * change: each collapse moves a vertex onto a neighbour, picked by the error
+ * quadrics of Garland and Heckbert. Vertices on borders and on seams of the
+ * normals or texture coordinates stay where they are.
+ * @return the farthest the surface may have moved
+ */
+float simplify(std::vector<unsigned int>& indices,
+               const std::vector<Vertex>& vertices,
+               std::size_t target_index_count, float max_error);
+
+/**
+ * Append up to max_lods - 1 simplified copies of the triangles to the
+ * indices, each with about half the triangles of the one before and
+ * optimized for the vertex cache. Stops early once a level would move the
+ * surface by more than max_error or barely simplifies.
+ * @return the levels, starting with the given triangles
+ */
+std::vector<MeshLod> buildLods(std::vector<unsigned int>& indices,
+                               const std::vector<Vertex>& vertices,
+                               std::size_t max_lods, float max_error);
+
+/**
+ * Split the triangles, in order, into meshlets of at most
+ * MAX_MESHLET_VERTICES vertices and MAX_MESHLET_TRIANGLES triangles. After
+ * optimizeVertexCache() consecutive triangles are neighbours, so the runs
+ * are compact and their normals close.
+ */
+std::vector<Meshlet> buildMeshlets(const std::vector<unsigned int>& indices,
+                                   const std::vector<Vertex>& vertices);
+
+// Triangles of a mesh with vertices of their own
+struct MeshPart {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+/**
+ * Split the triangles, in order, into parts which use at most max_vertices
+ * vertices each. The vertices of a part are in order of first use. A mesh
+ * which is small enough is returned whole.
+ */
+std::vector<MeshPart> splitMesh(std::vector<Vertex> vertices,
+                                std::vector<unsigned int> indices,
+                                std::size_t max_vertices);
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_MESHOPTIMIZER_HPP
@@ -0,0 +1,31 @@
+#ifndef RG_RENDERER_MODEL_MESHLET_HPP
+#define RG_RENDERER_MODEL_MESHLET_HPP
+
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+
+namespace rg {
+
+constexpr std::uint32_t MAX_MESHLET_VERTICES = 64;
+constexpr std::uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+/**
+ * A cluster of neighbouring triangles of a mesh, culled on its own: a run of
+ * the full detail indices, with bounds for the frustum and backface tests.
+ */
+struct Meshlet {
+    // Relative to the mesh's range
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    // Model space bounding sphere: center and radius
+    glm::vec4 sphere;
+    // The average normal, and the sine of the angle the normals spread around
+    // it. A sine of 1 means they spread too far for the cluster to ever face
+    // away as a whole.
+    glm::vec4 cone;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_MESHLET_HPP
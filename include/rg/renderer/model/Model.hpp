@@ -1,23 +1,101 @@
 #ifndef RG_RENDERER_MODEL_MODEL_HPP
 #define RG_RENDERER_MODEL_MODEL_HPP
 
+#include <rg/renderer/model/BoundingSphere.hpp>
+#include <rg/renderer/model/MaterialLibrary.hpp>
 #include <rg/renderer/model/Mesh.hpp>
-#include <rg/renderer/model/Texture.hpp>
+#include <rg/renderer/model/MeshOptimizer.hpp>
+#include <rg/renderer/model/Vertex.hpp>
 #include <rg/renderer/shader/Shader.hpp>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace rg {
 
+// A mesh as imported, before it is placed in an arena
+struct MeshData {
+    std::vector<PackedVertex> vertices;
+    // At most GeometryArena::MAX_MESH_VERTICES vertices, larger meshes are
+    // split on import
+    std::vector<GeometryArena::Index> indices;
+    // Parts of the indices, from full to the least detail
+    std::vector<MeshLod> lods;
+    // Of the full detail indices
+    std::vector<Meshlet> meshlets;
+    VertexQuantization quantization;
+    // Paths of the first texture of each type, empty if there is none
+    std::string diffuse;
+    std::string specular;
+    // The ShaderFeatures which do not depend on the textures
+    std::uint32_t features;
+};
+
+struct ModelData {
+    std::vector<MeshData> meshes;
+    BoundingSphere bounds;
+    // Of the index order in the file and of the optimized one
+    VertexCacheStats loaded_order;
+    VertexCacheStats optimized_order;
+    // Whether the file could be imported
+    bool valid = false;
+};
+
+class ModelCache;
+
 class Model {
 public:
-    explicit Model(const std::string& path);
+    /**
+     * Read the model file, optimize the meshes for the vertex cache,
+     * overdraw and vertex fetch, build their levels of detail and meshlets
+     * and pack their vertices, or take them from the cache. Touches no GL
+     * state, so it may run on any thread.
+     */
+    static ModelData import(const std::string& path);
+    /**
+     * Models imported from now on are loaded from and saved to the cache.
+     * nullptr disables it.
+     */
+    static void use_cache(ModelCache* cache);
+
+    /**
+     * Load the model, placing its meshes in the arena and its textures in the
+     * material library. The arena has to use the layout of
+     * rg::PackedVertex.
+     */
+    Model(const std::string& path, GeometryArena& arena,
+          MaterialLibrary& library);
+
+    /**
+     * Replace the meshes with the imported ones, freeing the ranges of the
+     * old ones. The Model stays where it is, so whatever refers to it draws
+     * the new meshes. Call on the GL thread, when no recording is under way.
+     * Call MaterialLibrary::update() afterwards.
+     */
+    void reload(const ModelData& data, GeometryArena& arena,
+                MaterialLibrary& library);
 
     void draw(const Shader& shader) const;
 
+    [[nodiscard]] const std::string& get_path() const;
+    [[nodiscard]] const std::vector<Mesh>& get_meshes() const;
+
+    // In model space. May be called while the render thread reloads.
+    [[nodiscard]] const BoundingSphere& get_bounds() const;
+
 private:
+    std::string path_;
     std::vector<Mesh> meshes_;
+    // A reload writes the slot which is not current and then flips current_,
+    // so the simulation thread never reads half written bounds
+    std::array<BoundingSphere, 2> bounds_;
+    std::atomic<std::uint32_t> current_;
+
+    void upload(const ModelData& data, GeometryArena& arena,
+                MaterialLibrary& library);
 };
 
 } // namespace rg
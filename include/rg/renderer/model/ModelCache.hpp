@@ -0,0 +1,41 @@
+#ifndef RG_RENDERER_MODEL_MODELCACHE_HPP
+#define RG_RENDERER_MODEL_MODELCACHE_HPP
+
+#include <rg/renderer/model/Model.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace rg {
+
+/**
+ * Imported and optimized models saved to disk, so that a model is only read
+ * with Assimp and optimized once. Entries are keyed by the path, size and
+ * modification time of the model file and of the material libraries next to
+ * it, so an edited model simply misses. Touches no GL state, and any thread
+ * may use it.
+ */
+class ModelCache {
+public:
+    explicit ModelCache(std::string directory);
+    ModelCache(const ModelCache& other) = delete;
+    ModelCache operator=(const ModelCache& other) = delete;
+
+    [[nodiscard]] std::uint64_t key(const std::string& path) const;
+    // @return std::nullopt if there is no entry, or it is of another layout
+    [[nodiscard]] std::optional<ModelData> load(std::uint64_t key) const;
+    void store(std::uint64_t key, const ModelData& data) const;
+
+    [[nodiscard]] bool is_enabled() const;
+
+private:
+    std::string directory_;
+    bool enabled_;
+
+    [[nodiscard]] std::string path(std::uint64_t key) const;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_MODEL_MODELCACHE_HPP
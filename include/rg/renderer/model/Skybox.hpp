@@ -12,9 +12,10 @@ namespace rg {
 
 class Skybox {
 public:
-    Skybox(const std::string& path, const std::vector<std::string>& faces);
     Skybox(const std::string& path, const std::vector<std::string>& faces,
-           std::shared_ptr<MeshVertexData> cube);
+           JobSystem* jobs = nullptr);
+    Skybox(const std::string& path, const std::vector<std::string>& faces,
+           std::shared_ptr<MeshVertexData> cube, JobSystem* jobs = nullptr);
 
     void draw(const Shader& shader) const;
 
@@ -7,9 +7,17 @@
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace rg {
 
 struct Vertex {
+    using Layout = StaticVertexLayout<Attribute<ElementType::FLOAT, 3>,
+                                      Attribute<ElementType::FLOAT, 3>,
+                                      Attribute<ElementType::FLOAT, 2>>;
+
     glm::vec3 position;
     glm::vec3 normal;
     glm::vec2 texture_coordinates;
@@ -18,12 +26,56 @@ struct Vertex {
     Vertex(glm::vec3 position, glm::vec3 normal, glm::vec2 texture_coordinates);
 };
 
+// Maps the packed positions of a mesh back to model space:
+// offset + position * scale
+struct VertexQuantization {
+    glm::vec3 offset;
+    float scale;
+};
+
+// A Vertex in half the size, as the models are drawn
+struct PackedVertex {
+    using Layout =
+            StaticVertexLayout<Attribute<ElementType::SHORT, 4, true>,
+                               Attribute<ElementType::SHORT, 2, true>,
+                               Attribute<ElementType::HALF_FLOAT, 2>>;
+
+    // Four signed normalized 16-bit components, the last one is 1
+    std::uint64_t position;
+    // Octahedral encoding in two signed normalized 16-bit components
+    std::uint32_t normal;
+    // Two half floats
+    std::uint32_t texture_coordinates;
+};
+
+static_assert(Vertex::Layout::stride == sizeof(Vertex));
+static_assert(Vertex::Layout::offsets[0] == offsetof(Vertex, position));
+static_assert(Vertex::Layout::offsets[1] == offsetof(Vertex, normal));
+static_assert(Vertex::Layout::offsets[2] ==
+              offsetof(Vertex, texture_coordinates));
+
+static_assert(sizeof(PackedVertex) == 16);
+static_assert(PackedVertex::Layout::stride == sizeof(PackedVertex));
+static_assert(PackedVertex::Layout::offsets[0] ==
+              offsetof(PackedVertex, position));
+static_assert(PackedVertex::Layout::offsets[1] ==
+              offsetof(PackedVertex, normal));
+static_assert(PackedVertex::Layout::offsets[2] ==
+              offsetof(PackedVertex, texture_coordinates));
+
+// Centered on the bounding box of the vertices, scaled to its longest side
+VertexQuantization findQuantization(const std::vector<Vertex>& vertices);
+PackedVertex pack(const Vertex& vertex,
+                  const VertexQuantization& quantization);
+
 } // namespace rg
 
 namespace rg::util {
 
 template <>
 VertexLayout layout<Vertex>();
+template <>
+VertexLayout layout<PackedVertex>();
 
 } // namespace rg::util
 
@@ -1,12 +1,18 @@
 #ifndef RG_RENDERER_RENDER_HPP
 #define RG_RENDERER_RENDER_HPP
 
+#include <rg/renderer/DrawList.hpp>
+#include <rg/renderer/LodSelector.hpp>
+#include <rg/renderer/camera/DepthPyramid.hpp>
 #include <rg/renderer/camera/Surface.hpp>
+#include <rg/renderer/command/CommandBuffer.hpp>
 #include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/model/MaterialLibrary.hpp>
 #include <rg/renderer/model/Model.hpp>
 #include <rg/renderer/model/Skybox.hpp>
 #include <rg/renderer/model/Transform.hpp>
 #include <rg/renderer/shader/Shader.hpp>
+#include <rg/renderer/shader/ShaderVariants.hpp>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -18,6 +24,46 @@ void render(const Shader& shader, const Model& model,
             const Transform& transform);
 void render(const Shader& shader, const Model& model,
             const Transform& transform, float shininess);
+/**
+ * Record the lit items with the variants of their materials, then the
+ * emissive items with the light shader, as seen from the view. The
+ * light_features are the LIGHT_FEATURES of the scene. Each mesh is a separate
+ * draw, at the level of detail the selector of the view picks. Call
+ * lods.begin() first. Makes no GL calls.
+ */
+void record(const ShaderVariants& shaders, std::uint32_t light_features,
+            const Shader& light_shader, const View& view, LodSelector& lods,
+            const DrawList& list, CommandBuffer& commands);
+/**
+ * Like record(), but the meshes are grouped by program, vertex array and
+ * textures, and each group is a single multi draw indirect. Lit meshes at
+ * full detail are drawn as their meshlets, culled on the CPU against the
+ * frustum and by their normal cones.
+ */
+void recordIndirect(const ShaderVariants& shaders,
+                    std::uint32_t light_features, const Shader& light_shader,
+                    const View& view, LodSelector& lods, const DrawList& list,
+                    CommandBuffer& commands);
+/**
+ * Like recordIndirect(), but the draws go through a culling pass on the GPU
+ * first. It tests the bounds of each draw against the view frustum and the
+ * depth pyramid of the previous frame, and packs the visible draws of every
+ * batch for glMultiDrawElementsIndirectCount. Meshlets are candidates of their
+ * own, which are also tested by their normal cones.
+ */
+void recordCulled(const ShaderVariants& shaders, std::uint32_t light_features,
+                  const Shader& light_shader, const Shader& cull_shader,
+                  const DepthPyramid& pyramid, const View& view,
+                  LodSelector& lods, const DrawList& list,
+                  CommandBuffer& commands);
+
+/**
+ * Request the mip levels the textures of the lit items need, as they are
+ * seen from the view on a surface height pixels tall. An item's textures are
+ * taken to span its bounding sphere once. Makes no GL calls.
+ */
+void requestMips(MaterialLibrary& library, const View& view,
+                 unsigned int height, const DrawList& list);
 
 void render(const Shader& skybox_shader, const Skybox& skybox);
 
@@ -0,0 +1,59 @@
+#ifndef RG_RENDERER_SHADER_PROGRAMCACHE_HPP
+#define RG_RENDERER_SHADER_PROGRAMCACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rg {
+
+/**
+ * Linked programs saved to disk with glGetProgramBinary. Entries are keyed by
+ * a hash of the stage sources and of the vendor, renderer and version of the
+ * driver, so an edited shader or an updated driver simply misses. A binary
+ * the driver rejects is deleted and the program is built from source again.
+ */
+class ProgramCache {
+public:
+    // A stage type and its source
+    using Stage = std::pair<unsigned int, const std::string*>;
+
+    // Needs the GL context, to ask for the driver strings
+    explicit ProgramCache(std::string directory);
+    ProgramCache(const ProgramCache& other) = delete;
+    ProgramCache operator=(const ProgramCache& other) = delete;
+
+    [[nodiscard]] std::uint64_t key(const std::vector<Stage>& stages) const;
+    /**
+     * @return the program created from the cached binary, or 0 if there is
+     * none or the driver rejected it
+     */
+    unsigned int load(std::uint64_t key);
+    // Save the binary of a program linked with the retrievable hint
+    void store(std::uint64_t key, unsigned int program) const;
+
+    // Account for the time spent creating a program
+    void count(std::chrono::duration<double, std::milli> time);
+    // Log the number of programs, how many came from the cache and the time
+    // they took
+    void report() const;
+
+    [[nodiscard]] bool is_enabled() const;
+
+private:
+    std::string directory_;
+    std::string driver_;
+    bool enabled_;
+
+    unsigned int programs_;
+    unsigned int hits_;
+    std::chrono::duration<double, std::milli> time_;
+
+    [[nodiscard]] std::string path(std::uint64_t key) const;
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_SHADER_PROGRAMCACHE_HPP
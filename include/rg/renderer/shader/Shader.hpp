@@ -12,16 +12,33 @@
 #include <rg/renderer/model/Transform.hpp>
 
 #include <string>
+#include <vector>
 
 namespace rg {
 
 class Shader {
 public:
+    // Compile and wait for the program. ShaderCompiler builds programs in
+    // batches instead.
     static Shader compile(const std::string& vertex_source,
                           const std::string& fragment_source);
+    /**
+     * Compile a variant of the program, with each of the defines injected
+     * into both stages right after the #version line.
+     */
+    static Shader compile(const std::string& vertex_source,
+                          const std::string& fragment_source,
+                          const std::vector<std::string>& defines);
+    // A compute program
+    static Shader compile(const std::string& compute_source);
+    Shader(const Shader& other) = delete;
+    Shader operator=(const Shader& other) = delete;
+    Shader(Shader&& other) noexcept;
+    Shader& operator=(Shader&& other) noexcept;
     ~Shader();
     void bind() const;
     void unbind() const;
+    [[nodiscard]] unsigned int id() const;
 
     void set(const std::string& uniform, const glm::vec2& value) const;
     void set(const std::string& uniform, const glm::vec3& value) const;
@@ -40,6 +57,8 @@ public:
     void set_float(const std::string& uniform, float value) const;
 
 private:
+    friend class ShaderCompiler;
+
     // NOLINTNEXTLINE(google-explicit-constructor)
     Shader(unsigned int id);
     [[nodiscard]] int get_uniform_location(const std::string& name) const;
@@ -0,0 +1,85 @@
+#ifndef RG_RENDERER_SHADER_SHADERCOMPILER_HPP
+#define RG_RENDERER_SHADER_SHADERCOMPILER_HPP
+
+#include <rg/renderer/shader/ProgramCache.hpp>
+#include <rg/renderer/shader/Shader.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+/**
+ * Builds programs in batches. Submitting only starts the compiles and links,
+ * and the statuses are not checked until finish(), so a driver with a
+ * threaded compiler works on every program of the batch while the caller
+ * goes on. A submitted Shader may be bound right away, at the cost of waiting
+ * for it.
+ */
+class ShaderCompiler {
+public:
+    using ProcLoader = void* (*)(const char*);
+
+    /**
+     * Let the driver compile on its own threads if it has
+     * KHR_parallel_shader_compile. The entry point is loaded through
+     * get_proc_address, as glad is generated without extensions.
+     */
+    static void enableParallel(ProcLoader get_proc_address);
+    /**
+     * Programs built from now on are loaded from and saved to the cache.
+     * nullptr disables it.
+     */
+    static void use_cache(ProgramCache* cache);
+
+    ShaderCompiler() = default;
+    ShaderCompiler(const ShaderCompiler& other) = delete;
+    ShaderCompiler operator=(const ShaderCompiler& other) = delete;
+    // Finishes whatever is still pending
+    ~ShaderCompiler();
+
+    Shader submit(const std::string& vertex_source,
+                  const std::string& fragment_source);
+    // With each of the defines injected right after the #version line
+    Shader submit(const std::string& vertex_source,
+                  const std::string& fragment_source,
+                  const std::vector<std::string>& defines);
+    // A compute program
+    Shader submit(const std::string& compute_source);
+
+    /**
+     * Whether finish() would not wait on the driver. Never blocks. Without
+     * parallel compilation the driver compiles when the statuses are queried
+     * anyway, so it is always true.
+     */
+    [[nodiscard]] bool ready() const;
+    /**
+     * Wait for the pending programs, log their errors and save them to the
+     * cache.
+     * @return whether every program compiled and linked
+     */
+    bool finish();
+    // Whether a finished program linked, e.g. to keep the others of a batch
+    [[nodiscard]] static bool linked(const Shader& shader);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        unsigned int program;
+        std::vector<unsigned int> shaders;
+        std::uint64_t key;
+        // Time the submitting thread spent on it
+        std::chrono::duration<double, std::milli> time;
+    };
+
+    std::vector<Pending> pending_;
+
+    Shader submit(const std::vector<ProgramCache::Stage>& stages);
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_SHADER_SHADERCOMPILER_HPP
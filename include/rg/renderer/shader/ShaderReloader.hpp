@@ -0,0 +1,79 @@
+#ifndef RG_RENDERER_SHADER_SHADERRELOADER_HPP
+#define RG_RENDERER_SHADER_SHADERRELOADER_HPP
+
+#include <rg/renderer/shader/Shader.hpp>
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+#include <rg/renderer/shader/ShaderVariants.hpp>
+#include <rg/util/FileWatcher.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+/**
+ * Rebuilds the watched programs when their sources in a directory change. A
+ * watcher thread notices the changes, their sources are read in one batch,
+ * the driver compiles the new programs in a batch while frames go on, and
+ * those which linked are swapped in between frames. Those which failed keep
+ * their previous programs in use.
+ */
+class ShaderReloader {
+public:
+    // Sets the uniforms which do not change on a replacement program
+    using Init = std::function<void(const Shader&)>;
+
+    explicit ShaderReloader(std::string directory);
+    ShaderReloader(const ShaderReloader& other) = delete;
+    ShaderReloader operator=(const ShaderReloader& other) = delete;
+
+    // Files are named relative to the directory
+    void watch(Shader& shader, std::string vertex_file,
+               std::string fragment_file, Init init = {});
+    void watch(Shader& shader, std::string compute_file, Init init = {});
+    void watch(ShaderVariants& variants, std::string vertex_file,
+               std::string fragment_file);
+
+    /**
+     * Swap in the programs of a finished reload, or start a reload of the
+     * programs whose files changed. Call on the thread with the GL context,
+     * before recording.
+     */
+    void update();
+
+private:
+    struct Entry {
+        // The stages, in the order the Shader is compiled with
+        std::vector<std::string> files;
+        Shader* shader;
+        ShaderVariants* variants;
+        Init init;
+    };
+
+    // The new programs of an entry, submitted and not swapped in yet
+    struct Replacement {
+        // Index into entries_
+        std::size_t entry;
+        std::vector<std::string> sources;
+        std::optional<Shader> shader;
+        ShaderVariants::Replacements variants;
+    };
+
+    std::string directory_;
+    util::FileWatcher watcher_;
+    std::vector<Entry> entries_;
+
+    std::unique_ptr<ShaderCompiler> compiler_;
+    std::vector<Replacement> replacements_;
+
+    void start(const std::vector<std::string>& changed);
+    void commit();
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_SHADER_SHADERRELOADER_HPP
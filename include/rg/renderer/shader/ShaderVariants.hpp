@@ -0,0 +1,93 @@
+#ifndef RG_RENDERER_SHADER_SHADERVARIANTS_HPP
+#define RG_RENDERER_SHADER_SHADERVARIANTS_HPP
+
+#include <rg/renderer/shader/Shader.hpp>
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rg {
+
+// Features a variant of a program is compiled with, each one a #define of
+// the same name. Materials set the first two, the lights of the scene the
+// rest.
+enum ShaderFeature : std::uint32_t {
+    // The material has a specular map, otherwise there are no highlights
+    SPECULAR_MAP = 1U << 0U,
+    // The material ignores the lights
+    UNLIT = 1U << 1U,
+    POINT_LIGHTS = 1U << 2U,
+    SPOTLIGHTS = 1U << 3U,
+};
+
+constexpr std::uint32_t MATERIAL_FEATURES = SPECULAR_MAP | UNLIT;
+constexpr std::uint32_t LIGHT_FEATURES = POINT_LIGHTS | SPOTLIGHTS;
+
+/**
+ * Variants of one program, specialised by a mask of ShaderFeatures and cached
+ * by it, so fragments do not pay for the features their material or the
+ * scene does not use.
+ */
+class ShaderVariants {
+public:
+    // Called on every new variant, to set the uniforms which do not change
+    using Init = std::function<void(std::uint32_t features, const Shader&)>;
+
+    ShaderVariants(std::string vertex_source, std::string fragment_source,
+                   Init init);
+    ShaderVariants(const ShaderVariants& other) = delete;
+    ShaderVariants operator=(const ShaderVariants& other) = delete;
+
+    /**
+     * Submit the variants of the material feature sets under every
+     * combination of lights, and the variant with every feature but UNLIT,
+     * which stands in for the variants that are missing. Call initialize()
+     * once the compiler has finished.
+     */
+    void precompile(const std::vector<std::uint32_t>& material_features,
+                    ShaderCompiler& compiler);
+    // Run init on the variants submitted by precompile()
+    void initialize();
+    // Compile a variant if it is not cached yet. Needs the GL context.
+    const Shader& compile(std::uint32_t features);
+
+    using Replacements = std::vector<std::pair<std::uint32_t, Shader>>;
+    // Submit a replacement of every variant, built from new sources
+    Replacements rebuild(const std::string& vertex_source,
+                         const std::string& fragment_source,
+                         ShaderCompiler& compiler) const;
+    // Swap in the finished replacements, and keep their sources for new
+    // variants
+    void replace(std::string vertex_source, std::string fragment_source,
+                 Replacements replacements);
+
+    /**
+     * A cached variant, or the complete one if it was never compiled. Safe
+     * to call while recording on other threads.
+     */
+    [[nodiscard]] const Shader& get(std::uint32_t features) const;
+
+    template <class F>
+    void for_each(F&& f) const {
+        for (const auto& [features, shader] : variants_)
+            f(features, shader);
+    }
+
+private:
+    std::string vertex_source_;
+    std::string fragment_source_;
+    Init init_;
+    std::unordered_map<std::uint32_t, Shader> variants_;
+    std::vector<std::uint32_t> uninitialized_;
+
+    void submit(std::uint32_t features, ShaderCompiler& compiler);
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_SHADER_SHADERVARIANTS_HPP
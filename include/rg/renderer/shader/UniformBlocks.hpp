@@ -0,0 +1,103 @@
+#ifndef RG_RENDERER_SHADER_UNIFORMBLOCKS_HPP
+#define RG_RENDERER_SHADER_UNIFORMBLOCKS_HPP
+
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/command/CommandBuffer.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdint>
+
+namespace rg {
+
+// Mirrors of the std140 uniform blocks and the std430 storage blocks declared
+// by the shaders. The binding points are fixed in the shaders with
+// layout(binding = ...).
+
+enum UniformBinding : unsigned int {
+    VIEW_BLOCK_BINDING = 0,
+    CULL_BLOCK_BINDING = 1,
+};
+
+// Shader storage binding points are separate from the uniform ones
+enum StorageBinding : unsigned int {
+    DRAW_STORAGE_BINDING = 0,
+    CANDIDATE_STORAGE_BINDING = 1,
+    CULLED_STORAGE_BINDING = 2,
+    COUNT_STORAGE_BINDING = 3,
+    MATERIAL_STORAGE_BINDING = 4,
+};
+
+struct ViewBlock {
+    glm::mat4 view_matrix;
+    glm::mat4 projection_matrix;
+    glm::vec4 camera_position;
+    glm::vec4 camera_direction;
+
+    static ViewBlock from(const View& view);
+};
+
+// An element of the draws[] array, which a draw indexes with
+// gl_BaseInstance + gl_InstanceID
+struct DrawData {
+    glm::mat4 model_matrix;
+    glm::mat4 normal_matrix;
+    glm::vec4 color;
+    float shininess;
+    std::uint32_t material;
+    float padding[2];
+    // The VertexQuantization of the mesh: offset and scale
+    glm::vec4 quantization;
+};
+
+// An element of the materials[] array: layers of the diffuse and specular
+// texture arrays bound for the draw
+struct MaterialData {
+    std::uint32_t diffuse_layer;
+    std::uint32_t specular_layer;
+};
+
+// Parameters of the culling pass
+struct CullBlock {
+    // Frustum planes, normalized with the normals pointing inside
+    glm::vec4 planes[6];
+    // Size of the depth pyramid's base level in texels
+    glm::vec2 pyramid_size;
+    // 0 turns the occlusion test off
+    std::uint32_t pyramid_levels;
+    std::uint32_t candidate_count;
+    float z_near;
+    float padding[3];
+};
+
+// A draw for the culling pass to test. The visible ones are copied to
+// culled[batch_first + n] with n counted by counts[batch].
+struct CullCandidate {
+    // Model space bounding sphere: center and radius
+    glm::vec4 sphere;
+    // The normal cone of a meshlet, see Meshlet. A w of 1 turns the backface
+    // test off.
+    glm::vec4 cone;
+    DrawElementsIndirectCommand command;
+    std::uint32_t batch;
+    std::uint32_t batch_first;
+    std::uint32_t padding;
+};
+
+static_assert(sizeof(ViewBlock) == 160);
+static_assert(sizeof(DrawData) == 176);
+static_assert(sizeof(MaterialData) == 8);
+static_assert(sizeof(CullBlock) == 128);
+static_assert(sizeof(CullCandidate) == 64);
+
+// Texture units of the samplers, assigned once after compiling
+enum TextureUnit : unsigned int {
+    DIFFUSE_TEXTURE_UNIT = 0,
+    SPECULAR_TEXTURE_UNIT = 1,
+    DEPTH_PYRAMID_TEXTURE_UNIT = 2,
+};
+
+} // namespace rg
+
+#endif // RG_RENDERER_SHADER_UNIFORMBLOCKS_HPP
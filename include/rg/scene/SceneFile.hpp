@@ -0,0 +1,203 @@
+#ifndef RG_SCENE_SCENEFILE_HPP
+#define RG_SCENE_SCENEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rg::scene {
+
+// Compiled scene layout
+// ---------------------
+// The binary scene is a Header followed by tightly packed arrays of the
+// records below and a string table. All offsets are in bytes from the start
+// of the file and every record is 4-byte aligned, so a mapped file can be
+// walked in place without any per-node allocation.
+
+inline constexpr std::uint32_t MAGIC = 0x43534752; // "RGSC"
+inline constexpr std::uint32_t VERSION = 1;
+
+struct Section {
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t size;
+    Section models;
+    Section objects;
+    Section floors;
+    Section directional_lights;
+    Section point_lights;
+    Section spotlights;
+    Section cameras;
+    Section strings;
+};
+
+struct TransformRecord {
+    float position[3];
+    float orientation[4]; // quaternion, w x y z
+    float scale[3];
+};
+
+struct ColorRecord {
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+};
+
+struct AttenuationRecord {
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct ModelRecord {
+    std::uint32_t name; // string table offset
+    std::uint32_t path; // string table offset, relative to the resources
+};
+
+enum ObjectFlags : std::uint32_t {
+    OBJECT_RIGID_BODY = 1U << 0U,
+    OBJECT_EMISSIVE = 1U << 1U,
+    OBJECT_LIGHT = 1U << 2U,
+};
+
+struct ObjectRecord {
+    std::uint32_t model; // index into the model records
+    std::uint32_t flags;
+    TransformRecord transform;
+    float shininess;
+    // OBJECT_RIGID_BODY
+    float velocity[3];
+    float radius;
+    // OBJECT_LIGHT: index into the spotlight records and its placement
+    // relative to the object
+    std::uint32_t spotlight;
+    float light_offset[3];
+    float light_direction[3];
+};
+
+// A width x height grid of tiles on each side of the root transform
+struct FloorRecord {
+    std::uint32_t model;
+    TransformRecord transform;
+    float shininess;
+    std::int32_t width;
+    std::int32_t height;
+};
+
+struct DirectionalLightRecord {
+    float direction[3];
+    ColorRecord color;
+};
+
+struct PointLightRecord {
+    float position[3];
+    AttenuationRecord attenuation;
+    ColorRecord color;
+};
+
+enum SpotLightFlags : std::uint32_t {
+    SPOTLIGHT_FOLLOW_CAMERA = 1U << 0U,
+};
+
+struct SpotLightRecord {
+    float position[3];
+    float direction[3];
+    float cutoff_angle; // cosine
+    float weaken_angle; // cosine
+    AttenuationRecord attenuation;
+    ColorRecord color;
+    std::uint32_t flags;
+};
+
+struct CameraRecord {
+    float position[3];
+    float direction[3];
+    float fov;
+    float z_near;
+    float z_far;
+};
+
+template <class T>
+class Records {
+public:
+    Records(const T* data, std::size_t count) : data_{data}, count_{count} {
+    }
+
+    [[nodiscard]] const T* begin() const {
+        return data_;
+    }
+    [[nodiscard]] const T* end() const {
+        return data_ + count_;
+    }
+    [[nodiscard]] std::size_t size() const {
+        return count_;
+    }
+    const T& operator[](std::size_t index) const {
+        return data_[index];
+    }
+
+private:
+    const T* data_;
+    std::size_t count_;
+};
+
+/**
+ * A compiled scene. Binary scenes are memory mapped, JSON sources are
+ * compiled in memory first. Either way the records are read in place.
+ */
+class SceneFile {
+public:
+    /**
+     * Open a scene. Paths ending in ".json" are compiled on the fly, anything
+     * else is expected to be a binary produced by compile().
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    static SceneFile open(const std::string& path);
+    /**
+     * Compile the JSON scene description into the binary layout.
+     * @throws std::runtime_error if the description is invalid
+     */
+    static std::vector<std::byte> compile(const std::string& json_source);
+
+    SceneFile(const SceneFile& other) = delete;
+    SceneFile operator=(const SceneFile& other) = delete;
+    SceneFile(SceneFile&& other) noexcept;
+    SceneFile& operator=(SceneFile&& other) noexcept;
+    ~SceneFile();
+
+    [[nodiscard]] Records<ModelRecord> models() const;
+    [[nodiscard]] Records<ObjectRecord> objects() const;
+    [[nodiscard]] Records<FloorRecord> floors() const;
+    [[nodiscard]] Records<DirectionalLightRecord> directional_lights() const;
+    [[nodiscard]] Records<PointLightRecord> point_lights() const;
+    [[nodiscard]] Records<SpotLightRecord> spotlights() const;
+    [[nodiscard]] Records<CameraRecord> cameras() const;
+    [[nodiscard]] std::string_view string(std::uint32_t offset) const;
+
+private:
+    SceneFile();
+
+    const std::byte* data_;
+    std::size_t size_;
+    // Set when the file is memory mapped
+    void* mapping_;
+    // Set when the scene was compiled in memory or could not be mapped
+    std::vector<std::byte> owned_;
+
+    [[nodiscard]] const Header& header() const;
+    template <class T>
+    [[nodiscard]] Records<T> section(const Section& section) const;
+    void validate() const;
+    void release();
+};
+
+} // namespace rg::scene
+
+#endif // RG_SCENE_SCENEFILE_HPP
@@ -0,0 +1,101 @@
+#ifndef RG_UTIL_FILELOADER_HPP
+#define RG_UTIL_FILELOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rg {
+
+class JobCounter;
+class JobSystem;
+
+} // namespace rg
+
+namespace rg::util {
+
+// A read of part of a file into memory the caller owns
+struct FileRead {
+    std::string path;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::byte* destination;
+    // Set by the loader: whether all size bytes were read
+    bool complete = false;
+};
+
+// A whole file to read in a batch and hand to a job once it is read
+struct FileJob {
+    std::string path;
+    // Called with the contents of the file, or std::nullopt if it could not
+    // be read. The contents are only valid during the call.
+    std::function<void(std::optional<std::string_view>)> done;
+    // Counts the job which calls done
+    JobCounter* counter;
+};
+
+/**
+ * Reads parts of files in batches. The io_uring loader submits the whole
+ * batch to the kernel at once, so a cold start waits on the bandwidth of the
+ * device rather than on the latency of each read. Batches are read one at a
+ * time, from any thread.
+ */
+class FileLoader {
+public:
+    // Called on the reading thread as each read of a batch is done
+    using Completion = std::function<void(const FileRead&)>;
+
+    // With io_uring where the kernel has it, with pread otherwise
+    static std::unique_ptr<FileLoader> create();
+    // The loader the asset loaders share, created on first use
+    static FileLoader& shared();
+
+    FileLoader() = default;
+    FileLoader(const FileLoader& other) = delete;
+    FileLoader operator=(const FileLoader& other) = delete;
+    virtual ~FileLoader() = default;
+
+    /**
+     * Read every one of the reads and return once they are done, whether
+     * they completed or not. Each read is passed to the completion as soon
+     * as it is done. The destinations of a batch may not overlap.
+     */
+    void read(std::vector<FileRead>& reads, const Completion& completed = {});
+    /**
+     * Read the whole files in one batch. Files in the mounted resource pack
+     * are copied from it instead.
+     * @return the contents of each file, std::nullopt if it could not be read
+     */
+    std::vector<std::optional<std::string>>
+    read_files(const std::vector<std::string>& paths);
+    /**
+     * Read the whole files in one batch, and run the done of each as a job
+     * as soon as its read completes, so that decoding overlaps the reads
+     * still in flight. Files in the mounted resource pack are handed over
+     * without a read. Returns once every read is done, the jobs may still be
+     * running. Without a job system or its workers, the done of each file
+     * runs on the calling thread once the batch is read.
+     */
+    void submit(std::vector<FileJob> files, JobSystem* jobs);
+
+    // For the logs
+    [[nodiscard]] virtual const char* name() const = 0;
+
+protected:
+    // Read the batch, passing each read to the completion once it is done
+    virtual void readBatch(std::vector<FileRead>& reads,
+                           const Completion& completed) = 0;
+
+private:
+    std::mutex mutex_;
+};
+
+} // namespace rg::util
+
+#endif // RG_UTIL_FILELOADER_HPP
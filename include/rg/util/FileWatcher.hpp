@@ -0,0 +1,48 @@
+#ifndef RG_UTIL_FILEWATCHER_HPP
+#define RG_UTIL_FILEWATCHER_HPP
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rg::util {
+
+/**
+ * Watches the files inside a directory and the subdirectories it has when
+ * constructed on a background thread, using inotify. A file counts as changed
+ * once it is closed after writing or moved into place, which covers editors
+ * that save through a temporary file. Does nothing on platforms without
+ * inotify.
+ */
+class FileWatcher {
+public:
+    explicit FileWatcher(std::string directory);
+    FileWatcher(const FileWatcher& other) = delete;
+    FileWatcher operator=(const FileWatcher& other) = delete;
+    ~FileWatcher();
+
+    // Paths of the files changed since the last call, relative to the
+    // directory, such as "backpack/diffuse.jpg"
+    std::vector<std::string> poll();
+
+private:
+    std::string directory_;
+    int fd_;
+    // The directory of each watch descriptor, relative to directory_, empty
+    // for directory_ itself
+    std::map<int, std::string> subdirectories_;
+    std::atomic<bool> stop_;
+    std::mutex mutex_;
+    std::set<std::string> changed_;
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace rg::util
+
+#endif // RG_UTIL_FILEWATCHER_HPP
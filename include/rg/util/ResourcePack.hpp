@@ -0,0 +1,113 @@
+#ifndef RG_UTIL_RESOURCEPACK_HPP
+#define RG_UTIL_RESOURCEPACK_HPP
+
+#include <rg/util/FileLoader.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rg::util {
+
+// Resource pack layout
+// --------------------
+// A PackHeader, the PackEntry of every file sorted by path, a string table
+// of the paths and then the contents of the files. Each file starts on a
+// PACK_ALIGNMENT boundary, so that reading one only faults in its own pages.
+
+inline constexpr std::uint32_t PACK_MAGIC = 0x4B504752; // "RGPK"
+inline constexpr std::uint32_t PACK_VERSION = 1;
+inline constexpr std::uint64_t PACK_ALIGNMENT = 4096;
+
+struct PackHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    // Of the string table after the entries
+    std::uint32_t strings_size;
+    std::uint64_t size;
+};
+
+struct PackEntry {
+    // From the start of the pack
+    std::uint64_t offset;
+    std::uint64_t size;
+    // Into the string table, relative to the packed directory and with
+    // forward slashes, such as "shaders/cull.cs.glsl"
+    std::uint32_t path;
+    std::uint32_t path_size;
+};
+
+/**
+ * The files of a directory in a single file, built by rg-pack, either
+ * memory mapped or read whole. Lookups return views into the pack, without
+ * copying.
+ */
+class ResourcePack {
+public:
+    /**
+     * Map the pack, so that lookups are views into the page cache without a
+     * copy. Where it cannot be mapped it is read whole instead.
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    static ResourcePack open(const std::string& path);
+    /**
+     * Read the whole pack into memory in one batch of large reads rather
+     * than mapping it. It costs a copy of the pack, but a cold start waits
+     * on the bandwidth of the device rather than on a page fault at a time.
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    static ResourcePack read(const std::string& path, FileLoader& loader);
+    /**
+     * Pack every file under the directory into the output file.
+     * @throws std::runtime_error if a file cannot be read or written
+     */
+    static void write(const std::string& directory, const std::string& output);
+
+    /**
+     * Loaders look their files up in the pack while it is mounted, if they
+     * are under the directory it was built from. Mount before any loader
+     * runs; the pack has to outlive the views they got from it.
+     */
+    static void mount(const ResourcePack& pack, const std::string& directory);
+    // Loaders read the file system from now on, e.g. once files are edited
+    static void unmount();
+    // The contents of the file at the path in the mounted pack, if any
+    static std::optional<std::string_view> lookup(const std::string& path);
+
+    ResourcePack(const ResourcePack& other) = delete;
+    ResourcePack operator=(const ResourcePack& other) = delete;
+    ResourcePack(ResourcePack&& other) noexcept;
+    ResourcePack& operator=(ResourcePack&& other) noexcept;
+    ~ResourcePack();
+
+    // The contents of the file at the path relative to the packed directory
+    [[nodiscard]] std::optional<std::string_view>
+    find(std::string_view path) const;
+    [[nodiscard]] std::size_t file_count() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool is_mapped() const;
+
+private:
+    ResourcePack();
+
+    const std::byte* data_;
+    std::size_t size_;
+    // Set when the file is memory mapped
+    void* mapping_;
+    // Set when the file was read, or could not be mapped
+    std::vector<std::byte> owned_;
+
+    [[nodiscard]] const PackHeader& header() const;
+    [[nodiscard]] const PackEntry* entries() const;
+    [[nodiscard]] std::string_view path(const PackEntry& entry) const;
+    void validate() const;
+    void release();
+};
+
+} // namespace rg::util
+
+#endif // RG_UTIL_RESOURCEPACK_HPP
@@ -0,0 +1,57 @@
+#ifndef RG_UTIL_JSON_HPP
+#define RG_UTIL_JSON_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rg::util {
+
+/**
+ * Minimal read-only JSON document, enough for configuration and scene files.
+ * Object members keep their order from the source. Accessors throw
+ * std::runtime_error when the value has a different type or a key is missing.
+ */
+class Json {
+public:
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+    using Member = std::pair<std::string, Json>;
+
+    Json();
+    static Json parse(const std::string& source);
+
+    [[nodiscard]] Type type() const;
+    [[nodiscard]] bool is_null() const;
+
+    [[nodiscard]] bool as_bool() const;
+    [[nodiscard]] double as_number() const;
+    [[nodiscard]] float as_float() const;
+    [[nodiscard]] int as_int() const;
+    [[nodiscard]] const std::string& as_string() const;
+    [[nodiscard]] const std::vector<Json>& as_array() const;
+    [[nodiscard]] const std::vector<Member>& as_object() const;
+
+    /**
+     * @return the member with the given key, or nullptr if there is none
+     */
+    [[nodiscard]] const Json* find(const std::string& key) const;
+    [[nodiscard]] const Json& operator[](const std::string& key) const;
+    [[nodiscard]] const Json& operator[](std::size_t index) const;
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    class Parser;
+
+    Type type_;
+    bool boolean_;
+    double number_;
+    std::string string_;
+    std::vector<Json> array_;
+    std::vector<Member> object_;
+
+    void expect(Type type) const;
+};
+
+} // namespace rg::util
+
+#endif // RG_UTIL_JSON_HPP
@@ -0,0 +1,68 @@
+#version 460 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// Downsampling filters a level from the larger one above it, the first level
+// from the scene. Upsampling adds the smaller level below to a level.
+uniform bool upsample;
+// Only on the first level: keep what is brighter than the threshold
+uniform bool prefilter;
+uniform float threshold;
+uniform sampler2D source;
+uniform int source_level;
+layout(rgba16f, binding = 0) uniform image2D destination;
+
+float brightness(vec3 color) {
+    return max(color.r, max(color.g, color.b));
+}
+
+vec3 sampleSource(vec2 uv) {
+    return textureLod(source, uv, float(source_level)).rgb;
+}
+
+// Four bilinear taps, which average the 4x4 source texels around the texel
+vec3 downsample(vec2 uv, vec2 texel_size) {
+    vec3 a = sampleSource(uv + texel_size * vec2(-1.0f, -1.0f));
+    vec3 b = sampleSource(uv + texel_size * vec2(1.0f, -1.0f));
+    vec3 c = sampleSource(uv + texel_size * vec2(-1.0f, 1.0f));
+    vec3 d = sampleSource(uv + texel_size * vec2(1.0f, 1.0f));
+    if (!prefilter)
+        return (a + b + c + d) * 0.25f;
+
+    // Weighing the taps by their brightness keeps single very bright texels
+    // from flickering as the camera moves
+    vec4 weights = 1.0f / (1.0f + vec4(brightness(a), brightness(b),
+                                       brightness(c), brightness(d)));
+    vec3 color = (a * weights.x + b * weights.y + c * weights.z +
+                  d * weights.w) / dot(weights, vec4(1.0f));
+    float bright = brightness(color);
+    return color * max(bright - threshold, 0.0f) / max(bright, 1e-4f);
+}
+
+// A 3x3 tent
+vec3 tent(vec2 uv, vec2 texel_size) {
+    vec3 sum = vec3(0.0f);
+    for (int y = -1; y <= 1; ++y)
+        for (int x = -1; x <= 1; ++x) {
+            float weight = (2.0f - abs(float(x))) * (2.0f - abs(float(y)));
+            sum += weight * sampleSource(uv + texel_size * vec2(x, y));
+        }
+    return sum / 16.0f;
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+
+    vec2 uv = (vec2(texel) + 0.5f) / vec2(size);
+    vec2 texel_size = 1.0f / vec2(textureSize(source, source_level));
+    if (!upsample) {
+        imageStore(destination, texel, vec4(downsample(uv, texel_size), 1.0f));
+        return;
+    }
+
+    vec3 color = imageLoad(destination, texel).rgb + tent(uv, texel_size);
+    imageStore(destination, texel, vec4(color, 1.0f));
+}
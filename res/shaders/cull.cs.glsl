@@ -0,0 +1,155 @@
+#version 460 core
+
+layout(local_size_x = 64) in;
+
+struct Draw {
+    mat4 model_matrix;
+    mat4 normal_matrix;
+    vec4 color;
+    float shininess;
+    uint material;
+    // Maps the packed positions to model space: offset and scale
+    vec4 quantization;
+};
+
+// Laid out like the arguments of glMultiDrawElementsIndirect
+struct Command {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+struct Candidate {
+    // Model space bounding sphere: center and radius
+    vec4 sphere;
+    // Of a meshlet: the average normal and the sine of the spread around it.
+    // A w of 1 turns the backface test off.
+    vec4 cone;
+    Command command;
+    uint batch;
+    uint batch_first;
+    uint padding;
+};
+
+layout(std140, binding = 0) uniform ViewBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec4 camera_position;
+    vec4 camera_direction;
+};
+
+layout(std140, binding = 1) uniform CullBlock {
+    vec4 planes[6];
+    vec2 pyramid_size;
+    // 0 turns the occlusion test off
+    uint pyramid_levels;
+    uint candidate_count;
+    float z_near;
+};
+
+layout(std430, binding = 0) readonly buffer DrawBlock {
+    Draw draws[];
+};
+
+layout(std430, binding = 1) readonly buffer CandidateBlock {
+    Candidate candidates[];
+};
+
+// The visible candidates of a batch are packed from culled[batch_first], and
+// counted in counts[batch]
+layout(std430, binding = 2) writeonly buffer CulledBlock {
+    Command culled[];
+};
+
+layout(std430, binding = 3) buffer CountBlock {
+    uint counts[];
+};
+
+// The farthest depth of the previous frame, see depth_pyramid.cs.glsl
+layout(binding = 2) uniform sampler2D depth_pyramid;
+
+bool inFrustum(vec3 center, float radius) {
+    for (int i = 0; i < 6; ++i)
+        if (dot(planes[i].xyz, center) + planes[i].w < -radius)
+            return false;
+    return true;
+}
+
+// Whether every triangle in the sphere faces away from the camera
+bool backfacing(vec3 center, float radius, vec4 cone, mat4 normal_matrix) {
+    if (cone.w >= 1.0f)
+        return false;
+    vec3 axis = normalize(mat3(normal_matrix) * cone.xyz);
+    vec3 to_center = center - camera_position.xyz;
+    return dot(to_center, axis) >= cone.w * length(to_center) + radius;
+}
+
+bool occluded(vec3 center, float radius) {
+    if (pyramid_levels == 0u)
+        return false;
+
+    // The rectangle of a sphere crossing the near plane is unbounded
+    vec3 view_center = vec3(view_matrix * vec4(center, 1.0f));
+    if (-view_center.z - radius < z_near)
+        return false;
+
+    // Project the view space box around the sphere
+    vec3 low = vec3(1e30f);
+    vec3 high = vec3(-1e30f);
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = view_center + radius * vec3((i & 1) != 0 ? 1.0f : -1.0f,
+                                                  (i & 2) != 0 ? 1.0f : -1.0f,
+                                                  (i & 4) != 0 ? 1.0f : -1.0f);
+        vec4 clip = projection_matrix * vec4(corner, 1.0f);
+        vec3 ndc = clip.xyz / clip.w;
+        low = min(low, ndc);
+        high = max(high, ndc);
+    }
+
+    ivec2 size = ivec2(pyramid_size);
+    ivec2 first = clamp(ivec2((low.xy * 0.5f + 0.5f) * pyramid_size),
+                        ivec2(0), size - 1);
+    ivec2 last = clamp(ivec2((high.xy * 0.5f + 0.5f) * pyramid_size),
+                       ivec2(0), size - 1);
+    float nearest = low.z * 0.5f + 0.5f;
+
+    // The level at which the rectangle spans at most 2x2 texels
+    int extent = max(last.x - first.x, last.y - first.y);
+    int level = extent <= 1 ? 0 : findMSB(extent - 1) + 1;
+    level = min(level, int(pyramid_levels) - 1);
+
+    ivec2 level_size = textureSize(depth_pyramid, level);
+    ivec2 a = min(first >> level, level_size - 1);
+    ivec2 b = min(last >> level, level_size - 1);
+    float farthest = 0.0f;
+    for (int y = a.y; y <= b.y; ++y)
+        for (int x = a.x; x <= b.x; ++x)
+            farthest = max(farthest,
+                           texelFetch(depth_pyramid, ivec2(x, y), level).r);
+    return nearest > farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= candidate_count)
+        return;
+
+    Candidate candidate = candidates[index];
+    Draw draw = draws[candidate.command.base_instance];
+    mat4 model_matrix = draw.model_matrix;
+    vec3 center = vec3(model_matrix * vec4(candidate.sphere.xyz, 1.0f));
+    float scale = max(length(model_matrix[0].xyz),
+                      max(length(model_matrix[1].xyz),
+                          length(model_matrix[2].xyz)));
+    float radius = candidate.sphere.w * scale;
+
+    if (!inFrustum(center, radius) ||
+        backfacing(center, radius, candidate.cone, draw.normal_matrix) ||
+        occluded(center, radius))
+        return;
+
+    uint slot = atomicAdd(counts[candidate.batch], 1u);
+    culled[candidate.batch_first + slot] = candidate.command;
+}
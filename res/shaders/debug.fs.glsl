@@ -1,13 +1,12 @@
 #version 460 core
 
-struct Material {
-    sampler2D texture_diffuse1;
-};
-
 in vec2 tex_coords;
 out vec4 frag_color;
-uniform Material material;
+uniform sampler2DArray diffuse_textures;
+uniform int diffuse_layer;
 
 void main() {
-    frag_color = texture(material.texture_diffuse1, tex_coords);
+    frag_color = texture(diffuse_textures, vec3(tex_coords, diffuse_layer));
+    // The post chain encodes the surface with gamma
+    frag_color.rgb = pow(frag_color.rgb, vec3(2.2f));
 }
@@ -0,0 +1,39 @@
+#version 460 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// The base level is copied from the depth texture, every other level keeps
+// the farthest depth of the texels it covers in the level above
+uniform bool from_depth;
+uniform sampler2D depth;
+layout(r32f, binding = 0) readonly uniform image2D source;
+layout(r32f, binding = 1) writeonly uniform image2D destination;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+
+    if (from_depth) {
+        imageStore(destination, texel, vec4(texelFetch(depth, texel, 0).r));
+        return;
+    }
+
+    // The last row and column of an odd sized source have no texel of their
+    // own, so the texels next to them cover them as well
+    ivec2 source_size = imageSize(source);
+    ivec2 first = 2 * texel;
+    ivec2 last = first + ivec2(1);
+    if (texel.x == size.x - 1)
+        last.x = source_size.x - 1;
+    if (texel.y == size.y - 1)
+        last.y = source_size.y - 1;
+    last = min(last, source_size - 1);
+
+    float farthest = 0.0f;
+    for (int y = first.y; y <= last.y; ++y)
+        for (int x = first.x; x <= last.x; ++x)
+            farthest = max(farthest, imageLoad(source, ivec2(x, y)).r);
+    imageStore(destination, texel, vec4(farthest));
+}
@@ -1,8 +1,9 @@
 #version 460 core
 
 out vec4 frag_color;
-uniform vec3 light_color;
+
+flat in vec4 color;
 
 void main() {
-    frag_color = vec4(light_color, 1.0f);
+    frag_color = vec4(color.rgb, 1.0f);
 }
@@ -1,16 +1,38 @@
 #version 460 core
 
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoords;
 
-out vec2 light_color;
+flat out vec4 color;
 
-uniform mat4 model_matrix;
-uniform mat4 view_matrix;
-uniform mat4 projection_matrix;
+layout(std140, binding = 0) uniform ViewBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec4 camera_position;
+    vec4 camera_direction;
+};
+
+// Per draw data, indexed by the base instance of the draw
+struct Draw {
+    mat4 model_matrix;
+    mat4 normal_matrix;
+    vec4 color;
+    float shininess;
+    uint material;
+    // Maps the packed positions to model space: offset and scale
+    vec4 quantization;
+};
+
+layout(std430, binding = 0) readonly buffer DrawBlock {
+    Draw draws[];
+};
 
 void main() {
-    gl_Position =
-            projection_matrix * view_matrix * model_matrix * vec4(aPos, 1.0f);
+    Draw draw = draws[gl_BaseInstance + gl_InstanceID];
+    color = draw.color;
+
+    vec3 position = draw.quantization.xyz + aPos * draw.quantization.w;
+    gl_Position = projection_matrix * view_matrix * draw.model_matrix *
+                  vec4(position, 1.0f);
 }
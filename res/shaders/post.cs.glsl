@@ -0,0 +1,46 @@
+#version 460 core
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// Adds the bloom to the scene, then maps it to the screen: exposure, ACES
+// tonemapping and gamma
+uniform sampler2D scene;
+uniform sampler2D bloom;
+uniform float bloom_strength;
+uniform float exposure;
+layout(rgba8, binding = 0) writeonly uniform image2D destination;
+
+const float GAMMA = 2.2f;
+
+// The fit of the ACES curve by Krzysztof Narkowicz
+vec3 aces(vec3 color) {
+    return clamp((color * (2.51f * color + 0.03f)) /
+                 (color * (2.43f * color + 0.59f) + 0.14f), 0.0f, 1.0f);
+}
+
+// The last upsample of the bloom, a 3x3 tent over its first level
+vec3 upsampleBloom(vec2 uv) {
+    vec2 texel_size = 1.0f / vec2(textureSize(bloom, 0));
+    vec3 sum = vec3(0.0f);
+    for (int y = -1; y <= 1; ++y)
+        for (int x = -1; x <= 1; ++x) {
+            float weight = (2.0f - abs(float(x))) * (2.0f - abs(float(y)));
+            sum += weight * textureLod(bloom, uv + texel_size * vec2(x, y),
+                                       0.0f).rgb;
+        }
+    return sum / 16.0f;
+}
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(destination);
+    if (texel.x >= size.x || texel.y >= size.y)
+        return;
+
+    vec2 uv = (vec2(texel) + 0.5f) / vec2(size);
+    vec3 color = texelFetch(scene, texel, 0).rgb;
+    color += bloom_strength * upsampleBloom(uv);
+    color = aces(color * exposure);
+    color = pow(color, vec3(1.0f / GAMMA));
+    imageStore(destination, texel, vec4(color, 1.0f));
+}
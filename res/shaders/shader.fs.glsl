@@ -4,12 +4,6 @@
 #define MAX_POINT_LIGHTS 4
 #define MAX_SPOTLIGHTS 4
 
-struct Material {
-    sampler2D texture_diffuse1;
-    sampler2D texture_specular1;
-    float shininess;
-};
-
 struct LightColor {
     vec3 ambient;
     vec3 diffuse;
@@ -45,11 +39,6 @@ struct SpotLight {
     Attenuation attenuation;
 };
 
-struct Observer {
-    vec3 position;
-    vec3 direction;
-};
-
 out vec4 FragColor;
 
 // Input data from vertex shader
@@ -57,102 +46,94 @@ out vec4 FragColor;
 in vec3 position;
 in vec3 normal;
 in vec2 tex_coords;
+flat in float shininess;
+// Layers of the draw's material in the texture arrays
+flat in uvec2 layers;
+
+// Per view data
+// -------------
+layout(std140, binding = 0) uniform ViewBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec4 camera_position;
+    vec4 camera_direction;
+};
 
 // Lights
 // ------
+// Variants are compiled with POINT_LIGHTS and SPOTLIGHTS only if the scene
+// has such lights, and with neither for UNLIT materials
+#ifndef UNLIT
 uniform DirectionalLight directional_lights[MAX_DIRECTIONAL_LIGHTS];
-uniform PointLight point_lights[MAX_POINT_LIGHTS];
-uniform SpotLight spotlights[MAX_SPOTLIGHTS];
 uniform int active_directional_lights;
+#endif
+#ifdef POINT_LIGHTS
+uniform PointLight point_lights[MAX_POINT_LIGHTS];
 uniform int active_point_lights;
+#endif
+#ifdef SPOTLIGHTS
+uniform SpotLight spotlights[MAX_SPOTLIGHTS];
 uniform int active_spotlights;
+#endif
+
+// Material textures
+// -----------------
+uniform sampler2DArray diffuse_textures;
+#ifdef SPECULAR_MAP
+uniform sampler2DArray specular_textures;
+#endif
 
-uniform Material material;
-uniform Observer camera;
+// Sampled once per fragment
+vec3 diffuse_color;
+vec3 specular_color;
 
 float attenuation(Attenuation attenuation, float distance) {
     return 1.0f / (attenuation.constant + attenuation.linear * distance +
                    attenuation.quadratic * distance * distance);
 }
 
-vec3 calculateDirectionalLight(DirectionalLight light, vec3 norm,
-                               vec3 view_direction) {
-    vec3 ambient_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 diffuse_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 specular_color = vec3(texture(material.texture_specular1, tex_coords));
-
-    vec3 light_dir = normalize(-light.direction);
-
+// Ambient, diffuse and, with a specular map, specular light from a direction
+vec3 shade(LightColor color, vec3 light_dir, vec3 norm, vec3 view_direction) {
     // Ambient
     // -------
-    vec3 ambient = light.color.ambient * ambient_color;
+    vec3 ambient = color.ambient * diffuse_color;
 
     // Diffuse
     // -------
     float diff = max(dot(norm, light_dir), 0.0f);
-    vec3 diffuse = light.color.diffuse * diff * diffuse_color;
+    vec3 diffuse = color.diffuse * diff * diffuse_color;
 
+#ifdef SPECULAR_MAP
     // Specular
     // --------
     vec3 reflect_dir = reflect(-light_dir, norm);
     float spec = pow(max(dot(reflect_dir, view_direction), 0.0f),
-                     material.shininess);
-    vec3 specular = light.color.specular * spec * specular_color;
+                     shininess);
+    vec3 specular = color.specular * spec * specular_color;
 
-    return (ambient + diffuse + specular);
+    return ambient + diffuse + specular;
+#else
+    return ambient + diffuse;
+#endif
 }
 
-vec3 calculatePointLight(PointLight light, vec3 norm, vec3 view_direction) {
-    vec3 ambient_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 diffuse_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 specular_color = vec3(texture(material.texture_specular1, tex_coords));
+vec3 calculateDirectionalLight(DirectionalLight light, vec3 norm,
+                               vec3 view_direction) {
+    vec3 light_dir = normalize(-light.direction);
+    return shade(light.color, light_dir, norm, view_direction);
+}
 
+vec3 calculatePointLight(PointLight light, vec3 norm, vec3 view_direction) {
     vec3 light_dir = normalize(light.position - position);
 
-    // Ambient
-    // -------
-    vec3 ambient = light.color.ambient * ambient_color;
-
-    // Diffuse
-    // -------
-    float diff = max(dot(norm, light_dir), 0.0f);
-    vec3 diffuse = light.color.diffuse * diff * diffuse_color;
-
-    // Specular
-    // --------
-    vec3 reflect_dir = reflect(-light_dir, norm);
-    float spec = pow(max(dot(reflect_dir, view_direction), 0.0f),
-                     material.shininess);
-    vec3 specular = light.color.specular * spec * specular_color;
-
     float distance = length(light.position - position);
     float attenuation = attenuation(light.attenuation, distance);
-    return attenuation * (ambient + diffuse + specular);
+    return attenuation * shade(light.color, light_dir, norm, view_direction);
 }
 
 vec3 calculateSpotLight(SpotLight light, vec3 norm, vec3 view_direction) {
-    vec3 ambient_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 diffuse_color = vec3(texture(material.texture_diffuse1, tex_coords));
-    vec3 specular_color = vec3(texture(material.texture_specular1, tex_coords));
-
     vec3 light_dir = normalize(light.position - position);
 
-    // Ambient
-    // -------
-    vec3 ambient = light.color.ambient * ambient_color;
-
-    // Diffuse
-    // -------
-    float diff = max(dot(norm, light_dir), 0.0f);
-    vec3 diffuse = light.color.diffuse * diff * diffuse_color;
-
-    // Specular
-    // --------
-    vec3 reflect_dir = reflect(-light_dir, norm);
-    float spec = pow(max(dot(reflect_dir, view_direction), 0.0f),
-                     material.shininess);
-    vec3 specular = light.color.specular * spec * specular_color;
-
     float distance = length(light.position - position);
     float attenuation = attenuation(light.attenuation, distance);
 
@@ -160,21 +141,38 @@ vec3 calculateSpotLight(SpotLight light, vec3 norm, vec3 view_direction) {
     float epsilon = light.weaken_angle - light.cutoff_angle;
     float intensity = clamp((theta - light.cutoff_angle) / epsilon, 0.0f, 1.0f);
 
-    return intensity * attenuation * (ambient + diffuse + specular);
+    return intensity * attenuation *
+           shade(light.color, light_dir, norm, view_direction);
 }
 
 void main() {
+    diffuse_color = vec3(texture(diffuse_textures, vec3(tex_coords, layers.x)));
+    // Stored in sRGB, lit in linear space, encoded again by the post chain
+    diffuse_color = pow(diffuse_color, vec3(2.2f));
+#ifdef UNLIT
+    FragColor = vec4(diffuse_color, 1.0f);
+#else
+#ifdef SPECULAR_MAP
+    specular_color =
+            vec3(texture(specular_textures, vec3(tex_coords, layers.y)));
+#endif
+
     vec3 norm = normalize(normal);
-    vec3 view_direction = normalize(camera.position - position);
+    vec3 view_direction = normalize(camera_position.xyz - position);
 
     vec3 color = vec3(0.0f);
     for (int i = 0; i < active_directional_lights; ++i)
         color += calculateDirectionalLight(directional_lights[i], norm,
                                            view_direction);
+#ifdef POINT_LIGHTS
     for (int i = 0; i < active_point_lights; ++i)
         color += calculatePointLight(point_lights[i], norm, view_direction);
+#endif
+#ifdef SPOTLIGHTS
     for (int i = 0; i < active_spotlights; ++i)
         color += calculateSpotLight(spotlights[i], norm, view_direction);
+#endif
 
     FragColor = vec4(color, 1.0f);
+#endif
 }
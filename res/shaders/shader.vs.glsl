@@ -1,22 +1,64 @@
 #version 460 core
 layout(location = 0) in vec3 aPos;
-layout(location = 1) in vec3 aNormal;
+// Octahedral, see rg::PackedVertex
+layout(location = 1) in vec2 aNormal;
 layout(location = 2) in vec2 aTexCoords;
 
 out vec3 position;
 out vec3 normal;
 out vec2 tex_coords;
+flat out float shininess;
+flat out uvec2 layers;
 
-uniform mat4 model_matrix;
-uniform mat4 normal_matrix;
-uniform mat4 view_matrix;
-uniform mat4 projection_matrix;
+layout(std140, binding = 0) uniform ViewBlock {
+    mat4 view_matrix;
+    mat4 projection_matrix;
+    vec4 camera_position;
+    vec4 camera_direction;
+};
+
+// Per draw data, indexed by the base instance of the draw
+struct Draw {
+    mat4 model_matrix;
+    mat4 normal_matrix;
+    vec4 color;
+    float shininess;
+    uint material;
+    // Maps the packed positions to model space: offset and scale
+    vec4 quantization;
+};
+
+layout(std430, binding = 0) readonly buffer DrawBlock {
+    Draw draws[];
+};
+
+struct Material {
+    uint diffuse_layer;
+    uint specular_layer;
+};
+
+layout(std430, binding = 4) readonly buffer MaterialBlock {
+    Material materials[];
+};
+
+// Unfold the octahedral encoding of a normal
+vec3 octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    if (n.z < 0.0f)
+        n.xy = (1.0f - abs(n.yx)) *
+               vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    return normalize(n);
+}
 
 void main() {
-    position = vec3(model_matrix * vec4(aPos, 1.0f));
-    normal = vec3(normal_matrix * vec4(aNormal, 1.0f));
+    Draw draw = draws[gl_BaseInstance + gl_InstanceID];
+    vec3 model_position = draw.quantization.xyz + aPos * draw.quantization.w;
+    position = vec3(draw.model_matrix * vec4(model_position, 1.0f));
+    normal = vec3(draw.normal_matrix * vec4(octahedral(aNormal), 1.0f));
     tex_coords = aTexCoords;
+    shininess = draw.shininess;
+    Material material = materials[draw.material];
+    layers = uvec2(material.diffuse_layer, material.specular_layer);
 
-    gl_Position =
-            projection_matrix * view_matrix * model_matrix * vec4(aPos, 1.0);
+    gl_Position = projection_matrix * view_matrix * vec4(position, 1.0f);
 }
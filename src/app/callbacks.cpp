@@ -2,6 +2,8 @@
 
 #include <glad/glad.h>
 
+#include <spdlog/spdlog.h>
+
 namespace app {
 
 void bindCallbacks() {
@@ -17,6 +19,8 @@ void switches_callback(GLFWwindow* window, int key, int scancode, int action,
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
+    std::lock_guard<std::mutex> lock{state->input_mutex};
+
     auto& camera_subsystem = state->camera_subsystem;
     auto& multiple_cameras = camera_subsystem.multiple_cameras;
     if (key == GLFW_KEY_5 && action == GLFW_PRESS)
@@ -45,6 +49,19 @@ void switches_callback(GLFWwindow* window, int key, int scancode, int action,
     if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
         state->enable_simulation = !state->enable_simulation;
     }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        state->gpu_culling = !state->gpu_culling;
+        spdlog::info("app: culling on the {}",
+                     state->gpu_culling ? "GPU" : "CPU");
+    }
+
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        state->multi_draw_indirect = !state->multi_draw_indirect;
+        spdlog::info("app: drawing with {}",
+                     state->multi_draw_indirect ? "multi draw indirect"
+                                                : "a draw per mesh");
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback
@@ -78,6 +95,7 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     mouse_subsystem.last_x = x_position;
     mouse_subsystem.last_y = y_position;
 
+    std::lock_guard<std::mutex> lock{state->input_mutex};
     auto& camera_subsystem = state->camera_subsystem;
     camera_subsystem.delta_yaw +=
             camera_subsystem.camera_sensitivity * (-mouse_subsystem.delta_x);
@@ -3,9 +3,12 @@
 namespace app {
 
 const char* TITLE = "Basketball";
+const char* SCENE = "scenes/court.json";
 const unsigned int WINDOW_WIDTH = 1366;
 const unsigned int WINDOW_HEIGHT = 768;
 const float CAMERA_SPEED = 1.0f; // meters per second
 const float CAMERA_SENSITIVITY = 0.003f;
+const std::size_t UPLOAD_RING_SIZE = 64U << 20U; // bytes
+const std::size_t TEXTURE_BUDGET = 256U << 20U;  // bytes
 
 } // namespace app
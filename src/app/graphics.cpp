@@ -47,6 +47,9 @@ void initGraphics() {
         glfwTerminate();
         throw std::runtime_error{"OpenGL initialization failed"};
     }
+    rg::ShaderCompiler::enableParallel(
+            reinterpret_cast<rg::ShaderCompiler::ProcLoader>(
+                    glfwGetProcAddress));
 
     // Configuration
     // -------------
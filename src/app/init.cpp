@@ -1,25 +1,56 @@
 #include <app/init.hpp>
 
-#include <fstream>
+#include <rg/util/FileLoader.hpp>
+
+#include <chrono>
 #include <spdlog/spdlog.h>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace app {
 
 State* state = nullptr;
 
-void init() {
+void init(const std::string& scene_path) {
+    auto start = std::chrono::steady_clock::now();
     state = new State();
     if (state == nullptr) {
         spdlog::error("ERROR::init: Failed to set up program state.");
         throw std::runtime_error{"Program initialization failed"};
     }
 
+    // Resources
+    // ---------
+    // Without a pack every loader opens its files on its own
+    try {
+        state->resource_pack = new rg::util::ResourcePack{
+                rg::util::ResourcePack::open(RESOURCE_PACK)};
+        rg::util::ResourcePack::mount(*state->resource_pack,
+                                      RESOURCE_DIRECTORY);
+        spdlog::info("app::init: {} resources {} from {}",
+                     state->resource_pack->file_count(),
+                     state->resource_pack->is_mapped() ? "mapped" : "read",
+                     RESOURCE_PACK);
+    } catch (const std::runtime_error& e) {
+        spdlog::warn("app::init: {}, reading the resource files instead",
+                     e.what());
+    }
+
+    state->jobs = new rg::JobSystem{};
+    spdlog::info("app::init: {} job workers", state->jobs->worker_count());
+
+    spdlog::info("app::init: loading scene {}", scene_path);
+    auto scene = rg::scene::SceneFile::open(scene_path);
+
     initGraphics();
     bindCallbacks();
-    initScene();
-    setScene();
+    initScene(scene);
+    setScene(scene);
+
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+    spdlog::info("app::init: ready in {:.1f} ms", elapsed.count());
 
     glfwSetTime(0.0);
 }
@@ -31,10 +62,20 @@ std::string util::resource(const std::string& path) {
 }
 
 std::string util::readFile(const std::string& path) {
-    std::fstream file{path};
-    std::stringstream medium{};
-    medium << file.rdbuf();
-    return medium.str();
+    return readFiles({path})[0];
+}
+
+std::vector<std::string>
+util::readFiles(const std::vector<std::string>& paths) {
+    auto contents = rg::util::FileLoader::shared().read_files(paths);
+    std::vector<std::string> files;
+    files.reserve(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (!contents[i])
+            spdlog::error("app::util::readFiles: cannot read {}", paths[i]);
+        files.push_back(std::move(contents[i]).value_or(""));
+    }
+    return files;
 }
 
 } // namespace app
@@ -4,50 +4,132 @@
 #include <glad/glad.h>
 
 #include <app/state.hpp>
+#include <app/systems.hpp>
 #include <rg/renderer/render.hpp>
 
 #include <spdlog/spdlog.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace app {
 
 namespace {
 
+// Frames are pipelined over two threads. The render thread owns the window
+// and the GL context: it polls input, and draws the latest snapshot. The
+// simulation thread owns the registry and the lights: it advances the scene
+// and publishes it as a snapshot. While frame N is drawn, N + 1 is simulated.
+
+// Render thread
+// -------------
+
 void iteration();
 
 // Used to process continuous input
 void processInput();
 void togglePressed(int key, bool& value);
 
-void draw();
-void drawScene(const Camera& camera, const rg::Surface& surface);
-void drawMultipleCameras();
-void drawSingleCamera();
+void acquireFrame();
+void draw(const FrameSnapshot& frame);
+void setLights(const FrameSnapshot& frame);
+std::uint32_t lightFeatures(const FrameSnapshot& frame);
+void recordViews(const FrameSnapshot& frame);
+void recordView(const FrameSnapshot& frame, unsigned int index);
+void drawScene(const rg::View& view, rg::Surface& surface,
+               const rg::CommandBuffer& commands);
+void drawMultipleCameras(const FrameSnapshot& frame);
+void drawSingleCamera(const FrameSnapshot& frame);
+void buildDepthPyramids(const FrameSnapshot& frame);
 void swapBuffers();
 
-void update();
+void pollEvents();
+
+// CPU time spent recording and submitting the draws, averaged over a number
+// of frames
+struct FrameTimer {
+    static constexpr unsigned int FRAMES = 300;
+
+    std::chrono::steady_clock::time_point start;
+    std::chrono::duration<double, std::milli> total{0.0};
+    std::size_t draws = 0;
+    // Bytes of model textures, summed over the frames
+    std::size_t resident = 0;
+    std::size_t requested = 0;
+    // GPU time of the post chains of the cameras shown, summed likewise
+    rg::PostTimings post;
+    unsigned int frames = 0;
+
+    void begin();
+    void end(const FrameSnapshot& frame);
+};
+
+FrameTimer frame_timer;
+
+// Simulation thread
+// -----------------
+
+// Input as of the start of a simulated frame
+struct Input {
+    CameraState::Behaviour behaviour;
+    float delta_yaw;
+    float delta_pitch;
+    unsigned int active_camera;
+    bool multiple_cameras;
+    bool enable_simulation;
+    bool gpu_culling;
+};
+
+void simulate();
+void step();
+Input takeInput();
 void updateTime();
-void updateCameras();
-void updateObjects();
+void updateCameras(const Input& input);
+void updateObjects(const Input& input);
+void publishFrame(const Input& input);
 
-void pollEvents();
+// Keeps the simulation at most one frame ahead of the render thread
+struct Pipeline {
+    std::mutex mutex;
+    std::condition_variable consumed_changed;
+    unsigned long produced = 0;
+    unsigned long consumed = 0;
+    bool stop = false;
+};
+
+Pipeline pipeline;
 
 } // namespace
 
 void loop() {
+    // Simulate the first frame up front so there is always one to draw
+    step();
+    std::thread simulation{simulate};
+
     while (!glfwWindowShouldClose(app::state->window))
         iteration();
+
+    {
+        std::lock_guard<std::mutex> lock{pipeline.mutex};
+        pipeline.stop = true;
+    }
+    pipeline.consumed_changed.notify_all();
+    simulation.join();
 }
 
 namespace {
 
 void iteration() {
     processInput();
-    update();
-    draw();
+    acquireFrame();
+    draw(state->frames.read_buffer());
     pollEvents();
 }
 
 void processInput() {
+    std::lock_guard<std::mutex> lock{state->input_mutex};
     auto& camera_behaviour = state->camera_subsystem.behaviour;
     togglePressed(GLFW_KEY_W, camera_behaviour.move_forward);
     togglePressed(GLFW_KEY_A, camera_behaviour.move_left);
@@ -62,113 +144,154 @@ void togglePressed(int key, bool& value) {
         value = false;
 }
 
-void draw() {
+void acquireFrame() {
+    // Without a new frame the previous one is drawn again
+    if (!state->frames.acquire())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock{pipeline.mutex};
+        pipeline.consumed = state->frames.read_buffer().frame;
+    }
+    pipeline.consumed_changed.notify_one();
+}
+
+void draw(const FrameSnapshot& frame) {
     glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    const auto& shader = *state->shader;
-    const auto& directional_lights = *state->light_subsystem.directional;
-    const auto& point_lights = *state->light_subsystem.point;
-    const auto& spotlights = *state->light_subsystem.spotlight;
+    state->shader_reloader->update();
+    state->asset_reloader->update();
+    state->materials->update();
 
-    // Lights
-    // ------
-    // Light initialization is placed here in order to speed up execution.
-    shader.bind();
-    shader.set_int("active_directional_lights",
-                   static_cast<int>(directional_lights.size()));
-    shader.set_int("active_point_lights",
-                   static_cast<int>(point_lights.size()));
-    shader.set_int("active_spotlights", static_cast<int>(spotlights.size()));
-    for (unsigned int i = 0; i < directional_lights.size(); ++i)
-        shader.set("directional_lights[" + std::to_string(i) + "]",
-                   directional_lights[i]);
-    for (unsigned int i = 0; i < point_lights.size(); ++i)
-        shader.set("point_lights[" + std::to_string(i) + "]", point_lights[i]);
-    for (unsigned int i = 0; i < spotlights.size(); ++i)
-        shader.set("spotlights[" + std::to_string(i) + "]", spotlights[i]);
-    shader.unbind();
-
-    bool multiple_cameras = state->camera_subsystem.multiple_cameras;
-    if (multiple_cameras)
-        drawMultipleCameras();
+    frame_timer.begin();
+    state->materials->bind();
+    setLights(frame);
+    recordViews(frame);
+
+    if (frame.multiple_cameras)
+        drawMultipleCameras(frame);
     else
-        drawSingleCamera();
+        drawSingleCamera(frame);
+    buildDepthPyramids(frame);
+    frame_timer.end(frame);
 
     swapBuffers();
 }
 
-void update() {
-    updateTime();
-    updateCameras();
-    updateObjects();
+void setLights(const FrameSnapshot& frame) {
+    const auto& directional_lights = frame.directional_lights;
+    const auto& point_lights = frame.point_lights;
+    const auto& spotlights = frame.spotlights;
+
+    // Light initialization is placed here in order to speed up execution.
+    // Each variant only has the uniforms of the lights it was compiled for.
+    state->shaders->for_each([&](std::uint32_t features,
+                                 const rg::Shader& shader) {
+        if ((features & rg::UNLIT) != 0)
+            return;
+
+        shader.bind();
+        shader.set_int("active_directional_lights",
+                       static_cast<int>(directional_lights.size()));
+        for (unsigned int i = 0; i < directional_lights.size(); ++i)
+            shader.set("directional_lights[" + std::to_string(i) + "]",
+                       directional_lights[i]);
+        if ((features & rg::POINT_LIGHTS) != 0) {
+            shader.set_int("active_point_lights",
+                           static_cast<int>(point_lights.size()));
+            for (unsigned int i = 0; i < point_lights.size(); ++i)
+                shader.set("point_lights[" + std::to_string(i) + "]",
+                           point_lights[i]);
+        }
+        if ((features & rg::SPOTLIGHTS) != 0) {
+            shader.set_int("active_spotlights",
+                           static_cast<int>(spotlights.size()));
+            for (unsigned int i = 0; i < spotlights.size(); ++i)
+                shader.set("spotlights[" + std::to_string(i) + "]",
+                           spotlights[i]);
+        }
+        shader.unbind();
+    });
 }
 
-void drawScene(const Camera& camera, const rg::Surface& surface) {
-    const auto& shader = state->shader;
-    const auto& skybox_shader = state->skybox_shader;
-    const auto& light_shader = state->light_shader;
+// Lights of a kind which is absent are left out of the variants
+std::uint32_t lightFeatures(const FrameSnapshot& frame) {
+    std::uint32_t features = 0;
+    if (!frame.point_lights.empty())
+        features |= rg::POINT_LIGHTS;
+    if (!frame.spotlights.empty())
+        features |= rg::SPOTLIGHTS;
+    return features;
+}
+
+void recordViews(const FrameSnapshot& frame) {
+    if (!frame.multiple_cameras) {
+        recordView(frame, frame.active_camera);
+        return;
+    }
 
-    state->lamp->placeLight();
+    auto& jobs = *state->jobs;
+    rg::JobCounter counter;
+    for (unsigned int i = 0; i < 4; ++i)
+        jobs.run([&frame, i] { recordView(frame, i); }, counter);
+    jobs.wait(counter);
+}
 
-    const auto& view = camera.get_view();
-    shader->set(view);
-    shader->set("camera.position", view.position);
-    shader->set("camera.direction", view.direction);
+// Record the draws of the camera into its command buffer. Does not touch the
+// GL context.
+void recordView(const FrameSnapshot& frame, unsigned int index) {
+    auto& commands = state->command_buffers[index];
+    commands.clear();
+    const auto& shaders = *state->shaders;
+    std::uint32_t lights = lightFeatures(frame);
+    const auto& view = frame.views[index];
+    unsigned int height = state->camera_subsystem.surfaces[index]->get_height();
+    auto& lods = state->lod_selectors[index];
+    lods.begin(view, height);
+    if (frame.gpu_culling)
+        rg::recordCulled(shaders, lights, *state->light_shader,
+                         *state->cull_shader,
+                         *state->camera_subsystem.depth_pyramids[index], view,
+                         lods, frame.draw_lists[0], commands);
+    else if (state->multi_draw_indirect)
+        rg::recordIndirect(shaders, lights, *state->light_shader, view, lods,
+                           frame.draw_lists[index], commands);
+    else
+        rg::record(shaders, lights, *state->light_shader, view, lods,
+                   frame.draw_lists[index], commands);
+
+    // With culling on the GPU the list has every item, visible or not
+    const auto& list = frame.draw_lists[frame.gpu_culling ? 0 : index];
+    rg::requestMips(*state->materials, view, height, list);
+}
+
+void drawScene(const rg::View& view, rg::Surface& surface,
+               const rg::CommandBuffer& commands) {
+    const auto& skybox_shader = state->skybox_shader;
 
     glm::mat4 view_matrix = glm::mat4{glm::mat3{view.get_view_matrix()}};
     skybox_shader->set("view_matrix", view_matrix);
     skybox_shader->set("projection_matrix", view.get_projection_matrix());
 
-    light_shader->set(view);
-
     surface.bind();
     rg::clear(surface);
 
-    // Ball
-    // ----
-    const auto& ball = state->ball;
-    rg::render(*shader, *ball->model, ball->transform, 32.0f);
-
-    // Floor
-    // -----
-    const auto& floor = state->floor;
-    rg::Transform tile_transform = floor->transform;
-    glm::vec3 forward = tile_transform.get_forward_vector();
-    glm::vec3 right = tile_transform.get_right_vector();
-    glm::vec3 root = tile_transform.position;
-    for (int i = -floor->width; i <= floor->width; ++i) {
-        glm::vec3 dr = static_cast<float>(i) * right;
-        for (int j = -floor->height; j <= floor->height; ++j) {
-            glm::vec3 df = static_cast<float>(j) * forward;
-            tile_transform.position = root + df + dr;
-
-            rg::render(*shader, *state->floor->tile, tile_transform, 12.0f);
-        }
-    }
-
-    // Lamp
-    // ----
-    const auto& lamp = state->lamp;
-    rg::render(*shader, *lamp->base, lamp->transform, 64.0f);
-    rg::render(*shader, *lamp->frame, lamp->transform, 64.0f);
-    light_shader->bind();
-    light_shader->set("light_color", lamp->get_color());
-    rg::render(*light_shader, *lamp->source, lamp->transform);
+    state->submitter->submit(commands);
 
 #ifdef ENABLE_DEBUG
     for (auto light : *state->light_subsystem.point) {
         rg::Transform transform;
         transform.position = light.position;
-        rg::render(*state->debug_shader, *state->debug_cube, camera.get_view(),
-                   surface, transform);
+        rg::render(*state->debug_shader, *state->debug_cube, view, surface,
+                   transform);
     }
     for (auto light : *state->light_subsystem.spotlight) {
         rg::Transform transform;
         transform.position = light.position;
         transform.orientation = glm::quat(glm::vec3{0.7f, 0.7f, 0.7f});
-        rg::render(*state->debug_shader, *state->debug_cube, camera.get_view(),
-                   surface, transform);
+        rg::render(*state->debug_shader, *state->debug_cube, view, surface,
+                   transform);
     }
 #endif // ENABLE_DEBUG
 
@@ -177,19 +300,20 @@ void drawScene(const Camera& camera, const rg::Surface& surface) {
     const auto& skybox = state->skybox;
     rg::render(*skybox_shader, *skybox);
 
-    surface.unbind();
+    // Post-processing
+    // ---------------
+    surface.resolve(*state->bloom_shader, *state->post_shader);
 }
 
-void drawMultipleCameras() {
+void drawMultipleCameras(const FrameSnapshot& frame) {
     const auto& surface_shader = state->surface_shader;
-    const auto& cameras = state->camera_subsystem.cameras;
     const auto& surfaces = state->camera_subsystem.surfaces;
 
     // Draw objects as seen from each camera to the camera's own surface
     // -----------------------------------------------------------------
     glEnable(GL_DEPTH_TEST);
     for (unsigned int i = 0; i < 4; ++i)
-        drawScene(*cameras[i], *surfaces[i]);
+        drawScene(frame.views[i], *surfaces[i], state->command_buffers[i]);
 
     // Draw surfaces to the screen
     // ---------------------------
@@ -200,78 +324,211 @@ void drawMultipleCameras() {
     }
 }
 
-void drawSingleCamera() {
+void drawSingleCamera(const FrameSnapshot& frame) {
     const auto& surface_shader = state->surface_shader;
 
-    const auto& active_camera = state->camera_subsystem.active_camera;
-    const auto& camera = state->camera_subsystem.cameras[active_camera];
+    const auto& active_camera = frame.active_camera;
     const auto& surface = state->camera_subsystem.surfaces[active_camera];
 
     glEnable(GL_DEPTH_TEST);
-    drawScene(*camera, *surface);
+    drawScene(frame.views[active_camera], *surface,
+              state->command_buffers[active_camera]);
 
     glDisable(GL_DEPTH_TEST);
     rg::clear();
     rg::render(*surface_shader, *surface);
 }
 
-void updateCameras() {
-    const auto& active_camera = state->camera_subsystem.active_camera;
-    const auto& camera = state->camera_subsystem.cameras[active_camera];
+// The pyramids are read by the culling pass of the next frame. Those of the
+// cameras not shown would be out of date by then.
+void buildDepthPyramids(const FrameSnapshot& frame) {
+    const auto& surfaces = state->camera_subsystem.surfaces;
+    const auto& depth_pyramids = state->camera_subsystem.depth_pyramids;
+    for (unsigned int i = 0; i < 4; ++i) {
+        bool shown = frame.multiple_cameras || i == frame.active_camera;
+        if (frame.gpu_culling && shown)
+            depth_pyramids[i]->build(*state->depth_pyramid_shader,
+                                     surfaces[i]->get_depth_texture());
+        else
+            depth_pyramids[i]->invalidate();
+    }
+}
+
+void pollEvents() {
+    glfwPollEvents();
+}
 
-    auto front = camera->get_direction();
-    auto right = camera->get_right();
-    auto delta_time = state->time_subsystem.delta;
-    auto speed = state->camera_subsystem.camera_speed * delta_time;
+void swapBuffers() {
+    glfwSwapBuffers(app::state->window);
+}
+
+void FrameTimer::begin() {
+    start = std::chrono::steady_clock::now();
+}
 
-    if (state->camera_subsystem.behaviour.move_forward)
-        camera->move(speed * front);
-    if (state->camera_subsystem.behaviour.move_backward)
-        camera->move(-speed * front);
-    if (state->camera_subsystem.behaviour.move_right)
-        camera->move(speed * right);
-    if (state->camera_subsystem.behaviour.move_left)
-        camera->move(-speed * right);
-
-    auto& delta_yaw = state->camera_subsystem.delta_yaw;
-    auto& delta_pitch = state->camera_subsystem.delta_pitch;
-    camera->rotate(delta_yaw, delta_pitch);
-    delta_yaw = 0.0f;
-    delta_pitch = 0.0f;
+void FrameTimer::end(const FrameSnapshot& frame) {
+    total += std::chrono::steady_clock::now() - start;
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (!frame.multiple_cameras && i != frame.active_camera)
+            continue;
+        const auto& list = frame.draw_lists[frame.gpu_culling ? 0 : i];
+        draws += list.lit.size() + list.emissive.size();
+        const auto& timings =
+                state->camera_subsystem.surfaces[i]->get_post_chain()
+                        .get_timings();
+        post.bloom_down += timings.bloom_down;
+        post.bloom_up += timings.bloom_up;
+        post.composite += timings.composite;
+    }
+    const auto& residency = state->materials->get_residency();
+    resident += residency.resident;
+    requested += residency.requested;
+    if (++frames < FRAMES)
+        return;
+
+    const char* path = "a draw per mesh";
+    if (frame.gpu_culling)
+        path = "culling on the GPU";
+    else if (state->multi_draw_indirect)
+        path = "multi draw indirect";
+    spdlog::info("app: {:.3f} ms/frame of CPU time, {} objects/frame, {}",
+                 total.count() / frames, draws / frames, path);
+    constexpr double MIB = 1024.0 * 1024.0;
+    spdlog::info("app: {:.1f} MiB/frame of textures resident, {:.1f} MiB "
+                 "requested, {:.1f} MiB budget",
+                 static_cast<double>(resident) / frames / MIB,
+                 static_cast<double>(requested) / frames / MIB,
+                 static_cast<double>(residency.budget) / MIB);
+    spdlog::info("app: {:.3f} ms/frame of post-processing on the GPU: "
+                 "{:.3f} ms bloom down, {:.3f} ms bloom up, {:.3f} ms "
+                 "composite",
+                 (post.bloom_down + post.bloom_up + post.composite) / frames,
+                 post.bloom_down / frames, post.bloom_up / frames,
+                 post.composite / frames);
+    total = std::chrono::duration<double, std::milli>{0.0};
+    draws = 0;
+    resident = 0;
+    requested = 0;
+    post = rg::PostTimings{};
+    frames = 0;
 }
 
-void updateObjects() {
-    auto& spotlight = state->light_subsystem.spotlight->front();
-    const auto& active_camera = state->camera_subsystem.active_camera;
-    const auto& camera = *state->camera_subsystem.cameras[active_camera];
-    spotlight.position = camera.get_position();
-    spotlight.direction = camera.get_direction();
-
-    static constexpr glm::vec3 g = glm::vec3{0.0f, -9.81f, 0.0f};
-    float delta = state->time_subsystem.delta;
-    if (state->enable_simulation) {
-        auto& ball = state->ball;
-        const auto& radius = ball->radius;
-        ball->velocity += delta * g;
-        ball->transform.position += delta * ball->velocity;
-        if (ball->transform.position.y <= radius) {
-            ball->velocity = -ball->velocity;
-            ball->transform.position.y =
-                    radius + (radius - ball->transform.position.y);
+void simulate() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{pipeline.mutex};
+            pipeline.consumed_changed.wait(lock, [] {
+                return pipeline.stop ||
+                       pipeline.consumed == pipeline.produced;
+            });
+            if (pipeline.stop)
+                return;
         }
+        step();
     }
 }
 
-void pollEvents() {
-    glfwPollEvents();
+void step() {
+    Input input = takeInput();
+    updateTime();
+    updateCameras(input);
+    updateObjects(input);
+    publishFrame(input);
+}
+
+Input takeInput() {
+    std::lock_guard<std::mutex> lock{state->input_mutex};
+    auto& camera_subsystem = state->camera_subsystem;
+    Input input{camera_subsystem.behaviour,
+                camera_subsystem.delta_yaw,
+                camera_subsystem.delta_pitch,
+                camera_subsystem.active_camera,
+                camera_subsystem.multiple_cameras,
+                state->enable_simulation,
+                state->gpu_culling};
+    camera_subsystem.delta_yaw = 0.0f;
+    camera_subsystem.delta_pitch = 0.0f;
+    return input;
 }
 
 void updateTime() {
     state->time_subsystem.update();
 }
 
-void swapBuffers() {
-    glfwSwapBuffers(app::state->window);
+void updateCameras(const Input& input) {
+    auto& camera = state->get_camera(input.active_camera);
+
+    auto front = camera.get_direction();
+    auto right = camera.get_right();
+    auto delta_time = state->time_subsystem.delta;
+    auto speed = state->camera_subsystem.camera_speed * delta_time;
+
+    if (input.behaviour.move_forward)
+        camera.move(speed * front);
+    if (input.behaviour.move_backward)
+        camera.move(-speed * front);
+    if (input.behaviour.move_right)
+        camera.move(speed * right);
+    if (input.behaviour.move_left)
+        camera.move(-speed * right);
+
+    camera.rotate(input.delta_yaw, input.delta_pitch);
+}
+
+void updateObjects(const Input& input) {
+    auto& spotlights = *state->light_subsystem.spotlight;
+    int camera_spotlight = state->light_subsystem.camera_spotlight;
+    if (camera_spotlight >= 0) {
+        const auto& camera = state->get_camera(input.active_camera);
+        spotlights[camera_spotlight].position = camera.get_position();
+        spotlights[camera_spotlight].direction = camera.get_direction();
+    }
+
+    auto& registry = state->registry;
+    auto& jobs = *state->jobs;
+    if (input.enable_simulation)
+        physicsSystem(registry, jobs, state->time_subsystem.delta);
+    lightSystem(registry, spotlights);
+    transformSystem(registry, jobs);
+}
+
+void publishFrame(const Input& input) {
+    auto& frame = state->frames.write_buffer();
+    const auto& lights = state->light_subsystem;
+
+    frame.active_camera = input.active_camera;
+    frame.multiple_cameras = input.multiple_cameras;
+    frame.gpu_culling = input.gpu_culling;
+    for (unsigned int i = 0; i < 4; ++i)
+        frame.views[i] = state->get_camera(i).get_view();
+    frame.directional_lights = *lights.directional;
+    frame.point_lights = *lights.point;
+    frame.spotlights = *lights.spotlight;
+
+    // Cull for the cameras on screen, one job per camera, unless the GPU does
+    auto& registry = state->registry;
+    auto& jobs = *state->jobs;
+    if (frame.gpu_culling)
+        collectSystem(registry, jobs, frame.draw_lists[0]);
+    rg::JobCounter counter;
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (frame.gpu_culling ||
+            (!frame.multiple_cameras && i != frame.active_camera))
+            continue;
+        jobs.run(
+                [&registry, &jobs, &frame, i] {
+                    cullSystem(registry, frame.views[i], jobs,
+                               frame.draw_lists[i]);
+                },
+                counter);
+    }
+    jobs.wait(counter);
+
+    {
+        std::lock_guard<std::mutex> lock{pipeline.mutex};
+        frame.frame = ++pipeline.produced;
+    }
+    state->frames.publish();
 }
 
 } // namespace
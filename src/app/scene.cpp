@@ -3,41 +3,115 @@
 #include <app/objects/Camera.hpp>
 #include <rg/renderer/camera/Surface.hpp>
 #include <rg/renderer/model/Skybox.hpp>
+#include <rg/renderer/model/Vertex.hpp>
 #include <rg/renderer/shader/Shader.hpp>
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+#include <rg/renderer/shader/ShaderVariants.hpp>
+#include <rg/renderer/shader/UniformBlocks.hpp>
 #include <rg/util/common_meshes.hpp>
 
+#include <spdlog/spdlog.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace app {
 
-void initScene() {
+namespace {
+
+glm::vec3 vec3(const float* v) {
+    return glm::vec3{v[0], v[1], v[2]};
+}
+
+rg::Transform transform(const rg::scene::TransformRecord& record) {
+    rg::Transform transform;
+    transform.position = vec3(record.position);
+    const auto* q = record.orientation;
+    transform.orientation = glm::quat{q[0], q[1], q[2], q[3]};
+    transform.scale = vec3(record.scale);
+    return transform;
+}
+
+rg::LightColor color(const rg::scene::ColorRecord& record) {
+    rg::LightColor color;
+    color.ambient = vec3(record.ambient);
+    color.diffuse = vec3(record.diffuse);
+    color.specular = vec3(record.specular);
+    return color;
+}
+
+rg::LightAttenuation attenuation(const rg::scene::AttenuationRecord& record) {
+    rg::LightAttenuation attenuation;
+    attenuation.constant = record.constant;
+    attenuation.linear = record.linear;
+    attenuation.quadratic = record.quadratic;
+    return attenuation;
+}
+
+} // namespace
+
+void initScene(const rg::scene::SceneFile& scene) {
     // Load components
     // ---------------
     initObjects();
-    initCameras();
-    initShaders();
+    initCameras(scene);
+
+    // The driver compiles the programs while the assets load. The variants
+    // are submitted once the models tell which materials there are.
+    rg::ShaderCompiler compiler;
+    initShaders(compiler);
+    initModels(scene);
+    state->shaders->precompile(state->materials->get_feature_sets(),
+                               compiler);
     initSkybox();
-    initModels();
+    finishShaders(compiler);
+
+    // Cold on the first run and after shader or driver changes, warm
+    // otherwise
+    state->program_cache->report();
 }
 
 void initObjects() {
-    state->ball = new Ball;
-    state->lamp = new Lamp;
-    state->floor = new Floor;
+    // Light storage
+    // -------------
+    auto& lights = state->light_subsystem;
+    lights.directional = new std::vector<rg::DirectionalLight>();
+    lights.point = new std::vector<rg::PointLight>();
+    lights.spotlight = new std::vector<rg::SpotLight>();
+
+    // Command submission
+    // ------------------
+    state->submitter = new rg::CommandSubmitter{};
 }
 
-void initCameras() {
+void initCameras(const rg::scene::SceneFile& scene) {
     // Cameras
     // -------
+    auto& registry = state->registry;
     auto& cameras = state->camera_subsystem.cameras;
     auto width = static_cast<float>(state->window_width);
     auto height = static_cast<float>(state->window_height);
 
-    for (auto& camera : cameras) {
-        camera = new Camera{glm::vec3{0.0f, 0.0f, 0.0f},
-                            glm::vec3{0.0f, 0.0f, -1.0f},
-                            60.0f,
-                            width / height,
-                            0.01f,
-                            50.0f};
+    auto records = scene.cameras();
+    if (records.size() != cameras.size()) {
+        spdlog::warn("app::init::cameras: the scene has {} cameras, {} are "
+                     "used",
+                     records.size(), cameras.size());
+    }
+
+    for (unsigned int i = 0; i < cameras.size(); ++i) {
+        float fov = 60.0f, z_near = 0.01f, z_far = 50.0f;
+        if (i < records.size()) {
+            fov = records[i].fov;
+            z_near = records[i].z_near;
+            z_far = records[i].z_far;
+        }
+
+        cameras[i] = registry.create();
+        registry.emplace<Camera>(cameras[i], glm::vec3{0.0f, 0.0f, 0.0f},
+                                 glm::vec3{0.0f, 0.0f, -1.0f}, fov,
+                                 width / height, z_near, z_far);
     }
 
     // Surfaces
@@ -47,39 +121,120 @@ void initCameras() {
     for (unsigned int i = 0; i < 4; ++i)
         surfaces[i] = new rg::Surface{state->window_width, state->window_height,
                                       surface_quad};
+
+    // Depth pyramids
+    // --------------
+    auto& depth_pyramids = state->camera_subsystem.depth_pyramids;
+    for (unsigned int i = 0; i < 4; ++i)
+        depth_pyramids[i] = new rg::DepthPyramid{surfaces[i]->get_width(),
+                                                 surfaces[i]->get_height()};
 }
 
-void initShaders() {
+// Only submits the programs, the uniforms are set by finishShaders
+void initShaders(rg::ShaderCompiler& compiler) {
+    state->program_cache = new rg::ProgramCache{SHADER_CACHE_DIRECTORY};
+    rg::ShaderCompiler::use_cache(state->program_cache);
+
+    // Sources
+    // -------
+    // Read in one batch rather than one file at a time
+    std::vector<std::string> files{
+            "shader.vs.glsl", "shader.fs.glsl",
+            "surface.vs.glsl", "surface.fs.glsl",
+            "skybox.vs.glsl", "skybox.fs.glsl",
+            "light.vs.glsl", "light.fs.glsl",
+            "cull.cs.glsl", "depth_pyramid.cs.glsl",
+            "bloom.cs.glsl", "post.cs.glsl"};
+#ifdef ENABLE_DEBUG
+    files.emplace_back("debug.vs.glsl");
+    files.emplace_back("debug.fs.glsl");
+#endif // ENABLE_DEBUG
+    std::vector<std::string> paths;
+    for (const auto& file : files)
+        paths.push_back(util::resource("shaders/" + file));
+    auto read = util::readFiles(paths);
+    std::unordered_map<std::string, std::string> sources;
+    for (std::size_t i = 0; i < files.size(); ++i)
+        sources.emplace(files[i], std::move(read[i]));
+
     // Default shader
     // --------------
-    state->shader = new rg::Shader{rg::Shader::compile(
-            util::readFile(util::resource("shaders/shader.vs.glsl")),
-            util::readFile(util::resource("shaders/shader.fs.glsl")))};
+    // The variants used by the materials are submitted once the models are
+    // loaded
+    state->shaders = new rg::ShaderVariants{
+            sources["shader.vs.glsl"], sources["shader.fs.glsl"],
+            [](std::uint32_t features, const rg::Shader& shader) {
+                // Samplers keep their units for the whole run, so command
+                // buffers only need to bind textures
+                shader.set_int("diffuse_textures", rg::DIFFUSE_TEXTURE_UNIT);
+                if ((features & rg::SPECULAR_MAP) != 0)
+                    shader.set_int("specular_textures",
+                                   rg::SPECULAR_TEXTURE_UNIT);
+            }};
 
     // Surface shader
     // --------------
-    state->surface_shader = new rg::Shader{rg::Shader::compile(
-            util::readFile(util::resource("shaders/surface.vs.glsl")),
-            util::readFile(util::resource("shaders/surface.fs.glsl")))};
+    state->surface_shader = new rg::Shader{compiler.submit(
+            sources["surface.vs.glsl"], sources["surface.fs.glsl"])};
 
     // Skybox shader
     // -------------
-    state->skybox_shader = new rg::Shader{rg::Shader::compile(
-            util::readFile(util::resource("shaders/skybox.vs.glsl")),
-            util::readFile(util::resource("shaders/skybox.fs.glsl")))};
+    state->skybox_shader = new rg::Shader{compiler.submit(
+            sources["skybox.vs.glsl"], sources["skybox.fs.glsl"])};
 
     // Light shader
     // ------------
-    state->light_shader = new rg::Shader{rg::Shader::compile(
-            util::readFile(util::resource("shaders/light.vs.glsl")),
-            util::readFile(util::resource("shaders/light.fs.glsl")))};
+    state->light_shader = new rg::Shader{compiler.submit(
+            sources["light.vs.glsl"], sources["light.fs.glsl"])};
+
+    // Culling shaders
+    // ---------------
+    state->cull_shader =
+            new rg::Shader{compiler.submit(sources["cull.cs.glsl"])};
+    state->depth_pyramid_shader =
+            new rg::Shader{compiler.submit(sources["depth_pyramid.cs.glsl"])};
+
+    // Post-processing shaders
+    // -----------------------
+    state->bloom_shader =
+            new rg::Shader{compiler.submit(sources["bloom.cs.glsl"])};
+    state->post_shader =
+            new rg::Shader{compiler.submit(sources["post.cs.glsl"])};
 
 #ifdef ENABLE_DEBUG
     // Debug shader
     // ------------
-    state->debug_shader = new rg::Shader{rg::Shader::compile(
-            util::readFile(util::resource("shaders/debug.vs.glsl")),
-            util::readFile(util::resource("shaders/debug.fs.glsl")))};
+    state->debug_shader = new rg::Shader{compiler.submit(
+            sources["debug.vs.glsl"], sources["debug.fs.glsl"])};
+#endif // ENABLE_DEBUG
+}
+
+void finishShaders(rg::ShaderCompiler& compiler) {
+    compiler.finish();
+    state->shaders->initialize();
+
+    // Hot reload
+    // ----------
+    state->shader_reloader =
+            new rg::ShaderReloader{util::resource("shaders")};
+    auto& reloader = *state->shader_reloader;
+    reloader.watch(*state->shaders, "shader.vs.glsl", "shader.fs.glsl");
+    reloader.watch(*state->surface_shader, "surface.vs.glsl",
+                   "surface.fs.glsl");
+    reloader.watch(*state->skybox_shader, "skybox.vs.glsl", "skybox.fs.glsl");
+    reloader.watch(*state->light_shader, "light.vs.glsl", "light.fs.glsl");
+    reloader.watch(*state->cull_shader, "cull.cs.glsl");
+    reloader.watch(*state->depth_pyramid_shader, "depth_pyramid.cs.glsl");
+    reloader.watch(*state->bloom_shader, "bloom.cs.glsl");
+    reloader.watch(*state->post_shader, "post.cs.glsl");
+
+#ifdef ENABLE_DEBUG
+    auto init_debug = [](const rg::Shader& shader) {
+        shader.set_int("diffuse_textures", rg::DIFFUSE_TEXTURE_UNIT);
+    };
+    init_debug(*state->debug_shader);
+    reloader.watch(*state->debug_shader, "debug.vs.glsl", "debug.fs.glsl",
+                   init_debug);
 #endif // ENABLE_DEBUG
 }
 
@@ -87,113 +242,146 @@ void initSkybox() {
     std::string path = util::resource("skyboxes/night-real/");
     std::vector<std::string> faces{"xpos.png", "xneg.png", "ypos.png",
                                    "yneg.png", "zpos.png", "zneg.png"};
-    state->skybox = new rg::Skybox{path, faces};
+    state->skybox = new rg::Skybox{path, faces, state->jobs};
 }
 
-void initModels() {
-    std::string backpack_path = util::resource("objects/ball/ball.obj");
-    state->ball->model = std::make_shared<rg::Model>(backpack_path);
-
-    std::string court_tile_path = util::resource("objects/court-tile/tile.obj");
-    state->floor->tile = std::make_shared<rg::Model>(court_tile_path);
+void initModels(const rg::scene::SceneFile& scene) {
+    // Sized for the models we ship, it grows for anything larger
+    state->geometry = new rg::GeometryArena{
+            rg::util::layout<rg::PackedVertex>(), 1U << 16U, 1U << 18U};
+    auto& geometry = *state->geometry;
+    state->upload_ring = new rg::UploadRing{UPLOAD_RING_SIZE};
+    state->materials =
+            new rg::MaterialLibrary{state->upload_ring, state->jobs};
+    auto& materials = *state->materials;
+    materials.set_budget(TEXTURE_BUDGET);
+    state->model_cache = new rg::ModelCache{MODEL_CACHE_DIRECTORY};
+    rg::Model::use_cache(state->model_cache);
 
-    std::string lamp_base_path = util::resource("objects/lamp/base.obj");
-    std::string lamp_frame_path = util::resource("objects/lamp/head.obj");
-    std::string lamp_light_path = util::resource("objects/lamp/light.obj");
-    state->lamp->base = std::make_shared<rg::Model>(lamp_base_path);
-    state->lamp->frame = std::make_shared<rg::Model>(lamp_frame_path);
-    state->lamp->source = std::make_shared<rg::Model>(lamp_light_path);
+    for (const auto& record : scene.models()) {
+        std::string name{scene.string(record.name)};
+        std::string path{scene.string(record.path)};
+        state->models[name] = std::make_shared<rg::Model>(
+                util::resource(path), geometry, materials);
+    }
 
 #ifdef ENABLE_DEBUG
     std::string cube_path = util::resource("objects/cube/cube.obj");
-    state->debug_cube = new rg::Model{cube_path};
+    state->debug_cube = new rg::Model{cube_path, geometry, materials};
 #endif // ENABLE_DEBUG
-}
 
-void setScene() {
-    placeObjects();
-    placeCameras();
-    placeLights();
+    materials.update();
+
+    // Hot reload
+    // ----------
+    state->asset_reloader = new rg::AssetReloader{
+            util::resource("objects"), geometry, materials, state->jobs};
+    for (auto& [name, model] : state->models)
+        state->asset_reloader->watch(*model);
+#ifdef ENABLE_DEBUG
+    state->asset_reloader->watch(*state->debug_cube);
+#endif // ENABLE_DEBUG
 }
 
-void placeObjects() {
-    state->ball->transform.position = glm::vec3{0.0f, 1.0f, 0.0f};
-    state->ball->transform.orientation = glm::quat{glm::vec3{0.0f}};
-    state->ball->transform.scale = glm::vec3{1.0f};
-
-    state->floor->transform.position = glm::vec3{0.0f};
-    state->floor->transform.orientation = glm::quat{glm::vec3{0.0f}};
-    state->floor->transform.scale = glm::vec3{1.0f};
-    state->floor->width = 10;
-    state->floor->height = 10;
-
-    state->lamp->transform.position = glm::vec3{-5.0f, 0.0f, -5.0f};
-    state->lamp->transform.orientation =
-            glm::quat{glm::vec3{0.0f, glm::radians(-45.0f), 0.0f}};
-    state->lamp->transform.scale = glm::vec3{1.0f};
+void setScene(const rg::scene::SceneFile& scene) {
+    // Lights attached to objects refer to the spotlight records by index, so
+    // the lights are placed first
+    placeLights(scene);
+    placeObjects(scene);
+    placeCameras(scene);
 }
 
-void placeCameras() {
-    auto& cameras = state->camera_subsystem.cameras;
-    cameras[0]->set_position(glm::vec3{-2.5f, 2.5f, -2.5f});
-    cameras[0]->set_direction(glm::vec3{2.5f, -1.5f, 2.5f});
+void placeObjects(const rg::scene::SceneFile& scene) {
+    auto& registry = state->registry;
+
+    std::vector<std::shared_ptr<rg::Model>> models;
+    for (const auto& record : scene.models())
+        models.push_back(state->models.at(std::string{scene.string(record.name)}));
+
+    // Objects
+    // -------
+    for (const auto& record : scene.objects()) {
+        auto entity = registry.create();
+        registry.emplace<rg::Transform>(entity, transform(record.transform));
+        registry.emplace<Renderable>(entity, models[record.model],
+                                     record.shininess);
+        registry.emplace<WorldTransform>(entity);
 
-    cameras[1]->set_position(glm::vec3{-0.5f, 1.5f, 0.5f});
-    cameras[1]->set_direction(glm::vec3{0.5f, -0.7f, -0.5f});
+        if (record.flags & rg::scene::OBJECT_RIGID_BODY)
+            registry.emplace<RigidBody>(entity, vec3(record.velocity),
+                                        record.radius);
+        if (record.flags & rg::scene::OBJECT_EMISSIVE)
+            registry.emplace<Emissive>(entity);
+        if (record.flags & rg::scene::OBJECT_LIGHT)
+            registry.emplace<Light>(entity, record.spotlight,
+                                    vec3(record.light_offset),
+                                    vec3(record.light_direction));
+    }
 
-    cameras[2]->set_position(glm::vec3{0.5f, 1.5f, -0.5f});
-    cameras[2]->set_direction(glm::vec3{-0.5f, -0.7f, 0.5f});
+    // Floors
+    // ------
+    for (const auto& record : scene.floors()) {
+        rg::Transform floor_transform = transform(record.transform);
+        glm::vec3 forward = floor_transform.get_forward_vector();
+        glm::vec3 right = floor_transform.get_right_vector();
+        for (int i = -record.width; i <= record.width; ++i) {
+            glm::vec3 dr = static_cast<float>(i) * right;
+            for (int j = -record.height; j <= record.height; ++j) {
+                glm::vec3 df = static_cast<float>(j) * forward;
 
-    cameras[3]->set_position(glm::vec3{0.5f, 1.5f, 0.5f});
-    cameras[3]->set_direction(glm::vec3{-0.5f, -0.7f, -0.5f});
+                auto tile = registry.create();
+                auto& tile_transform =
+                        registry.emplace<rg::Transform>(tile, floor_transform);
+                tile_transform.position += df + dr;
+                registry.emplace<Renderable>(tile, models[record.model],
+                                             record.shininess);
+                registry.emplace<WorldTransform>(tile);
+            }
+        }
+    }
 }
 
-void placeLights() {
-    // Set up storage
-    // --------------
+void placeCameras(const rg::scene::SceneFile& scene) {
+    auto records = scene.cameras();
+    for (unsigned int i = 0; i < 4 && i < records.size(); ++i) {
+        state->get_camera(i)
+                .set_position(vec3(records[i].position))
+                .set_direction(vec3(records[i].direction));
+    }
+}
+
+void placeLights(const rg::scene::SceneFile& scene) {
     auto& lights = state->light_subsystem;
-    lights.directional = new std::vector<rg::DirectionalLight>();
-    lights.point = new std::vector<rg::PointLight>();
-    lights.spotlight = new std::vector<rg::SpotLight>();
 
-    rg::DirectionalLight weak_night_light;
-    weak_night_light.direction = glm::vec3{-2.0f, -1.0f, 3.0f};
-    weak_night_light.color.ambient = glm::vec3{0.1f};
-    weak_night_light.color.diffuse = glm::vec3{0.3f};
-    weak_night_light.color.specular = glm::vec3{0.3f};
-    lights.directional->push_back(weak_night_light);
-
-    rg::SpotLight camera_spotlight;
-    camera_spotlight.position = glm::vec3{0.0f, 5.0f, 5.0f};
-    camera_spotlight.direction = glm::vec3{0.0f, -1.0f, -1.0f};
-    camera_spotlight.color.ambient = glm::vec3{0.1f};
-    camera_spotlight.color.diffuse = glm::vec3{0.0f, 1.0f, 0.5f};
-    camera_spotlight.color.specular = glm::vec3{0.0f, 1.0f, 0.5f};
-    camera_spotlight.cutoff_angle = glm::cos(glm::radians(20.0f));
-    camera_spotlight.weaken_angle = glm::cos(glm::radians(15.0f));
-    camera_spotlight.attenuation.constant = 1.0f;
-    camera_spotlight.attenuation.linear = 0.22f;
-    camera_spotlight.attenuation.quadratic = 0.2f;
-    lights.spotlight->push_back(camera_spotlight);
-
-    rg::SpotLight lamp_spotlight;
-    lamp_spotlight.color.ambient = glm::vec3{0.1f};
-    lamp_spotlight.color.diffuse = glm::vec3{1.0f, 0.0f, 0.0f};
-    lamp_spotlight.color.specular = glm::vec3{1.0f, 0.0f, 0.0f};
-    lamp_spotlight.cutoff_angle = glm::cos(glm::radians(20.0f));
-    lamp_spotlight.weaken_angle = glm::cos(glm::radians(15.0f));
-    lamp_spotlight.attenuation.constant = 1.0f;
-    lamp_spotlight.attenuation.linear = 0.022f;
-    lamp_spotlight.attenuation.quadratic = 0.0019f;
-    lights.spotlight->push_back(lamp_spotlight);
-    state->lamp->spotlight = &lights.spotlight->back();
-
-    //    rg::PointLight point_light;
-    //    point_light.position = glm::vec3{5.0f, 0.0f, 0.0f};
-    //    point_light.color.ambient = glm::vec3{0.1f};
-    //    point_light.color.diffuse = glm::vec3{1.0f};
-    //    point_light.color.specular = glm::vec3{1.0f};
-    //    lights.point->push_back(point_light);
+    for (const auto& record : scene.directional_lights()) {
+        rg::DirectionalLight light;
+        light.direction = vec3(record.direction);
+        light.color = color(record.color);
+        lights.directional->push_back(light);
+    }
+
+    for (const auto& record : scene.point_lights()) {
+        rg::PointLight light;
+        light.position = vec3(record.position);
+        light.attenuation = attenuation(record.attenuation);
+        light.color = color(record.color);
+        lights.point->push_back(light);
+    }
+
+    for (const auto& record : scene.spotlights()) {
+        rg::SpotLight light;
+        light.position = vec3(record.position);
+        light.direction = vec3(record.direction);
+        light.cutoff_angle = record.cutoff_angle;
+        light.weaken_angle = record.weaken_angle;
+        light.attenuation = attenuation(record.attenuation);
+        light.color = color(record.color);
+
+        if (record.flags & rg::scene::SPOTLIGHT_FOLLOW_CAMERA)
+            lights.camera_spotlight =
+                    static_cast<int>(lights.spotlight->size());
+        lights.spotlight->push_back(light);
+    }
 }
 
 } // namespace app
@@ -2,24 +2,15 @@
 
 namespace app {
 
-Camera& CameraState::get_active_camera() {
-    return *cameras[active_camera];
-}
-
-const Camera& CameraState::get_active_camera() const {
-    return *cameras[active_camera];
-}
-
 CameraState::~CameraState() {
-    for (auto& camera : cameras) {
-        delete camera;
-        camera = nullptr;
-    }
-
     for (auto& surface : surfaces) {
         delete surface;
         surface = nullptr;
     }
+    for (auto& pyramid : depth_pyramids) {
+        delete pyramid;
+        pyramid = nullptr;
+    }
 }
 
 LightState::~LightState() {
@@ -31,25 +22,66 @@ LightState::~LightState() {
     spotlight = nullptr;
 }
 
+Camera& State::get_camera(unsigned int index) {
+    return registry.get<Camera>(camera_subsystem.cameras[index]);
+}
+
+Camera& State::get_active_camera() {
+    return get_camera(camera_subsystem.active_camera);
+}
+
+const Camera& State::get_active_camera() const {
+    const auto& cameras = camera_subsystem.cameras;
+    return registry.get<Camera>(cameras[camera_subsystem.active_camera]);
+}
+
 State::~State() {
-    // Objects
-    // -------
-    delete ball;
+    // Jobs
+    // ----
+    delete jobs;
 
     // Skybox
     // ------
     delete skybox;
 
+    // Geometry
+    // --------
+    // The models only refer to their ranges and materials, so they can
+    // outlive them
+    delete asset_reloader;
+    rg::Model::use_cache(nullptr);
+    delete model_cache;
+    delete geometry;
+    delete materials;
+    delete upload_ring;
+
+    // Command submission
+    // ------------------
+    delete submitter;
+
     // Shaders
     // -------
-    delete shader;
+    delete shader_reloader;
+    delete shaders;
     delete skybox_shader;
     delete surface_shader;
+    delete cull_shader;
+    delete depth_pyramid_shader;
+    delete bloom_shader;
+    delete post_shader;
+    rg::ShaderCompiler::use_cache(nullptr);
+    delete program_cache;
 
 #ifdef ENABLE_DEBUG
     delete debug_cube;
     delete debug_shader;
 #endif
+
+    // Resources
+    // ---------
+    // Last, as the loaders above may still point into the pack
+    rg::util::ResourcePack::unmount();
+    delete resource_pack;
 }
 
 void TimeState::update() {
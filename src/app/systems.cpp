@@ -0,0 +1,152 @@
+#include <app/systems.hpp>
+
+#include <rg/renderer/camera/Frustum.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace app {
+
+namespace {
+
+// Entities handled by a single job
+constexpr std::size_t GRAIN = 512;
+
+glm::vec3 lightColor(const rg::LightColor& color) {
+    const auto& a = color.ambient;
+    const auto& d = color.diffuse;
+    const auto& s = color.specular;
+
+    float na = glm::length(a);
+    float nd = glm::length(d);
+    float ns = glm::length(s);
+
+    return (a + d + s) / (na + nd + ns);
+}
+
+// Fill the list with the renderables whose world bounds pass the test
+template <class Test>
+void gather(const rg::ecs::Registry& registry, rg::JobSystem& jobs,
+            rg::DrawList& list, const Test& test) {
+    list.clear();
+    const auto* worlds = registry.find<WorldTransform>();
+    const auto* renderables = registry.find<Renderable>();
+    const auto* emissives = registry.find<Emissive>();
+    if (worlds == nullptr || renderables == nullptr)
+        return;
+
+    // Each chunk fills its own list, which are joined in order afterwards so
+    // the draw order does not depend on scheduling
+    std::vector<rg::DrawList> chunks((worlds->size() + GRAIN - 1) / GRAIN);
+    jobs.parallel_for(worlds->size(), GRAIN, [&](std::size_t begin,
+                                                 std::size_t end) {
+        auto& chunk = chunks[begin / GRAIN];
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& world = worlds->components()[i];
+            if (!test(world.bounds))
+                continue;
+
+            rg::ecs::Entity entity = worlds->entities()[i];
+            const auto& renderable = renderables->get(entity);
+            if (emissives != nullptr && emissives->contains(entity))
+                chunk.emissive.push_back(rg::EmissiveDrawItem{
+                        entity, renderable.model.get(), world.model_matrix,
+                        emissives->get(entity).color});
+            else
+                chunk.lit.push_back(rg::DrawItem{
+                        entity, renderable.model.get(), world.model_matrix,
+                        world.normal_matrix, renderable.shininess});
+        }
+    });
+
+    for (const auto& chunk : chunks) {
+        list.lit.insert(list.lit.end(), chunk.lit.begin(), chunk.lit.end());
+        list.emissive.insert(list.emissive.end(), chunk.emissive.begin(),
+                             chunk.emissive.end());
+    }
+}
+
+} // namespace
+
+void physicsSystem(rg::ecs::Registry& registry, rg::JobSystem& jobs,
+                   float delta) {
+    static constexpr glm::vec3 g = glm::vec3{0.0f, -9.81f, 0.0f};
+
+    // Pools are looked up before the jobs start, as a lookup may create one
+    auto& bodies = registry.pool<RigidBody>();
+    auto& transforms = registry.pool<rg::Transform>();
+    jobs.parallel_for(bodies.size(), GRAIN, [&](std::size_t begin,
+                                                std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            rg::ecs::Entity entity = bodies.entities()[i];
+            if (!transforms.contains(entity))
+                continue;
+
+            auto& body = bodies.components()[i];
+            auto& transform = transforms.get(entity);
+            const auto& radius = body.radius;
+            body.velocity += delta * g;
+            transform.position += delta * body.velocity;
+            if (transform.position.y <= radius) {
+                body.velocity = -body.velocity;
+                transform.position.y = radius + (radius - transform.position.y);
+            }
+        }
+    });
+}
+
+void lightSystem(rg::ecs::Registry& registry,
+                 std::vector<rg::SpotLight>& spotlights) {
+    registry.each<Light, rg::Transform>([&registry, &spotlights](
+                                                rg::ecs::Entity entity,
+                                                const Light& light,
+                                                const rg::Transform&
+                                                        transform) {
+        auto& spotlight = spotlights[light.spotlight];
+        auto model_matrix = transform.get_model_matrix();
+        auto normal_matrix = transform.get_normal_matrix();
+        spotlight.position = glm::vec3{model_matrix * glm::vec4{light.offset,
+                                                                1.0f}};
+        spotlight.direction = glm::normalize(
+                glm::vec3{normal_matrix * glm::vec4{light.direction, 0.0f}});
+
+        if (registry.has<Emissive>(entity))
+            registry.get<Emissive>(entity).color = lightColor(spotlight.color);
+    });
+}
+
+void transformSystem(rg::ecs::Registry& registry, rg::JobSystem& jobs) {
+    auto& worlds = registry.pool<WorldTransform>();
+    const auto& transforms = registry.pool<rg::Transform>();
+    const auto& renderables = registry.pool<Renderable>();
+    jobs.parallel_for(worlds.size(), GRAIN, [&](std::size_t begin,
+                                                std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            rg::ecs::Entity entity = worlds.entities()[i];
+            auto& world = worlds.components()[i];
+            const auto& model = *renderables.get(entity).model;
+
+            world.model_matrix = transforms.get(entity).get_model_matrix();
+            world.normal_matrix = glm::transpose(
+                    glm::inverse(glm::mat3{world.model_matrix}));
+            world.bounds = model.get_bounds().transformed(world.model_matrix);
+        }
+    });
+}
+
+void cullSystem(const rg::ecs::Registry& registry, const rg::View& view,
+                rg::JobSystem& jobs, rg::DrawList& list) {
+    rg::Frustum frustum{view};
+    gather(registry, jobs, list, [&frustum](const rg::BoundingSphere& bounds) {
+        return frustum.intersects(bounds);
+    });
+}
+
+void collectSystem(const rg::ecs::Registry& registry, rg::JobSystem& jobs,
+                   rg::DrawList& list) {
+    gather(registry, jobs, list,
+           [](const rg::BoundingSphere& /* bounds */) { return true; });
+}
+
+} // namespace app
@@ -0,0 +1,45 @@
+#include <rg/ecs/Pool.hpp>
+
+namespace rg::ecs {
+
+bool SparseSet::contains(Entity entity) const {
+    return entity < sparse_.size() && sparse_[entity] != EMPTY;
+}
+
+std::size_t SparseSet::index(Entity entity) const {
+    return sparse_[entity];
+}
+
+std::size_t SparseSet::size() const {
+    return dense_.size();
+}
+
+bool SparseSet::empty() const {
+    return dense_.empty();
+}
+
+const std::vector<Entity>& SparseSet::entities() const {
+    return dense_;
+}
+
+std::size_t SparseSet::insert(Entity entity) {
+    if (entity >= sparse_.size())
+        sparse_.resize(entity + 1, EMPTY);
+
+    sparse_[entity] = dense_.size();
+    dense_.push_back(entity);
+    return sparse_[entity];
+}
+
+std::size_t SparseSet::erase(Entity entity) {
+    std::size_t slot = sparse_[entity];
+    Entity last = dense_.back();
+
+    dense_[slot] = last;
+    sparse_[last] = slot;
+    sparse_[entity] = EMPTY;
+    dense_.pop_back();
+    return slot;
+}
+
+} // namespace rg::ecs
@@ -0,0 +1,44 @@
+#include <rg/ecs/Registry.hpp>
+
+#include <algorithm>
+
+namespace rg::ecs {
+
+std::size_t detail::nextTypeIndex() {
+    static std::size_t counter = 0;
+    return counter++;
+}
+
+Entity Registry::create() {
+    if (!free_.empty()) {
+        Entity entity = free_.back();
+        free_.pop_back();
+        alive_[entity] = true;
+        return entity;
+    }
+
+    alive_.push_back(true);
+    return static_cast<Entity>(alive_.size() - 1);
+}
+
+void Registry::destroy(Entity entity) {
+    if (!valid(entity))
+        return;
+
+    for (auto& pool : pools_)
+        if (pool != nullptr && pool->contains(entity))
+            pool->remove(entity);
+
+    alive_[entity] = false;
+    free_.push_back(entity);
+}
+
+bool Registry::valid(Entity entity) const {
+    return entity < alive_.size() && alive_[entity];
+}
+
+std::size_t Registry::alive() const {
+    return std::count(alive_.begin(), alive_.end(), true);
+}
+
+} // namespace rg::ecs
@@ -0,0 +1,192 @@
+#include <rg/jobs/JobSystem.hpp>
+
+#include <chrono>
+
+namespace rg {
+
+namespace {
+
+// Large enough for a frame's worth of jobs from one thread, anything beyond
+// it goes through the shared queue
+constexpr std::int64_t DEQUE_CAPACITY = 4096;
+// How many times an idle worker looks for work before going to sleep
+constexpr unsigned int IDLE_SPINS = 64;
+
+// The deque owned by the current thread
+thread_local const JobSystem* current_system = nullptr;
+thread_local int current_index = -1;
+
+} // namespace
+
+JobCounter::~JobCounter() {
+    std::lock_guard<std::mutex> lock{mutex_};
+}
+
+unsigned int JobSystem::defaultWorkerCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+JobSystem::JobSystem(unsigned int workers) : deques_{}, workers_{}, shared_{} {
+    deques_.reserve(workers + 1);
+    for (unsigned int i = 0; i <= workers; ++i)
+        deques_.push_back(std::make_unique<Deque>(DEQUE_CAPACITY));
+
+    current_system = this;
+    current_index = 0;
+
+    workers_.reserve(workers);
+    for (unsigned int i = 1; i <= workers; ++i)
+        workers_.emplace_back([this, i] { work(static_cast<int>(i)); });
+}
+
+JobSystem::~JobSystem() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock{sleep_mutex_};
+        wake_.notify_all();
+    }
+    for (auto& worker : workers_)
+        worker.join();
+
+    // Jobs which were never waited on
+    while (Job* job = take(0))
+        delete job;
+
+    if (current_system == this) {
+        current_system = nullptr;
+        current_index = -1;
+    }
+}
+
+unsigned int JobSystem::worker_count() const {
+    return static_cast<unsigned int>(workers_.size());
+}
+
+void JobSystem::run(std::function<void()> job, JobCounter& counter) {
+    counter.pending_.fetch_add(1, std::memory_order_relaxed);
+    submit(new Job{std::move(job), &counter});
+}
+
+void JobSystem::run_after(const JobCounter& dependency,
+                          std::function<void()> job, JobCounter& counter) {
+    counter.pending_.fetch_add(1, std::memory_order_relaxed);
+    auto* next = new Job{std::move(job), &counter};
+    {
+        std::lock_guard<std::mutex> lock{dependency.mutex_};
+        if (!dependency.done()) {
+            dependency.continuations_.push_back(next);
+            return;
+        }
+    }
+    submit(next);
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    int own = deque_index();
+    while (!counter.done()) {
+        if (Job* job = take(own))
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::submit(Job* job) {
+    queued_.fetch_add(1, std::memory_order_relaxed);
+
+    int own = deque_index();
+    if (own < 0 || !deques_[own]->push(job)) {
+        std::lock_guard<std::mutex> lock{shared_mutex_};
+        shared_.push_back(job);
+    }
+    wake_.notify_one();
+}
+
+void JobSystem::execute(Job* job) {
+    job->task();
+    JobCounter& counter = *job->counter;
+    delete job;
+    finish(counter);
+}
+
+void JobSystem::finish(JobCounter& counter) {
+    // Only the last job of the group takes the lock
+    unsigned int pending = counter.pending_.load(std::memory_order_relaxed);
+    while (pending > 1)
+        if (counter.pending_.compare_exchange_weak(pending, pending - 1,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed))
+            return;
+
+    std::vector<Job*> ready;
+    {
+        std::lock_guard<std::mutex> lock{counter.mutex_};
+        // A job started meanwhile may have kept the counter from zero
+        if (counter.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter.continuations_);
+    }
+    // The counter may be gone once it is unlocked
+    for (Job* next : ready)
+        submit(next);
+}
+
+JobSystem::Job* JobSystem::take(int own) {
+    Job* job = nullptr;
+    if (own >= 0)
+        job = deques_[own]->pop();
+
+    if (job == nullptr) {
+        std::lock_guard<std::mutex> lock{shared_mutex_};
+        if (!shared_.empty()) {
+            job = shared_.front();
+            shared_.pop_front();
+        }
+    }
+
+    // Steal, starting from the next deque so that thieves spread out.
+    // Threads without a deque of their own visit every one.
+    auto count = static_cast<int>(deques_.size());
+    for (int i = 0; job == nullptr && i < count; ++i) {
+        int victim = own < 0 ? i : (own + i) % count;
+        if (victim != own)
+            job = deques_[victim]->steal();
+    }
+
+    if (job != nullptr)
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::work(int index) {
+    current_system = this;
+    current_index = index;
+
+    unsigned int idle = 0;
+    while (!stop_.load(std::memory_order_relaxed)) {
+        if (Job* job = take(index)) {
+            execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // The timeout covers a notification sent between the check and the
+        // wait
+        std::unique_lock<std::mutex> lock{sleep_mutex_};
+        wake_.wait_for(lock, std::chrono::milliseconds{1}, [this] {
+            return stop_.load() || queued_.load() > 0;
+        });
+        idle = 0;
+    }
+}
+
+int JobSystem::deque_index() const {
+    return current_system == this ? current_index : -1;
+}
+
+} // namespace rg
@@ -1,11 +1,16 @@
 #include <app/cleanup.hpp>
+#include <app/constants.hpp>
 #include <app/init.hpp>
 #include <app/loop.hpp>
 
 float sensitivity = 0.003f;
 
-int main() {
-    app::init();
+int main(int argc, char** argv) {
+    // A scene can be passed as the first argument, either as a JSON
+    // description or as a binary compiled with rg-scenec
+    std::string scene = argc > 1 ? argv[1] : app::util::resource(app::SCENE);
+
+    app::init(scene);
     app::loop();
     app::cleanup();
     return 0;
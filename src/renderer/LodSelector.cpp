@@ -0,0 +1,49 @@
+#include <rg/renderer/LodSelector.hpp>
+
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace rg {
+
+void LodSelector::begin(const View& view, unsigned int height) {
+    view_ = view;
+    pixels_ = static_cast<float>(height) /
+              (2.0f * std::tan(glm::radians(view.vertical_fov) / 2.0f));
+
+    // Forget the items which were not drawn last frame
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.frame < frame_)
+            it = entries_.erase(it);
+        else
+            ++it;
+    }
+    ++frame_;
+}
+
+float LodSelector::scale(std::uint32_t id, const Model& model,
+                         const glm::mat4& model_matrix) {
+    const auto& bounds = model.get_bounds();
+    BoundingSphere world = bounds.transformed(model_matrix);
+    float distance = glm::length(world.center - view_.position);
+    // The nearest point of the bounds, up to the near plane for the items
+    // the camera is inside of
+    distance = std::max(distance - world.radius, view_.z_near);
+    float units = bounds.radius > 0.0f ? world.radius / bounds.radius : 1.0f;
+    float scale = pixels_ * units / distance;
+
+    auto [it, added] = entries_.try_emplace(id, Entry{scale, frame_});
+    auto& entry = it->second;
+    entry.frame = frame_;
+    if (!added && std::abs(scale / entry.scale - 1.0f) > HYSTERESIS)
+        entry.scale = scale;
+    return entry.scale;
+}
+
+std::uint32_t LodSelector::select(const Mesh& mesh, float scale) {
+    return mesh.select_lod(MAX_SCREEN_ERROR / scale);
+}
+
+} // namespace rg
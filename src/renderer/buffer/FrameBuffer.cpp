@@ -7,18 +7,19 @@ namespace rg {
 
 FrameBuffer::FrameBuffer(unsigned int width, unsigned int height)
         : framebuffer_id_{0}, intermediate_framebuffer_id_{0},
-          screen_color_texture_id_{0}, width_{width}, height_{height} {
+          screen_color_texture_id_{0}, screen_depth_texture_id_{0},
+          width_{width}, height_{height} {
     // screen_color_texture_id_ is kinda like old color_id_ (it's the one being
     // drawn)
     glGenFramebuffers(1, &framebuffer_id_);
     this->bind();
 
-    // Color texture
+    // Color texture, in HDR until the post chain maps it to the screen
     unsigned int multisampledColorTexture;
     glGenTextures(1, &multisampledColorTexture);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, multisampledColorTexture);
-    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES, GL_RGB,
-                            width, height, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, MSAA_SAMPLES,
+                            GL_RGBA16F, width, height, GL_TRUE);
     glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -51,13 +52,27 @@ FrameBuffer::FrameBuffer(unsigned int width, unsigned int height)
     glBindFramebuffer(GL_FRAMEBUFFER, intermediate_framebuffer_id_);
     glGenTextures(1, &screen_color_texture_id_);
     glBindTexture(GL_TEXTURE_2D, screen_color_texture_id_);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA,
+                 GL_HALF_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
                            screen_color_texture_id_, 0);
 
+    // Depth is resolved as well, for occlusion culling. The format has to
+    // match the multisampled renderbuffer for the blit.
+    glGenTextures(1, &screen_depth_texture_id_);
+    glBindTexture(GL_TEXTURE_2D, screen_depth_texture_id_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0,
+                 GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT,
+                           GL_TEXTURE_2D, screen_depth_texture_id_, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         spdlog::error("ERROR::RG::FRAMEBUFFER:: Intermediate framebuffer "
                       "creation failed!");
@@ -76,6 +91,18 @@ unsigned int FrameBuffer::get_color_texture() const {
     return screen_color_texture_id_;
 }
 
+unsigned int FrameBuffer::get_depth_texture() const {
+    return screen_depth_texture_id_;
+}
+
+unsigned int FrameBuffer::get_width() const {
+    return width_;
+}
+
+unsigned int FrameBuffer::get_height() const {
+    return height_;
+}
+
 void FrameBuffer::bind() const {
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id_);
 }
@@ -84,7 +111,7 @@ void FrameBuffer::blit() const {
     glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_id_);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, intermediate_framebuffer_id_);
     glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_,
-                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                      GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
@@ -0,0 +1,219 @@
+#include <rg/renderer/buffer/GeometryArena.hpp>
+
+#include <glad/glad.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace rg {
+
+namespace {
+
+// The vertex buffer binding index used by every attribute
+constexpr unsigned int BINDING = 0;
+
+unsigned int createBuffer(unsigned int target, std::size_t size) {
+    unsigned int id = 0;
+    glGenBuffers(1, &id);
+    glBindBuffer(target, id);
+    glBufferData(target, static_cast<GLsizeiptr>(size), nullptr,
+                 GL_STATIC_DRAW);
+    return id;
+}
+
+// Move the contents into a larger buffer
+unsigned int resizeBuffer(unsigned int id, std::size_t old_size,
+                          std::size_t new_size) {
+    unsigned int resized = 0;
+    glGenBuffers(1, &resized);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, resized);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(new_size),
+                 nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, id);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                        static_cast<GLsizeiptr>(old_size));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &id);
+    return resized;
+}
+
+std::uint32_t grownCapacity(std::uint32_t capacity, std::uint32_t required) {
+    return std::max(capacity * 2, capacity + required);
+}
+
+} // namespace
+
+GeometryArena::GeometryArena(VertexLayout layout,
+                             std::uint32_t vertex_capacity,
+                             std::uint32_t index_capacity)
+        : layout_{std::move(layout)}, vertices_{vertex_capacity},
+          indices_{index_capacity}, vertex_array_id_{0},
+          vertex_buffer_id_{0}, index_buffer_id_{0} {
+    glGenVertexArrays(1, &vertex_array_id_);
+    glBindVertexArray(vertex_array_id_);
+
+    vertex_buffer_id_ = createBuffer(
+            GL_ARRAY_BUFFER,
+            static_cast<std::size_t>(vertex_capacity) * layout_.stride());
+    index_buffer_id_ =
+            createBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                         static_cast<std::size_t>(index_capacity) *
+                                 sizeof(Index));
+
+    // The format is separate from the buffer, so growing only has to rebind
+    // the vertex buffer
+    const auto& elements = layout_.get_elements();
+    const auto& offsets = layout_.offsets();
+    for (unsigned int i = 0; i < elements.size(); ++i) {
+        const auto& e = elements[i];
+        glVertexAttribFormat(i, static_cast<GLint>(e.count),
+                             util::intValue(e.type),
+                             e.normalized ? GL_TRUE : GL_FALSE, offsets[i]);
+        glVertexAttribBinding(i, BINDING);
+        glEnableVertexAttribArray(i);
+    }
+    glBindVertexBuffer(BINDING, vertex_buffer_id_, 0,
+                       static_cast<GLsizei>(layout_.stride()));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+GeometryArena::GeometryArena(GeometryArena&& other) noexcept
+        : layout_{std::move(other.layout_)},
+          vertices_{std::move(other.vertices_)},
+          indices_{std::move(other.indices_)},
+          vertex_array_id_{other.vertex_array_id_},
+          vertex_buffer_id_{other.vertex_buffer_id_},
+          index_buffer_id_{other.index_buffer_id_} {
+    other.vertex_array_id_ = 0;
+    other.vertex_buffer_id_ = 0;
+    other.index_buffer_id_ = 0;
+}
+
+GeometryArena& GeometryArena::operator=(GeometryArena&& other) noexcept {
+    release();
+    layout_ = std::move(other.layout_);
+    vertices_ = std::move(other.vertices_);
+    indices_ = std::move(other.indices_);
+    vertex_array_id_ = other.vertex_array_id_;
+    vertex_buffer_id_ = other.vertex_buffer_id_;
+    index_buffer_id_ = other.index_buffer_id_;
+    other.vertex_array_id_ = 0;
+    other.vertex_buffer_id_ = 0;
+    other.index_buffer_id_ = 0;
+    return *this;
+}
+
+GeometryArena::~GeometryArena() {
+    release();
+}
+
+void GeometryArena::release() {
+    glDeleteVertexArrays(1, &vertex_array_id_);
+    glDeleteBuffers(1, &vertex_buffer_id_);
+    glDeleteBuffers(1, &index_buffer_id_);
+    vertex_array_id_ = 0;
+    vertex_buffer_id_ = 0;
+    index_buffer_id_ = 0;
+}
+
+GeometryRange GeometryArena::allocate(const void* vertices,
+                                      std::uint32_t vertex_count,
+                                      const Index* indices,
+                                      std::uint32_t index_count) {
+    if (vertex_count > MAX_MESH_VERTICES)
+        throw std::runtime_error{
+                "RG::GEOMETRY_ARENA: too many vertices for 16-bit indices"};
+
+    auto vertex_range = vertices_.allocate(vertex_count);
+    if (!vertex_range) {
+        growVertices(grownCapacity(vertices_.capacity(), vertex_count));
+        vertex_range = vertices_.allocate(vertex_count);
+    }
+    auto index_range = indices_.allocate(index_count);
+    if (!index_range) {
+        growIndices(grownCapacity(indices_.capacity(), index_count));
+        index_range = indices_.allocate(index_count);
+    }
+    if (!vertex_range || !index_range)
+        throw std::runtime_error{"RG::GEOMETRY_ARENA: allocation failed"};
+
+    std::size_t stride = layout_.stride();
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_id_);
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    static_cast<GLintptr>(vertex_range->offset * stride),
+                    static_cast<GLsizeiptr>(vertex_count * stride), vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer binding is part of the VAO state
+    glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer_id_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(index_range->offset * sizeof(Index)),
+                    static_cast<GLsizeiptr>(index_count * sizeof(Index)),
+                    indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    return GeometryRange{vertex_range->offset, vertex_count,
+                         index_range->offset, index_count};
+}
+
+void GeometryArena::free(const GeometryRange& range) {
+    vertices_.free({range.base_vertex, range.vertex_count});
+    indices_.free({range.first_index, range.index_count});
+}
+
+void GeometryArena::growVertices(std::uint32_t capacity) {
+    std::size_t stride = layout_.stride();
+    spdlog::info("RG::GEOMETRY_ARENA: growing to {} vertices", capacity);
+    vertex_buffer_id_ = resizeBuffer(vertex_buffer_id_,
+                                     vertices_.capacity() * stride,
+                                     capacity * stride);
+    vertices_.grow(capacity);
+
+    glBindVertexArray(vertex_array_id_);
+    glBindVertexBuffer(BINDING, vertex_buffer_id_, 0,
+                       static_cast<GLsizei>(stride));
+    glBindVertexArray(0);
+}
+
+void GeometryArena::growIndices(std::uint32_t capacity) {
+    spdlog::info("RG::GEOMETRY_ARENA: growing to {} indices", capacity);
+    index_buffer_id_ =
+            resizeBuffer(index_buffer_id_,
+                         indices_.capacity() * sizeof(Index),
+                         capacity * sizeof(Index));
+    indices_.grow(capacity);
+
+    glBindVertexArray(vertex_array_id_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id_);
+    glBindVertexArray(0);
+}
+
+void GeometryArena::bind() const {
+    glBindVertexArray(vertex_array_id_);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+void GeometryArena::unbind() const {
+    glBindVertexArray(0);
+}
+
+unsigned int GeometryArena::vertex_array_id() const {
+    return vertex_array_id_;
+}
+
+unsigned int GeometryArena::index_buffer_id() const {
+    return index_buffer_id_;
+}
+
+const VertexLayout& GeometryArena::layout() const {
+    return layout_;
+}
+
+} // namespace rg
@@ -2,31 +2,43 @@
 
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
 namespace rg {
 
-IndexBuffer::IndexBuffer() : buffer_id_{0}, indices_{0} {
+IndexBuffer::IndexBuffer() : buffer_id_{0}, indices_{0}, type_{0} {
 }
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count) {
     buffer_id_ = 0;
     indices_ = count;
+    type_ = GL_UNSIGNED_INT;
     glGenBuffers(1, &buffer_id_);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_id_);
+
+    const unsigned int* end = data + count;
+    if (std::all_of(data, end, [](unsigned int index) {
+            return index <= std::numeric_limits<std::uint16_t>::max();
+        })) {
+        std::vector<std::uint16_t> narrow(data, end);
+        type_ = GL_UNSIGNED_SHORT;
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                     narrow.size() * sizeof(std::uint16_t), narrow.data(),
+                     GL_STATIC_DRAW);
+        return;
+    }
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(*data), data,
                  GL_STATIC_DRAW);
 }
 
-IndexBuffer::IndexBuffer(const std::vector<unsigned int>& data) {
-    buffer_id_ = 0;
-    indices_ = data.size();
-    glGenBuffers(1, &buffer_id_);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer_id_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(data.front()),
-                 data.data(), GL_STATIC_DRAW);
+IndexBuffer::IndexBuffer(const std::vector<unsigned int>& data)
+        : IndexBuffer{data.data(), static_cast<unsigned int>(data.size())} {
 }
 
 IndexBuffer::IndexBuffer(IndexBuffer&& ib) noexcept
-        : buffer_id_{ib.buffer_id_}, indices_{ib.indices_} {
+        : buffer_id_{ib.buffer_id_}, indices_{ib.indices_}, type_{ib.type_} {
     ib.buffer_id_ = 0;
     ib.indices_ = 0;
 }
@@ -34,6 +46,7 @@ IndexBuffer::IndexBuffer(IndexBuffer&& ib) noexcept
 IndexBuffer& IndexBuffer::operator=(IndexBuffer&& ib) noexcept {
     this->buffer_id_ = ib.buffer_id_;
     this->indices_ = ib.indices_;
+    this->type_ = ib.type_;
     ib.buffer_id_ = 0;
     ib.indices_ = 0;
     return (*this);
@@ -56,4 +69,8 @@ unsigned int IndexBuffer::count() const {
     return indices_;
 }
 
+unsigned int IndexBuffer::type() const {
+    return type_;
+}
+
 } // namespace rg
@@ -0,0 +1,74 @@
+#include <rg/renderer/buffer/RangeAllocator.hpp>
+
+#include <iterator>
+
+namespace rg {
+
+RangeAllocator::RangeAllocator(std::uint32_t capacity)
+        : free_{}, capacity_{capacity}, used_{0} {
+    if (capacity > 0)
+        free_.emplace(0, capacity);
+}
+
+std::optional<RangeAllocator::Range>
+RangeAllocator::allocate(std::uint32_t size) {
+    if (size == 0)
+        return Range{0, 0};
+
+    for (auto it = free_.begin(); it != free_.end(); ++it) {
+        auto [offset, available] = *it;
+        if (available < size)
+            continue;
+
+        free_.erase(it);
+        if (available > size)
+            free_.emplace(offset + size, available - size);
+        used_ += size;
+        return Range{offset, size};
+    }
+    return std::nullopt;
+}
+
+void RangeAllocator::free(Range range) {
+    if (range.size == 0)
+        return;
+    used_ -= range.size;
+
+    auto next = free_.lower_bound(range.offset);
+    // Merge with the free range after
+    if (next != free_.end() && range.offset + range.size == next->first) {
+        range.size += next->second;
+        next = free_.erase(next);
+    }
+    // Merge with the free range before
+    if (next != free_.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == range.offset) {
+            previous->second += range.size;
+            return;
+        }
+    }
+    free_.emplace_hint(next, range.offset, range.size);
+}
+
+void RangeAllocator::grow(std::uint32_t capacity) {
+    if (capacity <= capacity_)
+        return;
+
+    std::uint32_t old_capacity = capacity_;
+    capacity_ = capacity;
+    // The new space is handed back as a freed range so it merges with a free
+    // tail
+    used_ += capacity - old_capacity;
+    free(Range{old_capacity, capacity - old_capacity});
+}
+
+std::uint32_t RangeAllocator::capacity() const {
+    return capacity_;
+}
+
+std::uint32_t RangeAllocator::used() const {
+    return used_;
+}
+
+} // namespace rg
@@ -0,0 +1,130 @@
+#include <rg/renderer/buffer/UploadRing.hpp>
+
+#include <glad/glad.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace rg {
+
+namespace {
+
+// Regions start on this boundary, which suits every unpack alignment
+constexpr std::size_t ALIGNMENT = 64;
+constexpr GLbitfield MAP_FLAGS =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+std::size_t alignUp(std::size_t value) {
+    return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+} // namespace
+
+UploadRing::UploadRing(std::size_t capacity)
+        : capacity_{alignUp(capacity)}, buffer_id_{0}, data_{nullptr},
+          mutex_{}, blocks_{}, head_{0}, tail_{0}, retired_{}, fences_{} {
+    glGenBuffers(1, &buffer_id_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_id_);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER,
+                    static_cast<GLsizeiptr>(capacity_), nullptr, MAP_FLAGS);
+    data_ = static_cast<unsigned char*>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                             static_cast<GLsizeiptr>(capacity_), MAP_FLAGS));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (data_ == nullptr)
+        spdlog::error("RG::UPLOAD_RING: Failed to map the ring, uploads "
+                      "read from client memory");
+}
+
+UploadRing::~UploadRing() {
+    for (auto& fence : fences_)
+        glDeleteSync(static_cast<GLsync>(fence.sync));
+    if (data_ != nullptr) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_id_);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer_id_);
+}
+
+std::optional<UploadRing::Region> UploadRing::allocate(std::size_t size) {
+    size = alignUp(size);
+    if (data_ == nullptr || size == 0 || size > capacity_)
+        return std::nullopt;
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    // A region may not wrap around the end of the buffer, so the rest of
+    // the buffer is skipped if it is too short
+    std::size_t position = head_ % capacity_;
+    std::size_t padding = position + size > capacity_ ? capacity_ - position
+                                                      : 0;
+    if (head_ + padding + size - tail_ > capacity_)
+        return std::nullopt;
+
+    if (padding > 0) {
+        blocks_.push_back(Block{head_, head_ + padding, true});
+        head_ += padding;
+    }
+    Region region{head_, size, data_ + head_ % capacity_};
+    blocks_.push_back(Block{head_, head_ + size, false});
+    head_ += size;
+    return region;
+}
+
+void UploadRing::bind() const {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_id_);
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+void UploadRing::unbind() const {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+const void* UploadRing::offset(const Region& region) const {
+    return reinterpret_cast<const void*>(region.begin % capacity_);
+}
+
+void UploadRing::retire(const Region& region) {
+    retired_.push_back(region.begin);
+}
+
+void UploadRing::fence() {
+    if (retired_.empty())
+        return;
+    GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fences_.push_back(Fence{sync, std::move(retired_)});
+    retired_.clear();
+}
+
+void UploadRing::reclaim() {
+    std::vector<std::size_t> finished;
+    while (!fences_.empty()) {
+        auto sync = static_cast<GLsync>(fences_.front().sync);
+        GLenum status = glClientWaitSync(sync, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        glDeleteSync(sync);
+        auto& regions = fences_.front().regions;
+        finished.insert(finished.end(), regions.begin(), regions.end());
+        fences_.pop_front();
+    }
+    if (finished.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    for (std::size_t begin : finished) {
+        auto it = std::lower_bound(blocks_.begin(), blocks_.end(), begin,
+                                   [](const Block& block, std::size_t value) {
+                                       return block.begin < value;
+                                   });
+        if (it != blocks_.end() && it->begin == begin)
+            it->done = true;
+    }
+    // Regions retire out of order, the ring only moves past a prefix
+    while (!blocks_.empty() && blocks_.front().done)
+        blocks_.pop_front();
+    tail_ = blocks_.empty() ? head_ : blocks_.front().begin;
+}
+
+} // namespace rg
@@ -33,6 +33,10 @@ void VertexArray::unbind() const {
     glBindVertexArray(0);
 }
 
+unsigned int VertexArray::id() const {
+    return array_id_;
+}
+
 void VertexArray::recordLayout(const VertexBuffer& vb,
                                const VertexLayout& layout) const {
     bind();
@@ -40,18 +44,25 @@ void VertexArray::recordLayout(const VertexBuffer& vb,
 
     const auto& elements = layout.get_elements();
     unsigned int element_count = elements.size();
-    auto offsets = layout.offsets();
+    const auto& offsets = layout.offsets();
 
     for (unsigned int i = 0; i < element_count; ++i) {
         const auto& e = elements[i];
-        unsigned long long offset = offsets[i];
-        unsigned int type_id = util::intValue(e.type);
-        glVertexAttribPointer(i, e.count, type_id,
-                              (e.normalized ? GL_TRUE : GL_FALSE),
-                              layout.stride(),
-                              reinterpret_cast<const void*>(offset));
-        glEnableVertexAttribArray(i);
+        recordAttribute(i, e.count, util::intValue(e.type), e.normalized,
+                        layout.stride(), offsets[i]);
     }
 }
 
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+void VertexArray::recordAttribute(unsigned int index, unsigned int count,
+                                  unsigned int type, bool normalized,
+                                  unsigned int stride,
+                                  std::size_t offset) const {
+    glVertexAttribPointer(index, static_cast<GLint>(count), type,
+                          (normalized ? GL_TRUE : GL_FALSE),
+                          static_cast<GLsizei>(stride),
+                          reinterpret_cast<const void*>(offset));
+    glEnableVertexAttribArray(index);
+}
+
 } // namespace rg
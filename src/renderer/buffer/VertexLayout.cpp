@@ -2,85 +2,56 @@
 
 #include <glad/glad.h>
 
-#include <numeric>
-#include <stdexcept>
+#include <utility>
 
 namespace rg {
 
+static_assert(util::intValue(ElementType::FLOAT) == GL_FLOAT);
+static_assert(util::intValue(ElementType::HALF_FLOAT) == GL_HALF_FLOAT);
+static_assert(util::intValue(ElementType::INT_2_10_10_10_REV) ==
+              GL_INT_2_10_10_10_REV);
+static_assert(util::intValue(ElementType::SHORT) == GL_SHORT);
+static_assert(util::intValue(ElementType::BYTE) == GL_BYTE);
+static_assert(util::intValue(ElementType::UNSIGNED_INT) == GL_UNSIGNED_INT);
+
 std::size_t LayoutElement::size() const {
+    if (util::isPacked(type))
+        return util::size(type);
     return count * util::size(type);
 }
 
 void VertexLayout::push(LayoutElement element) {
+    offsets_.push_back(stride_);
     elements_.push_back(element);
     stride_ += element.size();
 }
 
-std::vector<unsigned int> VertexLayout::offsets() const {
-    if (elements_.empty())
-        return {};
-
-    unsigned int n = elements_.size();
-    std::vector<unsigned int> offsets(n, 0);
-    for (int i = 1; i < n; ++i)
-        offsets[i] = offsets[i - 1] + elements_[i - 1].size();
-
-    return offsets;
+const std::vector<unsigned int>& VertexLayout::offsets() const {
+    return offsets_;
 }
 
 unsigned int VertexLayout::stride() const {
     return stride_;
 }
 
-namespace util {
-
-std::size_t size(const ElementType& type) {
-    switch (type) {
-        case ElementType::FLOAT:
-            return sizeof(float);
-        case ElementType::UNSIGNED_INT:
-            return sizeof(unsigned int);
-    }
-    throw std::runtime_error{"type is not FLOAT or UNSIGNED_INT"};
-}
-
-unsigned int intValue(const ElementType& type) {
-    switch (type) {
-        case ElementType::FLOAT:
-            return GL_FLOAT;
-        case ElementType::UNSIGNED_INT:
-            return GL_UNSIGNED_INT;
-    }
-
-    throw std::runtime_error{"type is not FLOAT or UNSIGNED_INT"};
-}
-
-} // namespace util
-
 LayoutElement::LayoutElement(ElementType type, unsigned int count,
                              bool normalized)
         : type{type}, count{count}, normalized{normalized} {
 }
 
-VertexLayout::VertexLayout() : elements_{}, stride_{0} {
+VertexLayout::VertexLayout() : elements_{}, offsets_{}, stride_{0} {
 }
 
 VertexLayout::VertexLayout(std::vector<LayoutElement> elements)
-        : elements_{std::move(elements)} {
-    stride_ = std::accumulate(
-            elements.begin(), elements.end(), 0U,
-            [](unsigned int accumulator, const LayoutElement& element) {
-                return accumulator + element.size();
-            });
+        : VertexLayout{} {
+    elements_.reserve(elements.size());
+    offsets_.reserve(elements.size());
+    for (const auto& element : elements)
+        push(element);
 }
 
 VertexLayout::VertexLayout(std::initializer_list<LayoutElement> elements)
-        : elements_{elements} {
-    stride_ = std::accumulate(
-            elements.begin(), elements.end(), 0U,
-            [](unsigned int accumulator, const LayoutElement& element) {
-                return accumulator + element.size();
-            });
+        : VertexLayout{std::vector<LayoutElement>{elements}} {
 }
 
 const std::vector<LayoutElement>& VertexLayout::get_elements() const {
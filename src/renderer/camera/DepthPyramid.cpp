@@ -0,0 +1,113 @@
+#include <rg/renderer/camera/DepthPyramid.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace rg {
+
+namespace {
+
+// Must match local_size in depth_pyramid.cs.glsl
+constexpr unsigned int GROUP_SIZE = 8;
+
+} // namespace
+
+DepthPyramid::DepthPyramid(unsigned int width, unsigned int height)
+        : texture_id_{0}, width_{width}, height_{height}, levels_{1},
+          valid_{false} {
+    // Down to a single texel
+    for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+        ++levels_;
+
+    glGenTextures(1, &texture_id_);
+    glBindTexture(GL_TEXTURE_2D, texture_id_);
+    glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(levels_), GL_R32F,
+                   static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+DepthPyramid::DepthPyramid(DepthPyramid&& other) noexcept
+        : texture_id_{other.texture_id_}, width_{other.width_},
+          height_{other.height_}, levels_{other.levels_},
+          valid_{other.valid_} {
+    other.texture_id_ = 0;
+    other.valid_ = false;
+}
+
+DepthPyramid& DepthPyramid::operator=(DepthPyramid&& other) noexcept {
+    glDeleteTextures(1, &texture_id_);
+    texture_id_ = other.texture_id_;
+    width_ = other.width_;
+    height_ = other.height_;
+    levels_ = other.levels_;
+    valid_ = other.valid_;
+    other.texture_id_ = 0;
+    other.valid_ = false;
+    return *this;
+}
+
+DepthPyramid::~DepthPyramid() {
+    glDeleteTextures(1, &texture_id_);
+}
+
+void DepthPyramid::build(const Shader& reduce, unsigned int depth_texture) {
+    reduce.bind();
+    reduce.set_int("depth", 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depth_texture);
+
+    for (unsigned int level = 0; level < levels_; ++level) {
+        unsigned int width = std::max(width_ >> level, 1U);
+        unsigned int height = std::max(height_ >> level, 1U);
+
+        // The base level is copied from the depth texture, the others are
+        // reduced from the level above
+        reduce.set_int("from_depth", level == 0);
+        if (level > 0)
+            glBindImageTexture(0, texture_id_, static_cast<GLint>(level - 1),
+                               GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, texture_id_, static_cast<GLint>(level),
+                           GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((width + GROUP_SIZE - 1) / GROUP_SIZE,
+                          (height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    // The culling pass reads the pyramid with texelFetch
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    reduce.unbind();
+    valid_ = true;
+}
+
+void DepthPyramid::invalidate() {
+    valid_ = false;
+}
+
+bool DepthPyramid::is_valid() const {
+    return valid_;
+}
+
+unsigned int DepthPyramid::get_texture() const {
+    return texture_id_;
+}
+
+unsigned int DepthPyramid::get_width() const {
+    return width_;
+}
+
+unsigned int DepthPyramid::get_height() const {
+    return height_;
+}
+
+unsigned int DepthPyramid::get_levels() const {
+    return levels_;
+}
+
+} // namespace rg
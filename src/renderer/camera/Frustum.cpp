@@ -0,0 +1,36 @@
+#include <rg/renderer/camera/Frustum.hpp>
+
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace rg {
+
+Frustum::Frustum(const View& view) : planes_{} {
+    // Gribb & Hartmann: the planes are sums and differences of the rows of
+    // the view-projection matrix
+    glm::mat4 m = view.get_projection_matrix() * view.get_view_matrix();
+    glm::vec4 row_x{m[0][0], m[1][0], m[2][0], m[3][0]};
+    glm::vec4 row_y{m[0][1], m[1][1], m[2][1], m[3][1]};
+    glm::vec4 row_z{m[0][2], m[1][2], m[2][2], m[3][2]};
+    glm::vec4 row_w{m[0][3], m[1][3], m[2][3], m[3][3]};
+
+    planes_ = {row_w + row_x, row_w - row_x, row_w + row_y,
+               row_w - row_y, row_w + row_z, row_w - row_z};
+    for (auto& plane : planes_)
+        plane /= glm::length(glm::vec3{plane});
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const {
+    for (const auto& plane : planes_) {
+        if (glm::dot(glm::vec3{plane}, sphere.center) + plane.w <
+            -sphere.radius)
+            return false;
+    }
+    return true;
+}
+
+const std::array<glm::vec4, 6>& Frustum::get_planes() const {
+    return planes_;
+}
+
+} // namespace rg
@@ -0,0 +1,226 @@
+#include <rg/renderer/camera/PostChain.hpp>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace rg {
+
+namespace {
+
+// Must match local_size in bloom.cs.glsl and post.cs.glsl
+constexpr unsigned int GROUP_SIZE = 8;
+// Of the bloom pyramid, the first one at half the size of the surface
+constexpr unsigned int BLOOM_LEVELS = 6;
+// Texels dimmer than this do not bloom
+constexpr float BLOOM_THRESHOLD = 1.0f;
+// Of the bloom added to the scene, summed over the levels
+constexpr float BLOOM_STRENGTH = 0.08f;
+constexpr float EXPOSURE = 1.0f;
+
+// A pass may only sample what an earlier one wrote once it is visible
+void barrier() {
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                    GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+} // namespace
+
+PostChain::PostChain(unsigned int width, unsigned int height)
+        : bloom_texture_{0}, output_texture_{0}, width_{width},
+          height_{height}, levels_{1}, queries_{}, frame_{0} {
+    unsigned int bloom_width = std::max(width / 2, 1U);
+    unsigned int bloom_height = std::max(height / 2, 1U);
+    for (unsigned int size = std::min(bloom_width, bloom_height);
+         size > 1 && levels_ < BLOOM_LEVELS; size /= 2)
+        ++levels_;
+
+    glGenTextures(1, &bloom_texture_);
+    glBindTexture(GL_TEXTURE_2D, bloom_texture_);
+    glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(levels_), GL_RGBA16F,
+                   static_cast<GLsizei>(bloom_width),
+                   static_cast<GLsizei>(bloom_height));
+    // Levels are sampled one at a time, with textureLod
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenTextures(1, &output_texture_);
+    glBindTexture(GL_TEXTURE_2D, output_texture_);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, static_cast<GLsizei>(width),
+                   static_cast<GLsizei>(height));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+PostChain::PostChain(PostChain&& other) noexcept
+        : bloom_texture_{other.bloom_texture_},
+          output_texture_{other.output_texture_}, width_{other.width_},
+          height_{other.height_}, levels_{other.levels_},
+          queries_{other.queries_}, frame_{other.frame_},
+          timings_{other.timings_} {
+    other.bloom_texture_ = 0;
+    other.output_texture_ = 0;
+    other.queries_.fill(0);
+}
+
+PostChain& PostChain::operator=(PostChain&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    release();
+    bloom_texture_ = other.bloom_texture_;
+    output_texture_ = other.output_texture_;
+    width_ = other.width_;
+    height_ = other.height_;
+    levels_ = other.levels_;
+    queries_ = other.queries_;
+    frame_ = other.frame_;
+    timings_ = other.timings_;
+    other.bloom_texture_ = 0;
+    other.output_texture_ = 0;
+    other.queries_.fill(0);
+    return *this;
+}
+
+PostChain::~PostChain() {
+    release();
+}
+
+void PostChain::release() {
+    glDeleteTextures(1, &bloom_texture_);
+    glDeleteTextures(1, &output_texture_);
+    // Names of 0 are ignored
+    glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+    bloom_texture_ = 0;
+    output_texture_ = 0;
+    queries_.fill(0);
+}
+
+void PostChain::apply(const Shader& bloom, const Shader& composite,
+                      unsigned int color_texture) {
+    collect();
+    const unsigned int* queries =
+            &queries_[(frame_ % QUERY_FRAMES) * TIMESTAMPS];
+    glQueryCounter(queries[0], GL_TIMESTAMP);
+
+    // Downsample
+    // ----------
+    // The first level is filtered from the scene and only keeps what is
+    // brighter than the threshold
+    bloom.bind();
+    bloom.set_int("source", 0);
+    bloom.set_int("upsample", false);
+    bloom.set_float("threshold", BLOOM_THRESHOLD);
+    glActiveTexture(GL_TEXTURE0);
+    for (unsigned int level = 0; level < levels_; ++level) {
+        bloom.set_int("prefilter", level == 0);
+        bloom.set_int("source_level",
+                      level == 0 ? 0 : static_cast<int>(level - 1));
+        glBindTexture(GL_TEXTURE_2D,
+                      level == 0 ? color_texture : bloom_texture_);
+        glBindImageTexture(0, bloom_texture_, static_cast<GLint>(level),
+                           GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+        dispatch(std::max((width_ / 2) >> level, 1U),
+                 std::max((height_ / 2) >> level, 1U));
+        barrier();
+    }
+    glQueryCounter(queries[1], GL_TIMESTAMP);
+
+    // Upsample
+    // --------
+    // Each level adds the one below, so that the first holds them all
+    bloom.set_int("upsample", true);
+    bloom.set_int("prefilter", false);
+    glBindTexture(GL_TEXTURE_2D, bloom_texture_);
+    for (unsigned int level = levels_ - 1; level-- > 0;) {
+        bloom.set_int("source_level", static_cast<int>(level + 1));
+        glBindImageTexture(0, bloom_texture_, static_cast<GLint>(level),
+                           GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+        dispatch(std::max((width_ / 2) >> level, 1U),
+                 std::max((height_ / 2) >> level, 1U));
+        barrier();
+    }
+    bloom.unbind();
+    glQueryCounter(queries[2], GL_TIMESTAMP);
+
+    // Composite
+    // ---------
+    // The last upsample, exposure, tonemapping and gamma in one pass
+    composite.bind();
+    composite.set_int("scene", 0);
+    composite.set_int("bloom", 1);
+    composite.set_float("bloom_strength", BLOOM_STRENGTH);
+    composite.set_float("exposure", EXPOSURE);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, color_texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, bloom_texture_);
+    glBindImageTexture(0, output_texture_, 0, GL_FALSE, 0, GL_WRITE_ONLY,
+                       GL_RGBA8);
+    dispatch(width_, height_);
+    // The surface samples the output when it is drawn
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glQueryCounter(queries[3], GL_TIMESTAMP);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    composite.unbind();
+    ++frame_;
+}
+
+// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+void PostChain::dispatch(unsigned int width, unsigned int height) const {
+    glDispatchCompute((width + GROUP_SIZE - 1) / GROUP_SIZE,
+                      (height + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+}
+
+void PostChain::collect() {
+    if (frame_ < QUERY_FRAMES)
+        return;
+
+    const unsigned int* queries =
+            &queries_[(frame_ % QUERY_FRAMES) * TIMESTAMPS];
+    // The timestamps of a frame come back in order
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(queries[TIMESTAMPS - 1], GL_QUERY_RESULT_AVAILABLE,
+                       &available);
+    if (available == GL_FALSE)
+        return;
+
+    std::array<GLuint64, TIMESTAMPS> times{};
+    for (unsigned int i = 0; i < TIMESTAMPS; ++i)
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &times[i]);
+    auto milliseconds = [&times](unsigned int pass) {
+        return static_cast<double>(times[pass + 1] - times[pass]) / 1e6;
+    };
+    timings_.bloom_down = milliseconds(0);
+    timings_.bloom_up = milliseconds(1);
+    timings_.composite = milliseconds(2);
+}
+
+const PostTimings& PostChain::get_timings() const {
+    return timings_;
+}
+
+unsigned int PostChain::get_output_texture() const {
+    return output_texture_;
+}
+
+unsigned int PostChain::get_width() const {
+    return width_;
+}
+
+unsigned int PostChain::get_height() const {
+    return height_;
+}
+
+} // namespace rg
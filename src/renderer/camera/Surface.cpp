@@ -1,5 +1,6 @@
 #include <rg/renderer/camera/Surface.hpp>
 
+#include <glad/glad.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <memory>
 #include <rg/util/common_meshes.hpp>
@@ -7,18 +8,13 @@
 namespace rg {
 
 Surface::Surface(unsigned int width, unsigned int height)
-        : fb_{width, height}, quad_{util::surfaceQuad(),
-                                    {std::make_shared<Texture>(
-                                            fb_.get_color_texture(),
-                                            TextureType::DIFFUSE)}} {
+        : fb_{width, height}, post_{width, height},
+          quad_{util::surfaceQuad()} {
 }
 
 Surface::Surface(unsigned int width, unsigned int height,
                  std::shared_ptr<MeshVertexData> quad)
-        : fb_{width, height}, quad_{std::move(quad),
-                                    {std::make_shared<Texture>(
-                                            fb_.get_color_texture(),
-                                            TextureType::DIFFUSE)}} {
+        : fb_{width, height}, post_{width, height}, quad_{std::move(quad)} {
 }
 
 void Surface::draw(const Shader& shader,
@@ -26,16 +22,26 @@ void Surface::draw(const Shader& shader,
     shader.bind();
     shader.set("model", directives.get_model_matrix());
     shader.set("tex", directives.get_texture_matrix());
-    fb_.blit();
-    quad_.draw(shader);
+    drawQuad(shader);
 }
 
 void Surface::draw(const Shader& shader) const {
     shader.bind();
     shader.set("model", glm::mat4{1.0f});
     shader.set("tex", glm::mat4{1.0f});
-    fb_.blit();
-    quad_.draw(shader);
+    drawQuad(shader);
+}
+
+void Surface::drawQuad(const Shader& shader) const {
+    glActiveTexture(GL_TEXTURE0);
+    shader.set_int("material.texture_diffuse1", 0);
+    glBindTexture(GL_TEXTURE_2D, post_.get_output_texture());
+    quad_->vertex_array.bind();
+    quad_->index_buffer.bind();
+    glDrawElements(GL_TRIANGLES, quad_->index_buffer.count(),
+                   quad_->index_buffer.type(), nullptr);
+    quad_->vertex_array.unbind();
+    quad_->index_buffer.unbind();
 }
 
 void Surface::bind() const {
@@ -46,6 +52,27 @@ void Surface::unbind() const {
     fb_.unbind();
 }
 
+void Surface::resolve(const Shader& bloom, const Shader& composite) {
+    fb_.blit();
+    post_.apply(bloom, composite, fb_.get_color_texture());
+}
+
+unsigned int Surface::get_depth_texture() const {
+    return fb_.get_depth_texture();
+}
+
+const PostChain& Surface::get_post_chain() const {
+    return post_;
+}
+
+unsigned int Surface::get_width() const {
+    return fb_.get_width();
+}
+
+unsigned int Surface::get_height() const {
+    return fb_.get_height();
+}
+
 glm::mat4 Surface::ScreenDirectives::get_model_matrix() const {
     glm::mat4 model{1.0f};
     model = glm::translate(model, glm::vec3{origin.x, origin.y, 0.0f});
@@ -0,0 +1,119 @@
+#include <rg/renderer/command/CommandBuffer.hpp>
+
+namespace rg {
+
+void CommandBuffer::clear() {
+    commands_.clear();
+    data_.clear();
+}
+
+void CommandBuffer::bind_program(std::uint32_t program) {
+    Command command{CommandType::BIND_PROGRAM, {}};
+    command.bind_program = {program};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::bind_vertex_array(std::uint32_t vertex_array) {
+    Command command{CommandType::BIND_VERTEX_ARRAY, {}};
+    command.bind_vertex_array = {vertex_array};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::bind_texture(std::uint32_t unit, std::uint32_t texture,
+                                 std::uint32_t target) {
+    Command command{CommandType::BIND_TEXTURE, {}};
+    command.bind_texture = {unit, texture, target};
+    commands_.push_back(command);
+}
+
+std::uint32_t CommandBuffer::bind_storage(std::uint32_t binding,
+                                         std::size_t size) {
+    // Growing the data value-initializes it, so the range is zeroed
+    std::size_t offset = allocateData(size);
+
+    Command command{CommandType::BIND_STORAGE_RANGE, {}};
+    command.bind_storage_range = {binding, static_cast<std::uint32_t>(offset),
+                                  static_cast<std::uint32_t>(size)};
+    commands_.push_back(command);
+    return static_cast<std::uint32_t>(offset);
+}
+
+void CommandBuffer::draw_elements(std::uint32_t count, std::uint32_t first,
+                                  std::int32_t base_vertex) {
+    Command command{CommandType::DRAW_ELEMENTS, {}};
+    command.draw_elements = {count, first, base_vertex};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::draw_elements_instanced(std::uint32_t count,
+                                            std::uint32_t instances,
+                                            std::uint32_t first,
+                                            std::int32_t base_vertex,
+                                            std::uint32_t base_instance) {
+    Command command{CommandType::DRAW_ELEMENTS_INSTANCED, {}};
+    command.draw_elements_instanced = {count, first, base_vertex, instances,
+                                       base_instance};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::multi_draw_elements_indirect(
+        const DrawElementsIndirectCommand* draws, std::size_t count) {
+    if (count == 0)
+        return;
+
+    std::size_t size = count * sizeof(DrawElementsIndirectCommand);
+    std::size_t offset = allocateData(size);
+    std::memcpy(data_.data() + offset, draws, size);
+
+    Command command{CommandType::MULTI_DRAW_ELEMENTS_INDIRECT, {}};
+    command.multi_draw_elements_indirect = {
+            static_cast<std::uint32_t>(offset),
+            static_cast<std::uint32_t>(count)};
+    commands_.push_back(command);
+}
+
+const std::vector<Command>& CommandBuffer::commands() const {
+    return commands_;
+}
+
+void CommandBuffer::multi_draw_elements_indirect_count(
+        std::uint32_t offset, std::uint32_t count_offset,
+        std::uint32_t max_count) {
+    if (max_count == 0)
+        return;
+
+    Command command{CommandType::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT, {}};
+    command.multi_draw_elements_indirect_count = {offset, count_offset,
+                                                  max_count};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::dispatch_compute(std::uint32_t groups_x,
+                                     std::uint32_t groups_y,
+                                     std::uint32_t groups_z) {
+    if (groups_x == 0 || groups_y == 0 || groups_z == 0)
+        return;
+
+    Command command{CommandType::DISPATCH_COMPUTE, {}};
+    command.dispatch_compute = {groups_x, groups_y, groups_z};
+    commands_.push_back(command);
+}
+
+void CommandBuffer::memory_barrier(std::uint32_t barriers) {
+    Command command{CommandType::MEMORY_BARRIER, {}};
+    command.memory_barrier = {barriers};
+    commands_.push_back(command);
+}
+
+const std::vector<std::byte>& CommandBuffer::data() const {
+    return data_;
+}
+
+std::size_t CommandBuffer::allocateData(std::size_t size) {
+    std::size_t offset =
+            (data_.size() + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+    data_.resize(offset + size);
+    return offset;
+}
+
+} // namespace rg
@@ -0,0 +1,161 @@
+#include <rg/renderer/command/CommandSubmitter.hpp>
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+
+namespace rg {
+
+CommandSubmitter::CommandSubmitter() : buffer_id_{0}, capacity_{0} {
+    glGenBuffers(1, &buffer_id_);
+}
+
+CommandSubmitter::CommandSubmitter(CommandSubmitter&& other) noexcept
+        : buffer_id_{other.buffer_id_},
+          capacity_{other.capacity_} {
+    other.buffer_id_ = 0;
+    other.capacity_ = 0;
+}
+
+CommandSubmitter&
+CommandSubmitter::operator=(CommandSubmitter&& other) noexcept {
+    glDeleteBuffers(1, &buffer_id_);
+    buffer_id_ = other.buffer_id_;
+    capacity_ = other.capacity_;
+    other.buffer_id_ = 0;
+    other.capacity_ = 0;
+    return *this;
+}
+
+CommandSubmitter::~CommandSubmitter() {
+    glDeleteBuffers(1, &buffer_id_);
+}
+
+void CommandSubmitter::submit(const CommandBuffer& commands) {
+    // Upload
+    // ------
+    // Orphaning the storage lets the driver hand out fresh memory instead
+    // of waiting for the draws of the previous submission.
+    // The indirect and parameter bindings stay for the replay.
+    const auto& data = commands.data();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer_id_);
+    glBindBuffer(GL_PARAMETER_BUFFER, buffer_id_);
+    if (data.size() > capacity_)
+        capacity_ = data.size() * 2;
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(capacity_),
+                 nullptr, GL_STREAM_DRAW);
+    if (!data.empty())
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0,
+                        static_cast<GLsizeiptr>(data.size()), data.data());
+
+    // Replay
+    // ------
+    // Nothing is assumed about the state bound before the submission. The
+    // draws index a GeometryArena, with 16-bit indices.
+    constexpr std::uint32_t UNKNOWN = ~0U;
+    std::uint32_t program = UNKNOWN;
+    std::uint32_t vertex_array = UNKNOWN;
+    std::array<std::uint32_t, 16> textures{};
+    textures.fill(UNKNOWN);
+    for (const auto& command : commands.commands()) {
+        switch (command.type) {
+            case CommandType::BIND_PROGRAM: {
+                const auto& c = command.bind_program;
+                if (c.program != program)
+                    glUseProgram(c.program);
+                program = c.program;
+                break;
+            }
+            case CommandType::BIND_UNIFORM_RANGE: {
+                const auto& c = command.bind_uniform_range;
+                glBindBufferRange(GL_UNIFORM_BUFFER, c.binding,
+                                  buffer_id_, c.offset, c.size);
+                break;
+            }
+            case CommandType::BIND_STORAGE_RANGE: {
+                const auto& c = command.bind_storage_range;
+                // Empty ranges are an error, and nothing reads them
+                if (c.size > 0)
+                    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, c.binding,
+                                      buffer_id_, c.offset, c.size);
+                break;
+            }
+            case CommandType::BIND_VERTEX_ARRAY: {
+                const auto& c = command.bind_vertex_array;
+                if (c.vertex_array != vertex_array)
+                    glBindVertexArray(c.vertex_array);
+                vertex_array = c.vertex_array;
+                break;
+            }
+            case CommandType::BIND_TEXTURE: {
+                const auto& c = command.bind_texture;
+                if (c.unit < textures.size() && textures[c.unit] == c.texture)
+                    break;
+                glActiveTexture(GL_TEXTURE0 + c.unit);
+                glBindTexture(c.target, c.texture);
+                if (c.unit < textures.size())
+                    textures[c.unit] = c.texture;
+                break;
+            }
+            case CommandType::DRAW_ELEMENTS: {
+                const auto& c = command.draw_elements;
+                glDrawElementsBaseVertex(
+                        GL_TRIANGLES, static_cast<GLsizei>(c.count),
+                        GL_UNSIGNED_SHORT,
+                        reinterpret_cast<const void*>(
+                                c.first * sizeof(std::uint16_t)),
+                        c.base_vertex);
+                break;
+            }
+            case CommandType::DRAW_ELEMENTS_INSTANCED: {
+                const auto& c = command.draw_elements_instanced;
+                glDrawElementsInstancedBaseVertexBaseInstance(
+                        GL_TRIANGLES, static_cast<GLsizei>(c.count),
+                        GL_UNSIGNED_SHORT,
+                        reinterpret_cast<const void*>(
+                                c.first * sizeof(std::uint16_t)),
+                        static_cast<GLsizei>(c.instances), c.base_vertex,
+                        c.base_instance);
+                break;
+            }
+            case CommandType::MULTI_DRAW_ELEMENTS_INDIRECT: {
+                const auto& c = command.multi_draw_elements_indirect;
+                glMultiDrawElementsIndirect(
+                        GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                        reinterpret_cast<const void*>(
+                                static_cast<std::uintptr_t>(c.offset)),
+                        static_cast<GLsizei>(c.count), 0);
+                break;
+            }
+            case CommandType::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT: {
+                const auto& c = command.multi_draw_elements_indirect_count;
+                glMultiDrawElementsIndirectCount(
+                        GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                        reinterpret_cast<const void*>(
+                                static_cast<std::uintptr_t>(c.offset)),
+                        static_cast<GLintptr>(c.count_offset),
+                        static_cast<GLsizei>(c.max_count), 0);
+                break;
+            }
+            case CommandType::DISPATCH_COMPUTE: {
+                const auto& c = command.dispatch_compute;
+                glDispatchCompute(c.groups_x, c.groups_y, c.groups_z);
+                break;
+            }
+            case CommandType::MEMORY_BARRIER: {
+                const auto& c = command.memory_barrier;
+                glMemoryBarrier(c.barriers);
+                break;
+            }
+        }
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+}
+
+} // namespace rg
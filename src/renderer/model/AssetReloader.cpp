@@ -0,0 +1,153 @@
+#include <rg/renderer/model/AssetReloader.hpp>
+
+#include <rg/util/FileLoader.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace rg {
+
+namespace {
+
+template <class T>
+bool isReady(const std::future<T>& future) {
+    return future.wait_for(std::chrono::seconds{0}) ==
+           std::future_status::ready;
+}
+
+std::string parentOf(const std::string& path) {
+    return path.substr(0, path.find_last_of('/'));
+}
+
+bool endsWith(const std::string& string, const std::string& suffix) {
+    return string.size() >= suffix.size() &&
+           string.compare(string.size() - suffix.size(), suffix.size(),
+                          suffix) == 0;
+}
+
+} // namespace
+
+AssetReloader::AssetReloader(std::string directory, GeometryArena& arena,
+                             MaterialLibrary& library, JobSystem* jobs)
+        : directory_{std::move(directory)}, watcher_{directory_},
+          arena_{arena}, library_{library}, jobs_{jobs}, models_{},
+          imports_{}, decodes_{} {
+}
+
+void AssetReloader::watch(Model& model) {
+    models_.push_back(&model);
+}
+
+void AssetReloader::update() {
+    commit();
+
+    auto changed = watcher_.poll();
+    if (!changed.empty())
+        start(changed);
+}
+
+void AssetReloader::commit() {
+    // Textures first, so that reloaded models find them decoded
+    for (auto it = decodes_.begin(); it != decodes_.end();) {
+        const auto& decodes = **it;
+        if (!decodes.counter.done()) {
+            ++it;
+            continue;
+        }
+        for (std::size_t i = 0; i < decodes.paths.size(); ++i) {
+            if (!decodes.images[i])
+                continue;
+            library_.reload(decodes.paths[i], *decodes.images[i]);
+            spdlog::info("RG::ASSET_RELOADER: Reloaded \"{}\"",
+                         decodes.paths[i]);
+        }
+        it = decodes_.erase(it);
+    }
+
+    for (auto it = imports_.begin(); it != imports_.end();) {
+        if (!isReady(it->data)) {
+            ++it;
+            continue;
+        }
+        ModelData data = it->data.get();
+        if (data.valid) {
+            it->model->reload(data, arena_, library_);
+            spdlog::info("RG::ASSET_RELOADER: Reloaded \"{}\"",
+                         it->model->get_path());
+        } else {
+            spdlog::error("RG::ASSET_RELOADER: Keeping the previous \"{}\"",
+                          it->model->get_path());
+        }
+        it = imports_.erase(it);
+    }
+}
+
+void AssetReloader::start(const std::vector<std::string>& changed) {
+    // The resource pack was built before the edits
+    util::ResourcePack::unmount();
+
+    auto decodes = std::make_unique<Decodes>();
+    std::vector<Model*> affected;
+    for (const auto& file : changed) {
+        std::string path = directory_ + "/" + file;
+
+        if (library_.contains(path))
+            decodes->paths.push_back(path);
+
+        // Materials are read along with the model, so a changed .mtl
+        // reloads the models next to it
+        bool material = endsWith(path, ".mtl");
+        for (Model* model : models_) {
+            const auto& model_path = model->get_path();
+            if (model_path == path ||
+                (material && parentOf(model_path) == parentOf(path)))
+                affected.push_back(model);
+        }
+    }
+
+    if (!decodes->paths.empty())
+        decodeTextures(std::move(decodes));
+
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()),
+                   affected.end());
+    for (Model* model : affected) {
+        const auto& path = model->get_path();
+        imports_.push_back(Import{
+                model, std::async(std::launch::async,
+                                  [path] { return Model::import(path); })});
+    }
+}
+
+void AssetReloader::decodeTextures(std::unique_ptr<Decodes> decodes) {
+    auto& images = decodes->images;
+    images.resize(decodes->paths.size());
+    std::vector<util::FileJob> files;
+    for (std::size_t i = 0; i < decodes->paths.size(); ++i) {
+        const auto& path = decodes->paths[i];
+        files.push_back(util::FileJob{
+                path,
+                [&images, i, path](std::optional<std::string_view> contents) {
+                    images[i] = MaterialLibrary::decode(path, contents);
+                },
+                &decodes->counter});
+    }
+
+    // The batch is read by a job too, so that frames go on meanwhile.
+    // Without workers a job would only run once something waits on it.
+    if (jobs_ == nullptr || jobs_->worker_count() == 0)
+        util::FileLoader::shared().submit(std::move(files), jobs_);
+    else
+        jobs_->run(
+                [files = std::move(files), jobs = jobs_]() mutable {
+                    util::FileLoader::shared().submit(std::move(files), jobs);
+                },
+                decodes->counter);
+    decodes_.push_back(std::move(decodes));
+}
+
+} // namespace rg
@@ -0,0 +1,18 @@
+#include <rg/renderer/model/BoundingSphere.hpp>
+
+#include <glm/geometric.hpp>
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+
+namespace rg {
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4& model) const {
+    float sx = glm::length(glm::vec3{model[0]});
+    float sy = glm::length(glm::vec3{model[1]});
+    float sz = glm::length(glm::vec3{model[2]});
+    return BoundingSphere{glm::vec3{model * glm::vec4{center, 1.0f}},
+                          radius * std::max({sx, sy, sz})};
+}
+
+} // namespace rg
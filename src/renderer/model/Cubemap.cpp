@@ -1,40 +1,114 @@
 #include <rg/renderer/model/Cubemap.hpp>
 
+#include <rg/util/FileLoader.hpp>
+
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 #include <stb/stb_image.h>
 
-#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <string_view>
 
 namespace rg {
 
-Cubemap::Cubemap(const std::string& path, const std::vector<std::string>& faces)
+namespace {
+
+// RGB, and empty if the file could not be decoded
+struct Face {
+    int width = 0;
+    int height = 0;
+    unsigned char* pixels = nullptr;
+};
+
+Face decode(const std::string& path,
+            std::optional<std::string_view> contents) {
+    Face face;
+    int channels;
+    if (contents)
+        face.pixels = stbi_load_from_memory(
+                reinterpret_cast<const stbi_uc*>(contents->data()),
+                static_cast<int>(contents->size()), &face.width,
+                &face.height, &channels, 3);
+    if (face.pixels == nullptr)
+        spdlog::error("STBI::ERROR::CUBEMAP: Failed to load 2D texture at: {}",
+                      path);
+    return face;
+}
+
+} // namespace
+
+Cubemap::Cubemap(const std::string& path, const std::vector<std::string>& faces,
+                 JobSystem* jobs)
         : texture_id_{0} {
+    auto start = std::chrono::steady_clock::now();
+
+    // Decoding
+    // --------
+    // The faces are read in one batch, and each is decoded by a job as soon
+    // as its read completes
+    std::vector<Face> decoded(faces.size());
+    JobCounter counter;
+    std::vector<util::FileJob> files;
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        std::string face_path = path + faces[i];
+        files.push_back(util::FileJob{
+                face_path,
+                [&decoded, i, face_path](
+                        std::optional<std::string_view> contents) {
+                    decoded[i] = decode(face_path, contents);
+                },
+                &counter});
+    }
+    util::FileLoader::shared().submit(std::move(files), jobs);
+    if (jobs != nullptr)
+        jobs->wait(counter);
+
+    // Upload
+    // ------
+    // Immutable storage, sized by the first face which could be decoded
     glGenTextures(1, &texture_id_);
     glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id_);
-
-    for (unsigned int i = 0; i < faces.size(); ++i) {
-        int width, height, channels;
-        unsigned char* data = nullptr;
-
-        std::string full_path = path + faces[i];
-        data = stbi_load(full_path.c_str(), &width, &height, &channels, 3);
-        if (!data) {
-            spdlog::error(
-                    "STBI::ERROR::CUBEMAP: Failed to load 2D texture at: {}",
-                    full_path);
-        } else {
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB8, width,
-                         height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    auto first = std::find_if(decoded.begin(), decoded.end(),
+                              [](const Face& face) {
+                                  return face.pixels != nullptr;
+                              });
+    if (first != decoded.end()) {
+        int width = first->width;
+        int height = first->height;
+        // Sampled as linear colors, which the post chain encodes again
+        glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_SRGB8, width, height);
+        // Rows of RGB texels are not 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (unsigned int i = 0; i < decoded.size(); ++i) {
+            const auto& face = decoded[i];
+            if (face.pixels == nullptr)
+                continue;
+            if (face.width != width || face.height != height) {
+                spdlog::error("RG::CUBEMAP: \"{}\" is {}x{}, not {}x{}",
+                              path + faces[i], face.width, face.height,
+                              width, height);
+                continue;
+            }
+            glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, 0, 0, width,
+                            height, GL_RGB, GL_UNSIGNED_BYTE, face.pixels);
         }
-        stbi_image_free(data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     }
+    for (auto& face : decoded)
+        stbi_image_free(face.pixels);
 
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+    spdlog::info("RG::CUBEMAP: \"{}\" ready in {:.1f} ms", path,
+                 elapsed.count());
 }
 
 Cubemap::Cubemap() : texture_id_{0} {
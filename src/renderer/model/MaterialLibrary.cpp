@@ -0,0 +1,777 @@
+#include <rg/renderer/model/MaterialLibrary.hpp>
+
+#include <rg/renderer/shader/UniformBlocks.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <glad/glad.h>
+#include <spdlog/spdlog.h>
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace rg {
+
+namespace {
+
+// Every image is expanded to RGBA when loading
+constexpr unsigned int FORMAT = GL_RGBA8;
+constexpr std::size_t TEXEL_SIZE = 4;
+constexpr std::uint32_t INITIAL_LAYERS = 4;
+// Streamed layers show this until their pixels arrive
+constexpr std::array<unsigned char, 4> PLACEHOLDER{128, 128, 128, 255};
+constexpr std::size_t DEFAULT_BUDGET = std::size_t{256} << 20U;
+
+bool imageInfo(const std::string& path, int& width, int& height,
+               int& num_channels) {
+    if (auto packed = util::ResourcePack::lookup(path))
+        return stbi_info_from_memory(
+                       reinterpret_cast<const stbi_uc*>(packed->data()),
+                       static_cast<int>(packed->size()), &width, &height,
+                       &num_channels) != 0;
+    return stbi_info(path.c_str(), &width, &height, &num_channels) != 0;
+}
+
+unsigned int levelCount(unsigned int width, unsigned int height) {
+    unsigned int levels = 1;
+    for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+        ++levels;
+    return levels;
+}
+
+// The most top levels which can be dropped while the top resident level
+// stays at least size texels along its larger side
+unsigned int droppedFor(unsigned int width, unsigned int height,
+                        unsigned int levels, unsigned int size) {
+    unsigned int top = std::max(width, height);
+    unsigned int dropped = 0;
+    while (dropped + 1 < levels && (top >> (dropped + 1)) >= size)
+        ++dropped;
+    return dropped;
+}
+
+std::uint64_t pack(TextureSlot slot) {
+    return (std::uint64_t{slot.array} << 32U) | slot.layer;
+}
+
+// Halve the image, averaging each 2x2 block of texels
+MaterialLibrary::Image halved(const MaterialLibrary::Image& image) {
+    MaterialLibrary::Image result{std::max(image.width / 2, 1U),
+                                  std::max(image.height / 2, 1U), {}};
+    result.pixels.resize(std::size_t{result.width} * result.height *
+                         TEXEL_SIZE);
+
+    std::size_t stride = std::size_t{image.width} * TEXEL_SIZE;
+    auto* out = result.pixels.data();
+    for (unsigned int y = 0; y < result.height; ++y) {
+        const auto* row0 = image.pixels.data() +
+                           std::min(y * 2, image.height - 1) * stride;
+        const auto* row1 = image.pixels.data() +
+                           std::min(y * 2 + 1, image.height - 1) * stride;
+        for (unsigned int x = 0; x < result.width; ++x) {
+            std::size_t x0 = std::min(x * 2, image.width - 1) * TEXEL_SIZE;
+            std::size_t x1 = std::min(x * 2 + 1, image.width - 1) * TEXEL_SIZE;
+            for (std::size_t c = 0; c < TEXEL_SIZE; ++c) {
+                unsigned int sum = row0[x0 + c] + row0[x1 + c] +
+                                   row1[x0 + c] + row1[x1 + c];
+                *out++ = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+MaterialLibrary::Image scaledDown(MaterialLibrary::Image image,
+                                  unsigned int levels) {
+    for (unsigned int i = 0; i < levels; ++i)
+        image = halved(image);
+    return image;
+}
+
+// Raise the atomic to the value, if it is lower
+void raise(std::atomic<std::uint32_t>& atomic, std::uint32_t value) {
+    std::uint32_t current = atomic.load(std::memory_order_relaxed);
+    while (current < value &&
+           !atomic.compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed))
+        ;
+}
+
+void clearLayer(unsigned int texture_id, unsigned int width,
+                unsigned int height, std::uint32_t layer) {
+    glClearTexSubImage(texture_id, 0, 0, 0, static_cast<GLint>(layer),
+                       static_cast<GLsizei>(width),
+                       static_cast<GLsizei>(height), 1, GL_RGBA,
+                       GL_UNSIGNED_BYTE, PLACEHOLDER.data());
+}
+
+} // namespace
+
+unsigned int MaterialLibrary::TextureArray::resident_width() const {
+    return std::max(width >> dropped, 1U);
+}
+
+unsigned int MaterialLibrary::TextureArray::resident_height() const {
+    return std::max(height >> dropped, 1U);
+}
+
+std::size_t
+MaterialLibrary::TextureArray::bytes(unsigned int dropped_levels) const {
+    std::size_t texels = 0;
+    for (unsigned int level = dropped_levels; level < levels; ++level)
+        texels += std::size_t{std::max(width >> level, 1U)} *
+                  std::max(height >> level, 1U);
+    return texels * TEXEL_SIZE * capacity;
+}
+
+MaterialLibrary::MaterialLibrary(UploadRing* ring, JobSystem* jobs)
+        : arrays_{}, array_indices_{}, loaded_{}, materials_{},
+          material_indices_{}, materials_changed_{false}, buffer_id_{0},
+          white_{}, black_{}, ring_{ring}, jobs_{jobs}, streams_{}, wanted_{},
+          promotions_{}, reads_{}, queued_{},
+          residency_{0, 0, DEFAULT_BUDGET}, frame_{0} {
+    glGenBuffers(1, &buffer_id_);
+
+    white_ = addLayer(Image{1, 1, {255, 255, 255, 255}}, {});
+    black_ = addLayer(Image{1, 1, {0, 0, 0, 255}}, {});
+    // Material 0 is the one of meshes without textures
+    add(Material{white_, black_, 0});
+}
+
+MaterialLibrary::MaterialLibrary(MaterialLibrary&& other) noexcept
+        : arrays_{std::move(other.arrays_)},
+          array_indices_{std::move(other.array_indices_)},
+          loaded_{std::move(other.loaded_)},
+          materials_{std::move(other.materials_)},
+          material_indices_{std::move(other.material_indices_)},
+          materials_changed_{other.materials_changed_},
+          buffer_id_{other.buffer_id_}, white_{other.white_},
+          black_{other.black_}, ring_{other.ring_}, jobs_{other.jobs_},
+          streams_{std::move(other.streams_)},
+          wanted_{std::move(other.wanted_)},
+          promotions_{std::move(other.promotions_)},
+          reads_{std::move(other.reads_)}, queued_{std::move(other.queued_)},
+          residency_{other.residency_}, frame_{other.frame_} {
+    other.arrays_.clear();
+    other.promotions_.clear();
+    other.buffer_id_ = 0;
+}
+
+MaterialLibrary& MaterialLibrary::operator=(MaterialLibrary&& other) noexcept {
+    release();
+    arrays_ = std::move(other.arrays_);
+    array_indices_ = std::move(other.array_indices_);
+    loaded_ = std::move(other.loaded_);
+    materials_ = std::move(other.materials_);
+    material_indices_ = std::move(other.material_indices_);
+    materials_changed_ = other.materials_changed_;
+    buffer_id_ = other.buffer_id_;
+    white_ = other.white_;
+    black_ = other.black_;
+    ring_ = other.ring_;
+    jobs_ = other.jobs_;
+    streams_ = std::move(other.streams_);
+    wanted_ = std::move(other.wanted_);
+    promotions_ = std::move(other.promotions_);
+    reads_ = std::move(other.reads_);
+    queued_ = std::move(other.queued_);
+    residency_ = other.residency_;
+    frame_ = other.frame_;
+    other.arrays_.clear();
+    other.promotions_.clear();
+    other.buffer_id_ = 0;
+    return *this;
+}
+
+MaterialLibrary::~MaterialLibrary() {
+    release();
+}
+
+void MaterialLibrary::release() {
+    for (auto& array : arrays_)
+        glDeleteTextures(1, &array.texture_id);
+    arrays_.clear();
+    for (auto& promotion : promotions_)
+        glDeleteTextures(1, &promotion.texture_id);
+    promotions_.clear();
+    glDeleteBuffers(1, &buffer_id_);
+    buffer_id_ = 0;
+}
+
+bool MaterialLibrary::Decodes::done() const {
+    return !queued && (reads == nullptr || reads->done()) && counter.done();
+}
+
+std::optional<MaterialLibrary::Image>
+MaterialLibrary::decode(const std::string& path) {
+    // A batch of one, handed over on this thread
+    std::optional<Image> image;
+    std::vector<util::FileJob> file;
+    file.push_back(util::FileJob{
+            path,
+            [&image, &path](std::optional<std::string_view> contents) {
+                image = decode(path, contents);
+            },
+            nullptr});
+    util::FileLoader::shared().submit(std::move(file), nullptr);
+    return image;
+}
+
+std::optional<MaterialLibrary::Image>
+MaterialLibrary::decode(const std::string& path,
+                        std::optional<std::string_view> contents) {
+    int width, height, num_channels;
+    stbi_uc* data = nullptr;
+    if (contents)
+        data = stbi_load_from_memory(
+                reinterpret_cast<const stbi_uc*>(contents->data()),
+                static_cast<int>(contents->size()), &width, &height,
+                &num_channels, 4);
+    if (data == nullptr) {
+        spdlog::error("RG::MATERIAL_LIBRARY: Failed to load texture at path "
+                      "\"{}\"",
+                      path);
+        return std::nullopt;
+    }
+
+    Image image{static_cast<unsigned int>(width),
+                static_cast<unsigned int>(height), {}};
+    std::size_t size = std::size_t{image.width} * image.height * TEXEL_SIZE;
+    image.pixels.assign(data, data + size);
+    stbi_image_free(data);
+    return image;
+}
+
+MaterialLibrary::Stream
+MaterialLibrary::startStream(TextureSlot slot, const std::string& path,
+                             const TextureArray& array) {
+    Stream stream{slot, std::make_unique<Decodes>()};
+    stream.decodes->layers.resize(1);
+    startDecode(*stream.decodes, 0, path, array);
+    return stream;
+}
+
+void MaterialLibrary::startDecode(Decodes& decodes, std::size_t layer,
+                                  std::string path,
+                                  const TextureArray& array) {
+    unsigned int width = array.width;
+    unsigned int height = array.height;
+    unsigned int dropped = array.dropped;
+    auto decoded = [ring = ring_, &decodes, layer, path, width, height,
+                    dropped](std::optional<std::string_view> contents) {
+        auto image = decode(path, contents);
+        if (!image)
+            return;
+        if (image->width != width || image->height != height) {
+            spdlog::error("RG::MATERIAL_LIBRARY: \"{}\" changed size while "
+                          "streaming",
+                          path);
+            return;
+        }
+
+        Image scaled = scaledDown(std::move(*image), dropped);
+        Pixels pixels{scaled.width, scaled.height, std::nullopt, {}};
+        if (ring != nullptr)
+            pixels.region = ring->allocate(scaled.pixels.size());
+        if (pixels.region)
+            std::memcpy(pixels.region->data, scaled.pixels.data(),
+                        scaled.pixels.size());
+        else
+            pixels.fallback = std::move(scaled.pixels);
+        decodes.layers[layer] = std::move(pixels);
+    };
+
+    reads_.push_back(util::FileJob{std::move(path), std::move(decoded),
+                                   &decodes.counter});
+    if (!decodes.queued)
+        queued_.push_back(&decodes);
+    decodes.queued = true;
+}
+
+void MaterialLibrary::submitReads() {
+    if (reads_.empty())
+        return;
+
+    auto reads = std::make_shared<JobCounter>();
+    for (Decodes* decodes : queued_) {
+        decodes->queued = false;
+        decodes->reads = reads;
+    }
+    queued_.clear();
+
+    // Without workers a job would only run once something waits on it
+    auto files = std::move(reads_);
+    reads_.clear();
+    if (jobs_ == nullptr || jobs_->worker_count() == 0) {
+        util::FileLoader::shared().submit(std::move(files), jobs_);
+        return;
+    }
+    jobs_->run(
+            [files = std::move(files), jobs = jobs_]() mutable {
+                util::FileLoader::shared().submit(std::move(files), jobs);
+            },
+            *reads);
+}
+
+std::optional<TextureSlot> MaterialLibrary::load(const std::string& path) {
+    auto it = loaded_.find(path);
+    if (it != loaded_.end())
+        return it->second;
+
+    auto image = decode(path);
+    if (!image)
+        return std::nullopt;
+
+    TextureSlot slot = addLayer(*image, path);
+    loaded_.emplace(path, slot);
+    return slot;
+}
+
+std::optional<TextureSlot> MaterialLibrary::stream(const std::string& path) {
+    auto it = loaded_.find(path);
+    if (it != loaded_.end())
+        return it->second;
+
+    int width, height, num_channels;
+    if (!imageInfo(path, width, height, num_channels)) {
+        spdlog::error("RG::MATERIAL_LIBRARY: Failed to load texture at path "
+                      "\"{}\"",
+                      path);
+        return std::nullopt;
+    }
+
+    TextureSlot slot = reserveLayer(static_cast<unsigned int>(width),
+                                    static_cast<unsigned int>(height), path);
+    loaded_.emplace(path, slot);
+    auto& array = arrays_[slot.array];
+    clearLayer(array.texture_id, array.resident_width(),
+               array.resident_height(), slot.layer);
+    array.dirty = true;
+
+    streams_.push_back(startStream(slot, path, array));
+    return slot;
+}
+
+void MaterialLibrary::request(std::uint32_t material, unsigned int size) {
+    const auto& textures = materials_[material];
+    raise(wanted_[textures.diffuse.array], size);
+    raise(wanted_[textures.specular.array], size);
+}
+
+void MaterialLibrary::set_budget(std::size_t bytes) {
+    residency_.budget = bytes;
+}
+
+bool MaterialLibrary::contains(const std::string& path) const {
+    return loaded_.find(path) != loaded_.end();
+}
+
+void MaterialLibrary::reload(const std::string& path, const Image& image) {
+    auto it = loaded_.find(path);
+    if (it == loaded_.end())
+        return;
+
+    TextureSlot old_slot = it->second;
+    auto& array = arrays_[old_slot.array];
+    if (array.width == image.width && array.height == image.height) {
+        Image scaled = scaledDown(image, array.dropped);
+        upload(array.texture_id, old_slot.layer,
+               Pixels{scaled.width, scaled.height, std::nullopt,
+                      std::move(scaled.pixels)});
+        // A promotion under way may have read the old file
+        ++array.generation;
+        return;
+    }
+
+    TextureSlot slot = addLayer(image, path);
+    it->second = slot;
+    materials_changed_ = true;
+    material_indices_.clear();
+    for (std::uint32_t i = 0; i < materials_.size(); ++i) {
+        auto& material = materials_[i];
+        if (pack(material.diffuse) == pack(old_slot))
+            material.diffuse = slot;
+        if (pack(material.specular) == pack(old_slot))
+            material.specular = slot;
+        material_indices_.try_emplace(MaterialKey{pack(material.diffuse),
+                                                  pack(material.specular),
+                                                  material.features},
+                                      i);
+    }
+}
+
+std::uint32_t MaterialLibrary::add(const Material& material) {
+    MaterialKey key{pack(material.diffuse), pack(material.specular),
+                    material.features};
+    auto [it, inserted] = material_indices_.try_emplace(
+            key, static_cast<std::uint32_t>(materials_.size()));
+    if (inserted) {
+        materials_.push_back(material);
+        materials_changed_ = true;
+    }
+    return it->second;
+}
+
+void MaterialLibrary::update() {
+    finishStreams();
+    finishPromotions();
+    balance();
+    // Of the streams, the restarted ones and the promotions
+    submitReads();
+
+    for (auto& array : arrays_) {
+        if (!array.dirty)
+            continue;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array.texture_id);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        array.dirty = false;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (ring_ != nullptr) {
+        ring_->fence();
+        ring_->reclaim();
+    }
+
+    if (!materials_changed_)
+        return;
+    materials_changed_ = false;
+
+    std::vector<MaterialData> data;
+    data.reserve(materials_.size());
+    for (const auto& material : materials_)
+        data.push_back(
+                MaterialData{material.diffuse.layer, material.specular.layer});
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_id_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 static_cast<GLsizeiptr>(data.size() * sizeof(MaterialData)),
+                 data.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void MaterialLibrary::finishStreams() {
+    std::vector<Stream> restarted;
+    for (auto it = streams_.begin(); it != streams_.end();) {
+        if (!it->decodes->done()) {
+            ++it;
+            continue;
+        }
+
+        // A failed image leaves its layer grey
+        auto& pixels = it->decodes->layers[0];
+        auto& array = arrays_[it->slot.array];
+        if (pixels && (pixels->width != array.resident_width() ||
+                       pixels->height != array.resident_height())) {
+            // The resident levels changed while it was decoded
+            if (pixels->region)
+                ring_->retire(*pixels->region);
+            restarted.push_back(startStream(
+                    it->slot, array.sources[it->slot.layer], array));
+        } else if (pixels) {
+            upload(array.texture_id, it->slot.layer, *pixels);
+            array.dirty = true;
+        }
+        it = streams_.erase(it);
+    }
+    for (auto& stream : restarted)
+        streams_.push_back(std::move(stream));
+}
+
+void MaterialLibrary::finishPromotions() {
+    for (auto it = promotions_.begin(); it != promotions_.end();) {
+        if (!it->decodes->done()) {
+            ++it;
+            continue;
+        }
+
+        auto& array = arrays_[it->array];
+        array.promoting = false;
+        bool current = it->generation == array.generation;
+        unsigned int width = std::max(array.width >> it->dropped, 1U);
+        unsigned int height = std::max(array.height >> it->dropped, 1U);
+        const auto& layers = it->decodes->layers;
+        for (std::uint32_t layer = 0; layer < layers.size(); ++layer) {
+            const auto& pixels = layers[layer];
+            if (current && pixels)
+                upload(it->texture_id, layer, *pixels);
+            else if (current)
+                clearLayer(it->texture_id, width, height, layer);
+            else if (pixels && pixels->region)
+                ring_->retire(*pixels->region);
+        }
+
+        if (current) {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, it->texture_id);
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            glDeleteTextures(1, &array.texture_id);
+            array.texture_id = it->texture_id;
+            array.dropped = it->dropped;
+            ++array.generation;
+        } else {
+            // Requested again on the next update() if it is still needed
+            glDeleteTextures(1, &it->texture_id);
+        }
+        it = promotions_.erase(it);
+    }
+}
+
+void MaterialLibrary::balance() {
+    ++frame_;
+
+    std::vector<unsigned int> desired(arrays_.size());
+    std::size_t resident = 0;
+    residency_.requested = 0;
+    for (std::uint32_t i = 0; i < arrays_.size(); ++i) {
+        auto& array = arrays_[i];
+        desired[i] = array.dropped;
+        std::uint32_t wanted = wanted_[i].exchange(0,
+                                                   std::memory_order_relaxed);
+        if (wanted > 0) {
+            array.last_used = frame_;
+            desired[i] = droppedFor(array.width, array.height, array.levels,
+                                    wanted);
+        }
+        resident += array.bytes(array.dropped);
+        residency_.requested += array.bytes(std::min(desired[i],
+                                                     array.dropped));
+    }
+    for (const auto& promotion : promotions_)
+        resident += arrays_[promotion.array].bytes(promotion.dropped);
+
+    for (std::uint32_t i = 0; i < arrays_.size(); ++i) {
+        const auto& array = arrays_[i];
+        if (array.promoting || desired[i] >= array.dropped)
+            continue;
+
+        // Both storages are alive until the promotion finishes
+        std::size_t extra = array.bytes(desired[i]);
+        while (resident + extra > residency_.budget &&
+               evictLeastRecent(i, resident))
+            ;
+        if (resident + extra > residency_.budget)
+            continue;
+        promote(i, desired[i]);
+        resident += extra;
+    }
+    residency_.resident = resident;
+}
+
+void MaterialLibrary::promote(std::uint32_t index, unsigned int dropped) {
+    auto& array = arrays_[index];
+    array.promoting = true;
+
+    // Workers scale the images for the new top level
+    TextureArray target = array;
+    target.dropped = dropped;
+    Promotion promotion{index, array.generation, dropped,
+                        allocate(array, dropped, array.capacity),
+                        std::make_unique<Decodes>()};
+    auto& decodes = *promotion.decodes;
+    decodes.layers.resize(array.sources.size());
+    for (std::size_t layer = 0; layer < array.sources.size(); ++layer)
+        if (!array.sources[layer].empty())
+            startDecode(decodes, layer, array.sources[layer], target);
+    promotions_.push_back(std::move(promotion));
+}
+
+bool MaterialLibrary::evictLeastRecent(std::uint32_t keep,
+                                       std::size_t& resident) {
+    TextureArray* victim = nullptr;
+    for (std::uint32_t i = 0; i < arrays_.size(); ++i) {
+        auto& array = arrays_[i];
+        if (i == keep || array.promoting || array.last_used == frame_ ||
+            array.dropped + 1 >= array.levels)
+            continue;
+        if (victim == nullptr || array.last_used < victim->last_used)
+            victim = &array;
+    }
+    if (victim == nullptr)
+        return false;
+
+    std::size_t before = victim->bytes(victim->dropped);
+    evict(*victim);
+    resident -= before - victim->bytes(victim->dropped);
+    return true;
+}
+
+// The lower levels stay as they are, so they are copied instead of decoded
+void MaterialLibrary::evict(TextureArray& array) {
+    unsigned int texture_id = allocate(array, array.dropped + 1,
+                                       array.capacity);
+    if (array.layers > 0) {
+        for (unsigned int level = 0; level + array.dropped + 1 < array.levels;
+             ++level) {
+            unsigned int source = level + array.dropped + 1;
+            auto width = static_cast<GLsizei>(std::max(array.width >> source,
+                                                       1U));
+            auto height = static_cast<GLsizei>(std::max(array.height >> source,
+                                                        1U));
+            glCopyImageSubData(array.texture_id, GL_TEXTURE_2D_ARRAY,
+                               static_cast<GLint>(source), 0, 0, 0,
+                               texture_id, GL_TEXTURE_2D_ARRAY,
+                               static_cast<GLint>(level), 0, 0, 0, width,
+                               height, static_cast<GLsizei>(array.layers));
+        }
+    }
+    glDeleteTextures(1, &array.texture_id);
+    array.texture_id = texture_id;
+    ++array.dropped;
+    ++array.generation;
+}
+
+void MaterialLibrary::bind() const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_STORAGE_BINDING,
+                     buffer_id_);
+}
+
+const Material& MaterialLibrary::get(std::uint32_t material) const {
+    return materials_[material];
+}
+
+std::vector<std::uint32_t> MaterialLibrary::get_feature_sets() const {
+    std::vector<std::uint32_t> result;
+    for (const auto& material : materials_)
+        if (std::find(result.begin(), result.end(), material.features) ==
+            result.end())
+            result.push_back(material.features);
+    return result;
+}
+
+unsigned int MaterialLibrary::get_array_texture(std::uint32_t array) const {
+    return arrays_[array].texture_id;
+}
+
+TextureSlot MaterialLibrary::white() const {
+    return white_;
+}
+
+TextureSlot MaterialLibrary::black() const {
+    return black_;
+}
+
+const TextureResidency& MaterialLibrary::get_residency() const {
+    return residency_;
+}
+
+TextureSlot MaterialLibrary::reserveLayer(unsigned int width,
+                                          unsigned int height,
+                                          std::string source) {
+    std::uint32_t index = arrayFor(width, height);
+    auto& array = arrays_[index];
+    if (array.layers == array.capacity)
+        grow(array);
+
+    array.sources.push_back(std::move(source));
+    ++array.generation;
+    return TextureSlot{index, array.layers++};
+}
+
+TextureSlot MaterialLibrary::addLayer(const Image& image,
+                                      std::string source) {
+    TextureSlot slot = reserveLayer(image.width, image.height,
+                                    std::move(source));
+    auto& array = arrays_[slot.array];
+    Image scaled = scaledDown(image, array.dropped);
+    upload(array.texture_id, slot.layer,
+           Pixels{scaled.width, scaled.height, std::nullopt,
+                  std::move(scaled.pixels)});
+    array.dirty = true;
+    return slot;
+}
+
+void MaterialLibrary::upload(unsigned int texture_id, std::uint32_t layer,
+                             const Pixels& pixels) {
+    const void* data = pixels.fallback.data();
+    if (pixels.region) {
+        ring_->bind();
+        data = ring_->offset(*pixels.region);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer),
+                    static_cast<GLsizei>(pixels.width),
+                    static_cast<GLsizei>(pixels.height), 1, GL_RGBA,
+                    GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    if (pixels.region) {
+        ring_->unbind();
+        ring_->retire(*pixels.region);
+    }
+}
+
+std::uint32_t MaterialLibrary::arrayFor(unsigned int width,
+                                        unsigned int height) {
+    ArrayKey key{width, height, FORMAT};
+    auto it = array_indices_.find(key);
+    if (it != array_indices_.end())
+        return it->second;
+
+    auto index = static_cast<std::uint32_t>(arrays_.size());
+    unsigned int levels = levelCount(width, height);
+    unsigned int dropped = droppedFor(width, height, levels,
+                                      STREAM_START_SIZE);
+    arrays_.push_back(TextureArray{0, width, height, FORMAT, levels, dropped,
+                                   0, 0, false, false, 0, 0, {}});
+    wanted_.emplace_back(0U);
+    grow(arrays_.back());
+    array_indices_.emplace(key, index);
+    return index;
+}
+
+unsigned int MaterialLibrary::allocate(const TextureArray& array,
+                                       unsigned int dropped,
+                                       std::uint32_t capacity) const {
+    unsigned int texture_id = 0;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_id);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY,
+                   static_cast<GLsizei>(array.levels - dropped), array.format,
+                   static_cast<GLsizei>(std::max(array.width >> dropped, 1U)),
+                   static_cast<GLsizei>(std::max(array.height >> dropped, 1U)),
+                   static_cast<GLsizei>(capacity));
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture_id;
+}
+
+// Storage of texture arrays is immutable, so growing moves every resident
+// level of every layer into a new texture
+void MaterialLibrary::grow(TextureArray& array) {
+    std::uint32_t capacity =
+            array.capacity == 0 ? INITIAL_LAYERS : array.capacity * 2;
+    unsigned int texture_id = allocate(array, array.dropped, capacity);
+
+    if (array.layers > 0) {
+        for (unsigned int level = 0; level + array.dropped < array.levels;
+             ++level) {
+            unsigned int source = level + array.dropped;
+            auto width = static_cast<GLsizei>(std::max(array.width >> source,
+                                                       1U));
+            auto height = static_cast<GLsizei>(std::max(array.height >> source,
+                                                        1U));
+            glCopyImageSubData(array.texture_id, GL_TEXTURE_2D_ARRAY,
+                               static_cast<GLint>(level), 0, 0, 0, texture_id,
+                               GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level),
+                               0, 0, 0, width, height,
+                               static_cast<GLsizei>(array.layers));
+        }
+    }
+    glDeleteTextures(1, &array.texture_id);
+
+    array.texture_id = texture_id;
+    array.capacity = capacity;
+    ++array.generation;
+}
+
+} // namespace rg
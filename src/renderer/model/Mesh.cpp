@@ -1,48 +1,132 @@
 #include <rg/renderer/model/Mesh.hpp>
 
+#include <rg/renderer/shader/UniformBlocks.hpp>
+
 #include <glad/glad.h>
 
-#include <array>
+#include <glm/vec4.hpp>
+
 #include <utility>
 
 namespace rg {
 
-Mesh::Mesh(std::shared_ptr<MeshVertexData> vertices,
-           std::vector<std::shared_ptr<Texture>> textures)
-        : vertices_{std::move(vertices)}, textures_{std::move(textures)} {
+Mesh::Mesh(const GeometryArena& arena, GeometryRange range,
+           VertexQuantization quantization, std::vector<MeshLod> lods,
+           std::vector<Meshlet> meshlets, const MaterialLibrary& library,
+           std::uint32_t material)
+        : arena_{&arena}, range_{range}, quantization_{quantization},
+          lods_{std::move(lods)}, meshlets_{std::move(meshlets)},
+          library_{&library}, material_{material} {
+    if (lods_.empty())
+        lods_.push_back(MeshLod{0, range_.index_count, 0.0f});
 }
 
 void Mesh::draw(const Shader& shader) const {
-    static const std::array<std::string, 2> type_to_id{
-            "material.texture_diffuse", "material.texture_specular"};
     shader.bind();
 
-    static std::array<unsigned int, 2> type_count;
-    type_count[0] = type_count[1] = 0;
+    const auto& material = library_->get(material_);
+    glActiveTexture(GL_TEXTURE0 + DIFFUSE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY,
+                  library_->get_array_texture(material.diffuse.array));
+    glActiveTexture(GL_TEXTURE0 + SPECULAR_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY,
+                  library_->get_array_texture(material.specular.array));
+    shader.set_int("diffuse_layer", static_cast<int>(material.diffuse.layer));
+    shader.set_int("specular_layer",
+                   static_cast<int>(material.specular.layer));
+    shader.set("quantization",
+               glm::vec4{quantization_.offset, quantization_.scale});
 
-    for (unsigned int i = 0; i < textures_.size(); ++i) {
-        // Select active texture slot
-        glActiveTexture(GL_TEXTURE0 + i);
+    // Reset active texture
+    glActiveTexture(GL_TEXTURE0);
 
-        auto idx = static_cast<unsigned int>(textures_[i]->type);
-        // Tell the GPU which slot the texture occupies
-        shader.set_int(type_to_id[idx] + std::to_string(type_count[idx] + 1),
-                       static_cast<int>(i));
-        ++type_count[idx];
+    arena_->bind();
+    const auto& lod = lods_.front();
+    glDrawElementsBaseVertex(
+            GL_TRIANGLES, static_cast<GLsizei>(lod.index_count),
+            GL_UNSIGNED_SHORT,
+            reinterpret_cast<const void*>(
+                    (range_.first_index + lod.first_index) *
+                    sizeof(GeometryArena::Index)),
+            static_cast<GLint>(range_.base_vertex));
+    arena_->unbind();
+}
 
-        // Bind the texture to the active slot
-        glBindTexture(GL_TEXTURE_2D, textures_[i]->texture_id);
-    }
+void Mesh::record(CommandBuffer& commands, std::uint32_t base_instance,
+                  std::uint32_t lod) const {
+    record_textures(commands);
+    commands.bind_vertex_array(arena_->vertex_array_id());
+    const auto& range = lods_[lod];
+    commands.draw_elements_instanced(
+            range.index_count, 1, range_.first_index + range.first_index,
+            static_cast<std::int32_t>(range_.base_vertex), base_instance);
+}
 
-    // Reset active texture
-    glActiveTexture(GL_TEXTURE0);
+void Mesh::record_textures(CommandBuffer& commands) const {
+    const auto& material = library_->get(material_);
+    commands.bind_texture(DIFFUSE_TEXTURE_UNIT,
+                          library_->get_array_texture(material.diffuse.array),
+                          GL_TEXTURE_2D_ARRAY);
+    commands.bind_texture(SPECULAR_TEXTURE_UNIT,
+                          library_->get_array_texture(material.specular.array),
+                          GL_TEXTURE_2D_ARRAY);
+}
+
+DrawElementsIndirectCommand
+Mesh::indirect(std::uint32_t base_instance, std::uint32_t lod) const {
+    const auto& range = lods_[lod];
+    return DrawElementsIndirectCommand{
+            range.index_count, 1, range_.first_index + range.first_index,
+            static_cast<std::int32_t>(range_.base_vertex), base_instance};
+}
+
+DrawElementsIndirectCommand Mesh::indirect(std::uint32_t base_instance,
+                                           const Meshlet& meshlet) const {
+    return DrawElementsIndirectCommand{
+            meshlet.index_count, 1, range_.first_index + meshlet.first_index,
+            static_cast<std::int32_t>(range_.base_vertex), base_instance};
+}
+
+std::uint32_t Mesh::select_lod(float max_error) const {
+    // The errors grow with the levels
+    std::uint32_t lod = 0;
+    while (lod + 1 < lods_.size() && lods_[lod + 1].error <= max_error)
+        ++lod;
+    return lod;
+}
+
+std::uint32_t Mesh::vertex_array_id() const {
+    return arena_->vertex_array_id();
+}
+
+const GeometryRange& Mesh::range() const {
+    return range_;
+}
+
+const VertexQuantization& Mesh::quantization() const {
+    return quantization_;
+}
+
+const std::vector<MeshLod>& Mesh::lods() const {
+    return lods_;
+}
+
+const std::vector<Meshlet>& Mesh::meshlets() const {
+    return meshlets_;
+}
+
+std::uint32_t Mesh::material() const {
+    return material_;
+}
+
+std::uint64_t Mesh::texture_key() const {
+    const auto& material = library_->get(material_);
+    return (std::uint64_t{material.diffuse.array} << 32U) |
+           material.specular.array;
+}
 
-    vertices_->vertex_array.bind();
-    vertices_->index_buffer.bind();
-    glDrawElements(GL_TRIANGLES, vertices_->index_buffer.count(),
-                   GL_UNSIGNED_INT, nullptr);
-    vertices_->vertex_array.unbind();
-    vertices_->index_buffer.unbind();
+std::uint32_t Mesh::features() const {
+    return library_->get(material_).features;
 }
 
 } // namespace rg
@@ -0,0 +1,662 @@
+#include <rg/renderer/model/MeshOptimizer.hpp>
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+namespace rg {
+
+namespace {
+
+// Forsyth's scoring, with the constants of the original write-up
+constexpr int MAX_CACHE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float vertexScore(int cache_position, std::uint32_t remaining) {
+    if (remaining == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0 && cache_position < 3) {
+        // The vertices of the last triangle get a fixed score, so that the
+        // next one does not simply continue a strip
+        score = LAST_TRIANGLE_SCORE;
+    } else if (cache_position >= 3) {
+        float scale = 1.0f / (MAX_CACHE - 3);
+        score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale,
+                         CACHE_DECAY_POWER);
+    }
+    // Finishing off the vertices with few triangles left frees the cache
+    score += VALENCE_BOOST_SCALE *
+             std::pow(static_cast<float>(remaining), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+// Simulates a FIFO cache: a vertex is cached while fewer than size misses
+// came after its own
+class FifoCache {
+public:
+    FifoCache(std::size_t vertex_count, unsigned int size)
+            : stamps_(vertex_count, 0), time_{std::uint64_t{size} + 1},
+              size_{size} {
+    }
+
+    // Whether the vertex missed, in which case it is now cached
+    bool access(unsigned int vertex) {
+        if (time_ - stamps_[vertex] <= size_)
+            return false;
+        stamps_[vertex] = time_++;
+        return true;
+    }
+
+private:
+    std::vector<std::uint64_t> stamps_;
+    std::uint64_t time_;
+    unsigned int size_;
+};
+
+} // namespace
+
+float VertexCacheStats::acmr() const {
+    return triangles == 0 ? 0.0f
+                          : static_cast<float>(transforms) /
+                                    static_cast<float>(triangles);
+}
+
+float VertexCacheStats::atvr() const {
+    return vertices == 0 ? 0.0f
+                         : static_cast<float>(transforms) /
+                                   static_cast<float>(vertices);
+}
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other) {
+    transforms += other.transforms;
+    triangles += other.triangles;
+    vertices += other.vertices;
+    return *this;
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices,
+                                    std::size_t vertex_count,
+                                    unsigned int cache_size) {
+    VertexCacheStats stats;
+    stats.triangles = indices.size() / 3;
+
+    FifoCache cache{vertex_count, cache_size};
+    std::vector<bool> used(vertex_count, false);
+    for (unsigned int index : indices) {
+        if (cache.access(index))
+            ++stats.transforms;
+        if (!used[index]) {
+            used[index] = true;
+            ++stats.vertices;
+        }
+    }
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices,
+                         std::size_t vertex_count) {
+    std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return;
+
+    // The triangles of each vertex, of which the first remaining[v] are not
+    // emitted yet
+    std::vector<std::uint32_t> remaining(vertex_count, 0);
+    for (unsigned int index : indices)
+        ++remaining[index];
+    std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+    for (std::size_t v = 0; v < vertex_count; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<std::uint32_t> adjacency(indices.size());
+    {
+        std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+
+    std::vector<int> cache_position(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v)
+        vertex_scores[v] = vertexScore(-1, remaining[v]);
+    std::vector<float> triangle_scores(triangle_count, 0.0f);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+        triangle_scores[i / 3] += vertex_scores[indices[i]];
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> next_cache;
+
+    auto best = static_cast<std::size_t>(
+            std::max_element(triangle_scores.begin(), triangle_scores.end()) -
+            triangle_scores.begin());
+    std::size_t cursor = 0;
+    while (result.size() < triangle_count * 3) {
+        if (best == triangle_count) {
+            // Nothing cached has triangles left, start over anywhere
+            while (emitted[cursor])
+                ++cursor;
+            best = cursor;
+        }
+
+        emitted[best] = true;
+        next_cache.clear();
+        for (std::size_t k = 0; k < 3; ++k) {
+            unsigned int v = indices[best * 3 + k];
+            result.push_back(v);
+
+            auto* begin = adjacency.data() + offsets[v];
+            auto* end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            --remaining[v];
+
+            if (std::find(next_cache.begin(), next_cache.end(), v) ==
+                next_cache.end())
+                next_cache.push_back(v);
+        }
+        // The rest of the cache moves back behind the emitted vertices
+        for (unsigned int v : cache)
+            if (std::find(next_cache.begin(), next_cache.end(), v) ==
+                next_cache.end())
+                next_cache.push_back(v);
+
+        for (std::size_t i = 0; i < next_cache.size(); ++i) {
+            unsigned int v = next_cache[i];
+            cache_position[v] = i < MAX_CACHE ? static_cast<int>(i) : -1;
+            float score = vertexScore(cache_position[v], remaining[v]);
+            float delta = score - vertex_scores[v];
+            vertex_scores[v] = score;
+            for (std::uint32_t j = 0; j < remaining[v]; ++j)
+                triangle_scores[adjacency[offsets[v] + j]] += delta;
+        }
+        if (next_cache.size() > MAX_CACHE)
+            next_cache.resize(MAX_CACHE);
+        std::swap(cache, next_cache);
+
+        best = triangle_count;
+        float best_score = -1.0f;
+        for (unsigned int v : cache) {
+            for (std::uint32_t j = 0; j < remaining[v]; ++j) {
+                std::uint32_t triangle = adjacency[offsets[v] + j];
+                if (triangle_scores[triangle] > best_score) {
+                    best_score = triangle_scores[triangle];
+                    best = triangle;
+                }
+            }
+        }
+    }
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int>& indices,
+                      const std::vector<Vertex>& vertices) {
+    std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2)
+        return;
+
+    // A cluster starts with each triangle which misses on all its vertices
+    std::vector<std::size_t> starts;
+    FifoCache cache{vertices.size(), VERTEX_CACHE_SIZE};
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        int misses = 0;
+        for (std::size_t k = 0; k < 3; ++k)
+            misses += cache.access(indices[t * 3 + k]) ? 1 : 0;
+        if (t == 0 || misses == 3)
+            starts.push_back(t);
+    }
+    if (starts.size() < 2)
+        return;
+    starts.push_back(triangle_count);
+
+    auto triangleAt = [&](std::size_t t, glm::vec3& centroid,
+                          glm::vec3& normal) {
+        const auto& a = vertices[indices[t * 3]].position;
+        const auto& b = vertices[indices[t * 3 + 1]].position;
+        const auto& c = vertices[indices[t * 3 + 2]].position;
+        centroid = (a + b + c) / 3.0f;
+        // Twice the area long
+        normal = glm::cross(b - a, c - a);
+    };
+
+    // Centroids are weighted by area
+    glm::vec3 center{0.0f};
+    float area = 0.0f;
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        glm::vec3 centroid, normal;
+        triangleAt(t, centroid, normal);
+        float weight = glm::length(normal);
+        center += centroid * weight;
+        area += weight;
+    }
+    if (area > 0.0f)
+        center /= area;
+
+    std::vector<std::pair<float, std::size_t>> clusters;
+    for (std::size_t i = 0; i + 1 < starts.size(); ++i) {
+        glm::vec3 cluster_center{0.0f}, cluster_normal{0.0f};
+        float cluster_area = 0.0f;
+        for (std::size_t t = starts[i]; t < starts[i + 1]; ++t) {
+            glm::vec3 centroid, normal;
+            triangleAt(t, centroid, normal);
+            float weight = glm::length(normal);
+            cluster_center += centroid * weight;
+            cluster_normal += normal;
+            cluster_area += weight;
+        }
+        float facing = 0.0f;
+        float length = glm::length(cluster_normal);
+        if (cluster_area > 0.0f && length > 0.0f)
+            facing = glm::dot(cluster_center / cluster_area - center,
+                              cluster_normal / length);
+        clusters.emplace_back(facing, i);
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.first > b.first;
+                     });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const auto& [facing, i] : clusters)
+        result.insert(result.end(), indices.begin() + starts[i] * 3,
+                      indices.begin() + starts[i + 1] * 3);
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices,
+                         std::vector<unsigned int>& indices) {
+    constexpr auto UNUSED = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+    for (auto& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<unsigned int>(result.size());
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(result);
+}
+
+namespace {
+
+// A sum of squared distances to planes, as a symmetric 4x4 matrix
+struct Quadric {
+    double xx = 0, xy = 0, xz = 0, xw = 0;
+    double yy = 0, yz = 0, yw = 0;
+    double zz = 0, zw = 0;
+    double ww = 0;
+
+    // The plane through the triangle, if it has an area
+    void add_triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area == 0.0f)
+            return;
+        normal /= area;
+        double x = normal.x, y = normal.y, z = normal.z;
+        double w = -glm::dot(normal, a);
+        xx += x * x, xy += x * y, xz += x * z, xw += x * w;
+        yy += y * y, yz += y * z, yw += y * w;
+        zz += z * z, zw += z * w;
+        ww += w * w;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        xx += other.xx, xy += other.xy, xz += other.xz, xw += other.xw;
+        yy += other.yy, yz += other.yz, yw += other.yw;
+        zz += other.zz, zw += other.zw;
+        ww += other.ww;
+        return *this;
+    }
+
+    [[nodiscard]] double error(glm::vec3 p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double e = xx * x * x + yy * y * y + zz * z * z + ww +
+                   2.0 * (xy * x * y + xz * x * z + yz * y * z + xw * x +
+                          yw * y + zw * z);
+        return std::max(e, 0.0);
+    }
+};
+
+// Vertices which may not move: on a border, where only one triangle has an
+// edge, and on a seam, where several vertices share a position
+std::vector<bool> lockedVertices(const std::vector<unsigned int>& indices,
+                                 const std::vector<Vertex>& vertices) {
+    std::map<std::array<float, 3>, std::uint32_t> positions;
+    std::vector<std::uint32_t> group(vertices.size());
+    std::vector<std::uint32_t> group_size;
+    for (std::size_t v = 0; v < vertices.size(); ++v) {
+        const auto& p = vertices[v].position;
+        auto [it, added] = positions.try_emplace(
+                {p.x, p.y, p.z}, static_cast<std::uint32_t>(group_size.size()));
+        if (added)
+            group_size.push_back(0);
+        group[v] = it->second;
+        ++group_size[it->second];
+    }
+
+    // Edges between positions, counted in both directions together
+    std::unordered_map<std::uint64_t, std::uint32_t> edges;
+    auto edge = [&](unsigned int a, unsigned int b) {
+        std::uint64_t ga = group[a], gb = group[b];
+        return ga < gb ? (ga << 32U) | gb : (gb << 32U) | ga;
+    };
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        for (std::size_t k = 0; k < 3; ++k)
+            ++edges[edge(indices[i + k], indices[i + (k + 1) % 3])];
+
+    std::vector<bool> locked(vertices.size(), false);
+    for (std::size_t v = 0; v < vertices.size(); ++v)
+        locked[v] = group_size[group[v]] > 1;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            unsigned int a = indices[i + k];
+            unsigned int b = indices[i + (k + 1) % 3];
+            if (edges[edge(a, b)] != 2) {
+                locked[a] = true;
+                locked[b] = true;
+            }
+        }
+    }
+    return locked;
+}
+
+struct Collapse {
+    double cost;
+    unsigned int from;
+    unsigned int to;
+};
+
+} // namespace
+
+float simplify(std::vector<unsigned int>& indices,
+               const std::vector<Vertex>& vertices,
+               std::size_t target_index_count, float max_error) {
+    std::size_t vertex_count = vertices.size();
+    auto position = [&](unsigned int v) { return vertices[v].position; };
+
+    std::vector<bool> locked = lockedVertices(indices, vertices);
+    std::vector<Quadric> quadrics(vertex_count);
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Quadric q;
+        q.add_triangle(position(indices[i]), position(indices[i + 1]),
+                       position(indices[i + 2]));
+        for (std::size_t k = 0; k < 3; ++k)
+            quadrics[indices[i + k]] += q;
+    }
+
+    double max_cost = static_cast<double>(max_error) * max_error;
+    double moved = 0.0;
+    std::vector<unsigned int> remap(vertex_count);
+    std::vector<std::uint32_t> offsets(vertex_count + 1);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<bool> touched(vertex_count);
+
+    // Each pass collapses edges which are apart from each other, cheapest
+    // first, and then drops the triangles which became degenerate
+    while (indices.size() > target_index_count) {
+        // The triangles of each vertex
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (unsigned int index : indices)
+            ++offsets[index + 1];
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            offsets[v + 1] += offsets[v];
+        adjacency.resize(indices.size());
+        {
+            std::vector<std::uint32_t> fill(offsets.begin(),
+                                            offsets.end() - 1);
+            for (std::size_t i = 0; i < indices.size(); ++i)
+                adjacency[fill[indices[i]]++] =
+                        static_cast<std::uint32_t>(i / 3);
+        }
+
+        collapses.clear();
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            for (std::size_t k = 0; k < 3; ++k) {
+                unsigned int a = indices[i + k];
+                unsigned int b = indices[i + (k + 1) % 3];
+                Quadric q = quadrics[a];
+                q += quadrics[b];
+                if (!locked[a])
+                    collapses.push_back({q.error(position(b)), a, b});
+                if (!locked[b])
+                    collapses.push_back({q.error(position(a)), b, a});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& x, const Collapse& y) {
+                      return x.cost < y.cost;
+                  });
+
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            remap[v] = static_cast<unsigned int>(v);
+        std::fill(touched.begin(), touched.end(), false);
+        std::size_t removable = (indices.size() - target_index_count) / 3;
+        std::size_t removed = 0;
+        for (const auto& collapse : collapses) {
+            if (collapse.cost > max_cost || removed >= removable)
+                break;
+            unsigned int from = collapse.from;
+            unsigned int to = collapse.to;
+            if (touched[from] || touched[to])
+                continue;
+
+            // Triangles around the moved vertex must not flip over
+            bool flips = false;
+            std::size_t degenerate = 0;
+            for (auto j = offsets[from]; j < offsets[from + 1]; ++j) {
+                const unsigned int* t = &indices[adjacency[j] * 3];
+                if (t[0] == to || t[1] == to || t[2] == to) {
+                    ++degenerate;
+                    continue;
+                }
+                glm::vec3 p[3], moved_p[3];
+                for (std::size_t k = 0; k < 3; ++k) {
+                    p[k] = position(t[k]);
+                    moved_p[k] = t[k] == from ? position(to) : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(moved_p[1] - moved_p[0],
+                                             moved_p[2] - moved_p[0]);
+                if (glm::dot(before, after) <= 0.0f) {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips)
+                continue;
+
+            remap[from] = to;
+            quadrics[to] += quadrics[from];
+            moved = std::max(moved, collapse.cost);
+            removed += degenerate;
+            // The neighbourhood changed, so the other collapses around it
+            // wait for the next pass
+            for (auto j = offsets[from]; j < offsets[from + 1]; ++j)
+                for (std::size_t k = 0; k < 3; ++k)
+                    touched[indices[adjacency[j] * 3 + k]] = true;
+        }
+        if (removed == 0)
+            break;
+
+        std::size_t write = 0;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            unsigned int a = remap[indices[i]];
+            unsigned int b = remap[indices[i + 1]];
+            unsigned int c = remap[indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            indices[write++] = a;
+            indices[write++] = b;
+            indices[write++] = c;
+        }
+        indices.resize(write);
+    }
+    return static_cast<float>(std::sqrt(moved));
+}
+
+std::vector<MeshLod> buildLods(std::vector<unsigned int>& indices,
+                               const std::vector<Vertex>& vertices,
+                               std::size_t max_lods, float max_error) {
+    std::vector<MeshLod> lods{
+            {0, static_cast<std::uint32_t>(indices.size()), 0.0f}};
+    std::vector<unsigned int> lod{indices};
+    float error = 0.0f;
+    while (lods.size() < max_lods) {
+        std::size_t previous = lod.size();
+        std::size_t target = previous / 6 * 3;
+        // The errors of the levels add up, so each one gets what is left
+        float pass_error = simplify(lod, vertices, target, max_error - error);
+        if (lod.size() * 5 > previous * 4)
+            break;
+
+        error += pass_error;
+        optimizeVertexCache(lod, vertices.size());
+        lods.push_back({static_cast<std::uint32_t>(indices.size()),
+                        static_cast<std::uint32_t>(lod.size()), error});
+        indices.insert(indices.end(), lod.begin(), lod.end());
+    }
+    return lods;
+}
+
+namespace {
+
+// Below this the normals spread over nearly a half space, and a cone test
+// would hardly ever cull
+constexpr float MIN_CONE_COSINE = 0.1f;
+
+// The bounds of the count indices from first
+Meshlet boundMeshlet(const std::vector<unsigned int>& indices,
+                     const std::vector<Vertex>& vertices, std::size_t first,
+                     std::size_t count) {
+    glm::vec3 low{std::numeric_limits<float>::max()};
+    glm::vec3 high{std::numeric_limits<float>::lowest()};
+    glm::vec3 normal_sum{0.0f};
+    std::vector<glm::vec3> normals;
+    normals.reserve(count / 3);
+    for (std::size_t i = first; i < first + count; i += 3) {
+        const auto& a = vertices[indices[i]].position;
+        const auto& b = vertices[indices[i + 1]].position;
+        const auto& c = vertices[indices[i + 2]].position;
+        low = glm::min(low, glm::min(a, glm::min(b, c)));
+        high = glm::max(high, glm::max(a, glm::max(b, c)));
+
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float area = glm::length(normal);
+        if (area == 0.0f)
+            continue;
+        normals.push_back(normal / area);
+        normal_sum += normals.back();
+    }
+
+    glm::vec3 center = (low + high) * 0.5f;
+    float radius = 0.0f;
+    for (std::size_t i = first; i < first + count; ++i)
+        radius = std::max(radius, glm::length(vertices[indices[i]].position -
+                                              center));
+
+    glm::vec4 cone{0.0f, 0.0f, 0.0f, 1.0f};
+    float length = glm::length(normal_sum);
+    if (length > 0.0f) {
+        glm::vec3 axis = normal_sum / length;
+        float cosine = 1.0f;
+        for (const auto& normal : normals)
+            cosine = std::min(cosine, glm::dot(axis, normal));
+        if (cosine >= MIN_CONE_COSINE)
+            cone = glm::vec4{axis, std::sqrt(1.0f - cosine * cosine)};
+    }
+
+    return Meshlet{static_cast<std::uint32_t>(first),
+                   static_cast<std::uint32_t>(count),
+                   glm::vec4{center, radius}, cone};
+}
+
+} // namespace
+
+std::vector<Meshlet> buildMeshlets(const std::vector<unsigned int>& indices,
+                                   const std::vector<Vertex>& vertices) {
+    std::vector<Meshlet> meshlets;
+    // The meshlet each vertex was last counted in, plus one
+    std::vector<std::size_t> seen(vertices.size(), 0);
+    std::size_t end = indices.size() - indices.size() % 3;
+    std::size_t first = 0;
+    std::size_t vertex_count = 0;
+    for (std::size_t i = 0; i < end; i += 3) {
+        auto stamp = meshlets.size() + 1;
+        std::size_t added = 0;
+        for (std::size_t j = 0; j < 3; ++j)
+            added += seen[indices[i + j]] != stamp ? 1 : 0;
+        // Repeated corners of a degenerate triangle are counted twice, which
+        // only ends the meshlet early
+        if (vertex_count + added > MAX_MESHLET_VERTICES ||
+            i - first == 3 * MAX_MESHLET_TRIANGLES) {
+            meshlets.push_back(
+                    boundMeshlet(indices, vertices, first, i - first));
+            first = i;
+            vertex_count = 0;
+            ++stamp;
+        }
+
+        for (std::size_t j = 0; j < 3; ++j) {
+            if (seen[indices[i + j]] != stamp) {
+                seen[indices[i + j]] = stamp;
+                ++vertex_count;
+            }
+        }
+    }
+    if (end > first)
+        meshlets.push_back(boundMeshlet(indices, vertices, first, end - first));
+    return meshlets;
+}
+
+std::vector<MeshPart> splitMesh(std::vector<Vertex> vertices,
+                                std::vector<unsigned int> indices,
+                                std::size_t max_vertices) {
+    std::vector<MeshPart> parts;
+    if (vertices.size() <= max_vertices) {
+        parts.push_back(MeshPart{std::move(vertices), std::move(indices)});
+        return parts;
+    }
+
+    constexpr auto UNUSED = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> remap(vertices.size(), UNUSED);
+    MeshPart part;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::size_t added = 0;
+        for (std::size_t j = 0; j < 3; ++j)
+            added += remap[indices[i + j]] == UNUSED ? 1 : 0;
+        if (part.vertices.size() + added > max_vertices) {
+            std::fill(remap.begin(), remap.end(), UNUSED);
+            parts.push_back(std::move(part));
+            part = MeshPart{};
+        }
+
+        for (std::size_t j = 0; j < 3; ++j) {
+            auto& index = remap[indices[i + j]];
+            if (index == UNUSED) {
+                index = static_cast<unsigned int>(part.vertices.size());
+                part.vertices.push_back(vertices[indices[i + j]]);
+            }
+            part.indices.push_back(index);
+        }
+    }
+    if (!part.indices.empty())
+        parts.push_back(std::move(part));
+    return parts;
+}
+
+} // namespace rg
@@ -1,68 +1,216 @@
 #include <rg/renderer/model/Model.hpp>
 
+#include <rg/renderer/model/ModelCache.hpp>
 #include <rg/renderer/model/Texture.hpp>
 #include <rg/renderer/model/Vertex.hpp>
+#include <rg/renderer/shader/ShaderVariants.hpp>
+#include <rg/util/FileLoader.hpp>
+#include <rg/util/ResourcePack.hpp>
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
+#include <assimp/MemoryIOWrapper.h>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
 #include <spdlog/spdlog.h>
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
 #include <array>
-#include <memory>
-#include <unordered_map>
+#include <filesystem>
+#include <limits>
+#include <utility>
 #include <vector>
 
 namespace rg {
 
+namespace {
+
+// Set with Model::use_cache
+ModelCache* model_cache = nullptr;
+
+// Levels of detail of a mesh, counting the full one
+constexpr std::size_t MAX_LODS = 4;
+// Of the coarsest level, relative to half the size of the mesh
+constexpr float MAX_LOD_ERROR = 0.1f;
+
+// Serves the files in the resource pack from memory, so that the model and
+// its material libraries are not opened one by one. The others are read
+// whole through the file loader and parsed from memory as well.
+class LoaderIOSystem : public Assimp::DefaultIOSystem {
+public:
+    bool Exists(const char* file) const override {
+        return util::ResourcePack::lookup(file).has_value() ||
+               DefaultIOSystem::Exists(file);
+    }
+
+    Assimp::IOStream* Open(const char* file, const char* mode) override {
+        if (mode[0] != 'r')
+            return DefaultIOSystem::Open(file, mode);
+        if (auto packed = util::ResourcePack::lookup(file))
+            return new Assimp::MemoryIOStream(
+                    reinterpret_cast<const std::uint8_t*>(packed->data()),
+                    packed->size());
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(file, error);
+        if (error)
+            return nullptr;
+        // Owned by the stream
+        auto* buffer = new std::uint8_t[size];
+        std::vector<util::FileRead> reads{util::FileRead{
+                file, 0, size, reinterpret_cast<std::byte*>(buffer)}};
+        util::FileLoader::shared().read(reads);
+        if (!reads[0].complete) {
+            delete[] buffer;
+            return nullptr;
+        }
+        return new Assimp::MemoryIOStream(buffer, size, true);
+    }
+};
+
+void report(const std::string& path, const ModelData& data, bool cached) {
+    const auto& loaded = data.loaded_order;
+    const auto& optimized = data.optimized_order;
+    spdlog::info("RG::MODEL: \"{}\": ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> "
+                 "{:.3f}{}",
+                 path.substr(path.find_last_of('/') + 1), loaded.acmr(),
+                 optimized.acmr(), loaded.atvr(), optimized.atvr(),
+                 cached ? " (cached)" : "");
+}
+
+} // namespace
+
+Model::Model(const std::string& path, GeometryArena& arena,
+             MaterialLibrary& library)
+        : path_{path}, meshes_{}, bounds_{}, current_{0} {
+    upload(import(path), arena, library);
+}
+
+void Model::reload(const ModelData& data, GeometryArena& arena,
+                   MaterialLibrary& library) {
+    for (const auto& mesh : meshes_)
+        arena.free(mesh.range());
+    meshes_.clear();
+    upload(data, arena, library);
+}
+
+void Model::upload(const ModelData& data, GeometryArena& arena,
+                   MaterialLibrary& library) {
+    meshes_.reserve(data.meshes.size());
+    for (const auto& mesh : data.meshes) {
+        // Missing maps leave the surface white and without highlights
+        Material material{library.white(), library.black(), mesh.features};
+        if (!mesh.diffuse.empty())
+            material.diffuse =
+                    library.stream(mesh.diffuse).value_or(material.diffuse);
+        if (!mesh.specular.empty()) {
+            if (auto specular = library.stream(mesh.specular)) {
+                material.specular = *specular;
+                material.features |= SPECULAR_MAP;
+            }
+        }
+
+        GeometryRange range = arena.allocate(
+                mesh.vertices.data(),
+                static_cast<std::uint32_t>(mesh.vertices.size()),
+                mesh.indices.data(),
+                static_cast<std::uint32_t>(mesh.indices.size()));
+        meshes_.emplace_back(arena, range, mesh.quantization, mesh.lods,
+                             mesh.meshlets, library, library.add(material));
+    }
+
+    std::uint32_t next = current_.load(std::memory_order_relaxed) ^ 1U;
+    bounds_[next] = data.bounds;
+    current_.store(next, std::memory_order_release);
+}
+
 void Model::draw(const Shader& shader) const {
     for (const auto& mesh : meshes_)
         mesh.draw(shader);
 }
 
+const std::string& Model::get_path() const {
+    return path_;
+}
+
+const std::vector<Mesh>& Model::get_meshes() const {
+    return meshes_;
+}
+
+const BoundingSphere& Model::get_bounds() const {
+    return bounds_[current_.load(std::memory_order_acquire)];
+}
+
 namespace {
 
 class Loader {
 public:
     explicit Loader(const std::string& path)
-            : meshes_{}, textures_{}, path_{path} {
+            : data_{}, path_{path}, min_{std::numeric_limits<float>::max()},
+              max_{std::numeric_limits<float>::lowest()} {
         directory_ = path.substr(0, path.find_last_of('/'));
     }
 
     void loadScene();
-    std::vector<Mesh> get_meshes() const {
-        return meshes_;
+    // With bounds enclosing the bounding box of every loaded vertex
+    ModelData get_data() {
+        if (min_.x <= max_.x) {
+            glm::vec3 center = (min_ + max_) / 2.0f;
+            data_.bounds = BoundingSphere{center, glm::length(max_ - center)};
+        }
+        return std::move(data_);
     }
 
 private:
-    std::vector<Mesh> meshes_;
-    std::unordered_map<std::string, std::shared_ptr<Texture>> textures_;
+    ModelData data_;
     std::string path_;
     std::string directory_;
+    glm::vec3 min_;
+    glm::vec3 max_;
 
     /** @brief Recursively processes the scene and converts it to our model
      * format
      *
      * @param node The current node of the scene being processed
      * @param scene Assimp's representation of a scene
-     * @param meshes An array to insert the meshes
-     * @param memo Used to prevent the same texture being loaded twice
      */
     void processNode(aiNode* node, const aiScene* scene);
-    Mesh processMesh(aiMesh* mesh, const aiScene* scene);
-    static Vertex processVertex(aiMesh* mesh, unsigned int index);
+    // Adds a MeshData for each part of the mesh the arena can hold
+    void processMesh(aiMesh* mesh, const aiScene* scene);
+    Vertex processVertex(aiMesh* mesh, unsigned int index);
 
-    std::vector<std::shared_ptr<Texture>>
-    loadMaterialTextures(aiMaterial* material, TextureType type);
+    // The path of the first texture of the type, empty if there is none
+    std::string texturePath(aiMaterial* material, TextureType type) const;
 };
 
 } // namespace
 
-Model::Model(const std::string& path) : meshes_{} {
+ModelData Model::import(const std::string& path) {
+    std::uint64_t key = 0;
+    if (model_cache != nullptr && model_cache->is_enabled()) {
+        key = model_cache->key(path);
+        if (auto data = model_cache->load(key)) {
+            report(path, *data, true);
+            return std::move(*data);
+        }
+    }
+
     Loader loader{path};
     loader.loadScene();
-    meshes_ = loader.get_meshes();
+    ModelData data = loader.get_data();
+    if (data.valid) {
+        if (model_cache != nullptr)
+            model_cache->store(key, data);
+        report(path, data, false);
+    }
+    return data;
+}
+
+void Model::use_cache(ModelCache* cache) {
+    model_cache = cache;
 }
 
 namespace {
@@ -70,17 +218,16 @@ namespace {
 void Loader::processNode(aiNode* node, const aiScene* scene) {
     for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
         auto* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes_.emplace_back(processMesh(mesh, scene));
+        processMesh(mesh, scene);
     }
 
     for (unsigned int i = 0; i < node->mNumChildren; ++i)
         processNode(node->mChildren[i], scene);
 }
 
-Mesh Loader::processMesh(aiMesh* mesh, const aiScene* scene) {
+void Loader::processMesh(aiMesh* mesh, const aiScene* scene) {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
-    std::vector<std::shared_ptr<Texture>> textures;
 
     vertices.reserve(mesh->mNumVertices);
     for (unsigned int i = 0; i < mesh->mNumVertices; ++i)
@@ -92,37 +239,44 @@ Mesh Loader::processMesh(aiMesh* mesh, const aiScene* scene) {
             indices.push_back(polygon.mIndices[j]);
     }
 
+    // Optimizations
+    // -------------
+    data_.loaded_order += analyzeVertexCache(indices, vertices.size());
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices);
+    optimizeVertexFetch(vertices, indices);
+    data_.optimized_order += analyzeVertexCache(indices, vertices.size());
+
+    // What the parts have in common
+    MeshData shared{{}, {}, {}, {}, {}, {}, {}, 0};
     if (mesh->mMaterialIndex >= 0) {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-        auto diffuse_maps =
-                loadMaterialTextures(material, TextureType::DIFFUSE);
-        auto specular_maps =
-                loadMaterialTextures(material, TextureType::SPECULAR);
-
-        textures.insert(textures.end(), diffuse_maps.begin(),
-                        diffuse_maps.end());
-        textures.insert(textures.end(), specular_maps.begin(),
-                        specular_maps.end());
-    }
-
-    std::shared_ptr<MeshVertexData> mesh_data =
-            std::make_shared<MeshVertexData>();
-    mesh_data->vertex_array.bind();
+        shared.diffuse = texturePath(material, TextureType::DIFFUSE);
+        shared.specular = texturePath(material, TextureType::SPECULAR);
 
-    mesh_data->vertex_buffer = VertexBuffer{
-            vertices.data(),
-            static_cast<unsigned int>(vertices.size() * sizeof(Vertex))};
-    mesh_data->vertex_buffer.bind();
-    mesh_data->index_buffer = IndexBuffer{indices};
-    mesh_data->index_buffer.bind();
-
-    mesh_data->vertex_array.recordLayout(mesh_data->vertex_buffer,
-                                         util::layout<Vertex>());
-    mesh_data->vertex_array.unbind();
-    mesh_data->index_buffer.unbind();
-    mesh_data->vertex_buffer.unbind();
+        int shading = 0;
+        if (material->Get(AI_MATKEY_SHADING_MODEL, shading) == AI_SUCCESS &&
+            shading == aiShadingMode_NoShading)
+            shared.features |= UNLIT;
+    }
 
-    return Mesh{mesh_data, textures};
+    // Meshlets, levels of detail and packing
+    // --------------------------------------
+    // Each part is simplified and quantized against its own bounds. The
+    // meshlets cover the full detail indices, which come first.
+    for (auto& part : splitMesh(std::move(vertices), std::move(indices),
+                                GeometryArena::MAX_MESH_VERTICES)) {
+        MeshData result = shared;
+        result.quantization = findQuantization(part.vertices);
+        result.meshlets = buildMeshlets(part.indices, part.vertices);
+        result.lods = buildLods(part.indices, part.vertices, MAX_LODS,
+                                MAX_LOD_ERROR * result.quantization.scale);
+        result.vertices.reserve(part.vertices.size());
+        for (const auto& vertex : part.vertices)
+            result.vertices.push_back(pack(vertex, result.quantization));
+        result.indices.assign(part.indices.begin(), part.indices.end());
+        data_.meshes.push_back(std::move(result));
+    }
 }
 
 Vertex Loader::processVertex(aiMesh* mesh, unsigned int index) {
@@ -131,6 +285,8 @@ Vertex Loader::processVertex(aiMesh* mesh, unsigned int index) {
     v.position.x = mesh->mVertices[index].x;
     v.position.y = mesh->mVertices[index].y;
     v.position.z = mesh->mVertices[index].z;
+    min_ = glm::min(min_, v.position);
+    max_ = glm::max(max_, v.position);
 
     v.normal.x = mesh->mNormals[index].x;
     v.normal.y = mesh->mNormals[index].y;
@@ -148,9 +304,14 @@ Vertex Loader::processVertex(aiMesh* mesh, unsigned int index) {
 }
 
 void Loader::loadScene() {
+    // Without joining, every corner of every face is a vertex of its own and
+    // no index order could reuse them
     Assimp::Importer importer;
-    const aiScene* scene =
-            importer.ReadFile(path_, aiProcess_Triangulate | aiProcess_FlipUVs);
+    // Owned by the importer
+    importer.SetIOHandler(new LoaderIOSystem{});
+    const aiScene* scene = importer.ReadFile(
+            path_, aiProcess_Triangulate | aiProcess_FlipUVs |
+                           aiProcess_JoinIdenticalVertices);
 
     if (scene == nullptr || (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) ||
         scene->mRootNode == nullptr) {
@@ -160,33 +321,20 @@ void Loader::loadScene() {
     }
 
     processNode(scene->mRootNode, scene);
+    data_.valid = true;
 }
 
-std::vector<std::shared_ptr<Texture>>
-Loader::loadMaterialTextures(aiMaterial* material, TextureType type) {
-
+std::string Loader::texturePath(aiMaterial* material,
+                                TextureType type) const {
     static std::array<aiTextureType, 2> types = {aiTextureType_DIFFUSE,
                                                  aiTextureType_SPECULAR};
-    std::vector<std::shared_ptr<Texture>> material_textures;
     aiTextureType ai_type = types[static_cast<unsigned int>(type)];
-    for (unsigned int i = 0; i < material->GetTextureCount(ai_type); i++) {
-        aiString str;
-        material->GetTexture(ai_type, i, &str);
-        std::string path = str.C_Str();
-
-        auto it = textures_.find(path);
-        if (it != textures_.end()) {
-            material_textures.push_back(it->second);
-        } else {
-            Texture texture{directory_ + "/" + path, type};
-
-            auto ptr = std::make_shared<Texture>(texture);
-            textures_.emplace(path, ptr);
-            material_textures.push_back(ptr);
-        }
-    }
+    if (material->GetTextureCount(ai_type) == 0)
+        return {};
 
-    return material_textures;
+    aiString str;
+    material->GetTexture(ai_type, 0, &str);
+    return directory_ + "/" + str.C_Str();
 }
 
 } // namespace
@@ -0,0 +1,214 @@
+#include <rg/renderer/model/ModelCache.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace rg {
+
+namespace {
+
+// Written before the meshes, to reject files of another layout
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t vertex_size;
+    std::uint32_t mesh_count;
+};
+
+constexpr std::uint32_t MAGIC = 0x52474D43; // RGMC
+// Bumped whenever the layout or the optimizations change
+constexpr std::uint32_t VERSION = 4;
+
+// FNV-1a
+constexpr std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+std::uint64_t hash(std::uint64_t h, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+std::uint64_t hashFile(std::uint64_t h, const std::filesystem::path& file) {
+    std::error_code error;
+    auto size = std::filesystem::file_size(file, error);
+    auto time = std::filesystem::last_write_time(file, error)
+                        .time_since_epoch()
+                        .count();
+    std::string name = file.filename().string();
+    h = hash(h, name.data(), name.size());
+    h = hash(h, &size, sizeof(size));
+    return hash(h, &time, sizeof(time));
+}
+
+template <class T>
+void write(std::ostream& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+void write(std::ostream& out, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    write(out, static_cast<std::uint32_t>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+void write(std::ostream& out, const std::string& value) {
+    write(out, std::vector<char>{value.begin(), value.end()});
+}
+
+template <class T>
+bool read(std::istream& in, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(
+            in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <class T>
+bool read(std::istream& in, std::vector<T>& values) {
+    std::uint32_t size = 0;
+    if (!read(in, size))
+        return false;
+    values.resize(size);
+    return static_cast<bool>(
+            in.read(reinterpret_cast<char*>(values.data()),
+                    static_cast<std::streamsize>(values.size() * sizeof(T))));
+}
+
+bool read(std::istream& in, std::string& value) {
+    std::vector<char> characters;
+    if (!read(in, characters))
+        return false;
+    value.assign(characters.begin(), characters.end());
+    return true;
+}
+
+} // namespace
+
+ModelCache::ModelCache(std::string directory)
+        : directory_{std::move(directory)}, enabled_{false} {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        spdlog::warn("RG::MODEL_CACHE: Failed to create \"{}\": {}",
+                     directory_, error.message());
+        return;
+    }
+    enabled_ = true;
+}
+
+std::uint64_t ModelCache::key(const std::string& path) const {
+    namespace fs = std::filesystem;
+    std::uint64_t h = hash(FNV_OFFSET, path.data(), path.size());
+    h = hashFile(h, path);
+
+    // Sorted, as directory order is unspecified
+    std::vector<fs::path> libraries;
+    std::error_code error;
+    for (const auto& entry :
+         fs::directory_iterator{fs::path{path}.parent_path(), error})
+        if (entry.path().extension() == ".mtl")
+            libraries.push_back(entry.path());
+    std::sort(libraries.begin(), libraries.end());
+    for (const auto& library : libraries)
+        h = hashFile(h, library);
+    return h;
+}
+
+std::optional<ModelData> ModelCache::load(std::uint64_t key) const {
+    if (!enabled_)
+        return std::nullopt;
+
+    std::ifstream file{path(key), std::ios::binary};
+    if (!file)
+        return std::nullopt;
+
+    Header header{};
+    if (!read(file, header) || header.magic != MAGIC ||
+        header.version != VERSION || header.key != key ||
+        header.vertex_size != sizeof(PackedVertex))
+        return std::nullopt;
+
+    ModelData data;
+    bool complete = read(file, data.bounds) &&
+                    read(file, data.loaded_order) &&
+                    read(file, data.optimized_order);
+    data.meshes.resize(header.mesh_count);
+    for (auto& mesh : data.meshes)
+        complete = complete && read(file, mesh.vertices) &&
+                   read(file, mesh.indices) && read(file, mesh.lods) &&
+                   read(file, mesh.meshlets) &&
+                   read(file, mesh.quantization) && read(file, mesh.diffuse) &&
+                   read(file, mesh.specular) && read(file, mesh.features);
+    if (!complete) {
+        spdlog::warn("RG::MODEL_CACHE: {} is truncated, reimporting",
+                     path(key));
+        return std::nullopt;
+    }
+    data.valid = true;
+    return data;
+}
+
+void ModelCache::store(std::uint64_t key, const ModelData& data) const {
+    if (!enabled_ || !data.valid)
+        return;
+
+    // Written aside and moved into place, so a concurrent load never sees
+    // half a file
+    std::string temporary = path(key) + ".tmp";
+    {
+        std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+        write(file, Header{MAGIC, VERSION, key,
+                           static_cast<std::uint32_t>(sizeof(PackedVertex)),
+                           static_cast<std::uint32_t>(data.meshes.size())});
+        write(file, data.bounds);
+        write(file, data.loaded_order);
+        write(file, data.optimized_order);
+        for (const auto& mesh : data.meshes) {
+            write(file, mesh.vertices);
+            write(file, mesh.indices);
+            write(file, mesh.lods);
+            write(file, mesh.meshlets);
+            write(file, mesh.quantization);
+            write(file, mesh.diffuse);
+            write(file, mesh.specular);
+            write(file, mesh.features);
+        }
+        if (!file) {
+            spdlog::warn("RG::MODEL_CACHE: Failed to write {}", temporary);
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path(key), error);
+    if (error)
+        spdlog::warn("RG::MODEL_CACHE: Failed to write {}: {}", path(key),
+                     error.message());
+}
+
+bool ModelCache::is_enabled() const {
+    return enabled_;
+}
+
+std::string ModelCache::path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.model",
+                  static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+} // namespace rg
@@ -5,13 +5,14 @@
 
 namespace rg {
 
-Skybox::Skybox(const std::string& path, const std::vector<std::string>& faces)
-        : Skybox{path, faces, util::fullCube()} {
+Skybox::Skybox(const std::string& path, const std::vector<std::string>& faces,
+               JobSystem* jobs)
+        : Skybox{path, faces, util::fullCube(), jobs} {
 }
 
 Skybox::Skybox(const std::string& path, const std::vector<std::string>& faces,
-               std::shared_ptr<MeshVertexData> cube)
-        : cube_{std::move(cube)}, cubemap_{path, faces} {
+               std::shared_ptr<MeshVertexData> cube, JobSystem* jobs)
+        : cube_{std::move(cube)}, cubemap_{path, faces, jobs} {
 }
 
 void Skybox::draw(const Shader& shader) const {
@@ -21,8 +22,8 @@ void Skybox::draw(const Shader& shader) const {
     cubemap_.bind();
     cube_->vertex_array.bind();
     cube_->index_buffer.bind();
-    glDrawElements(GL_TRIANGLES, cube_->index_buffer.count(), GL_UNSIGNED_INT,
-                   nullptr);
+    glDrawElements(GL_TRIANGLES, cube_->index_buffer.count(),
+                   cube_->index_buffer.type(), nullptr);
     cube_->vertex_array.unbind();
     cube_->index_buffer.unbind();
 }
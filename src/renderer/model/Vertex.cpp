@@ -2,8 +2,35 @@
 
 #include <rg/util/layouts.hpp>
 
+#include <glm/common.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace rg {
 
+namespace {
+
+// Project the unit normal onto the octahedron and unfold the lower half over
+// the upper one, so it fits in [-1, 1]^2
+glm::vec2 octahedral(glm::vec3 normal) {
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum == 0.0f)
+        return glm::vec2{0.0f};
+    glm::vec2 folded{normal.x / sum, normal.y / sum};
+    if (normal.z < 0.0f)
+        folded = glm::vec2{
+                (1.0f - std::abs(folded.y)) * (folded.x >= 0.0f ? 1.0f : -1.0f),
+                (1.0f - std::abs(folded.x)) *
+                        (folded.y >= 0.0f ? 1.0f : -1.0f)};
+    return folded;
+}
+
+} // namespace
+
 Vertex::Vertex() : position{0.0f}, normal{0.0f}, texture_coordinates{0.0f} {
 }
 
@@ -13,13 +40,46 @@ Vertex::Vertex(glm::vec3 position, glm::vec3 normal,
                                                       texture_coordinates} {
 }
 
+VertexQuantization findQuantization(const std::vector<Vertex>& vertices) {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+    for (const auto& vertex : vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+    if (vertices.empty())
+        return VertexQuantization{glm::vec3{0.0f}, 1.0f};
+
+    glm::vec3 half = (max - min) / 2.0f;
+    float scale = std::max({half.x, half.y, half.z});
+    // A single point still needs a scale to divide by
+    if (scale <= 0.0f)
+        scale = 1.0f;
+    return VertexQuantization{min + half, scale};
+}
+
+PackedVertex pack(const Vertex& vertex,
+                  const VertexQuantization& quantization) {
+    glm::vec3 position =
+            (vertex.position - quantization.offset) / quantization.scale;
+    return PackedVertex{
+            glm::packSnorm4x16(glm::vec4{position, 1.0f}),
+            glm::packSnorm2x16(octahedral(vertex.normal)),
+            glm::packHalf2x16(vertex.texture_coordinates)};
+}
+
 } // namespace rg
 
 namespace rg::util {
 
 template <>
 VertexLayout layout<Vertex>() {
-    return {element<glm::vec3>(), element<glm::vec3>(), element<glm::vec2>()};
+    return Vertex::Layout::layout();
+}
+
+template <>
+VertexLayout layout<PackedVertex>() {
+    return PackedVertex::Layout::layout();
 }
 
 } // namespace rg::util
@@ -1,7 +1,236 @@
 #include <rg/renderer/render.hpp>
 
+#include <rg/renderer/camera/Frustum.hpp>
+#include <rg/renderer/shader/UniformBlocks.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
 namespace rg {
 
+namespace {
+
+// Must match local_size in cull.cs.glsl
+constexpr std::uint32_t CULL_GROUP_SIZE = 64;
+// The largest texture size requested, for items the camera is inside of
+constexpr float MAX_TEXTURE_REQUEST = 16384.0f;
+// The cone of a candidate which is not a meshlet
+const glm::vec4 NO_CONE{0.0f, 0.0f, 0.0f, 1.0f};
+
+// A mesh of a draw item along with the index of its per draw data
+struct MeshDraw {
+    const Mesh* mesh;
+    // Of the whole model
+    const BoundingSphere* bounds;
+    std::uint32_t program;
+    std::uint32_t vertex_array;
+    std::uint64_t textures;
+    std::uint32_t index;
+    std::uint32_t lod;
+    // Culled meshlet by meshlet, for lit meshes at full detail
+    bool clustered;
+};
+
+// A batch of culling candidates
+struct CullBatch {
+    const MeshDraw* first;
+    std::uint32_t first_candidate;
+    std::uint32_t size;
+    bool textured;
+};
+
+// Reused between the frames recorded by a thread, so that recording does not
+// allocate once the vectors have grown
+struct RecordScratch {
+    std::vector<DrawData> draws;
+    std::vector<MeshDraw> lit;
+    std::vector<MeshDraw> emissive;
+    std::vector<DrawElementsIndirectCommand> indirect;
+    std::vector<CullCandidate> candidates;
+    std::vector<CullBatch> batches;
+};
+
+thread_local RecordScratch scratch;
+
+// Whether a meshlet drawn with the data may be seen from the camera: the
+// backface test of cull.cs.glsl along with the frustum one
+bool visible(const Meshlet& meshlet, const DrawData& draw,
+             const Frustum& frustum, const glm::vec3& camera) {
+    BoundingSphere bounds =
+            BoundingSphere{glm::vec3{meshlet.sphere}, meshlet.sphere.w}
+                    .transformed(draw.model_matrix);
+    if (!frustum.intersects(bounds))
+        return false;
+    if (meshlet.cone.w >= 1.0f)
+        return true;
+
+    glm::vec3 axis = glm::normalize(glm::mat3{draw.normal_matrix} *
+                                    glm::vec3{meshlet.cone});
+    glm::vec3 to_center = bounds.center - camera;
+    return glm::dot(to_center, axis) <
+           meshlet.cone.w * glm::length(to_center) + bounds.radius;
+}
+
+glm::vec4 quantization(const Mesh& mesh) {
+    const auto& quantization = mesh.quantization();
+    return glm::vec4{quantization.offset, quantization.scale};
+}
+
+// Write the per draw data of every mesh in the list, and record the view and
+// the data. Lit meshes get the variant of their material under the lights,
+// and every mesh the level of detail the selector picks.
+void collect(const ShaderVariants& shaders, std::uint32_t light_features,
+             const Shader& light_shader, const View& view, LodSelector& lods,
+             const DrawList& list, CommandBuffer& commands) {
+    scratch.draws.clear();
+    scratch.lit.clear();
+    scratch.emissive.clear();
+
+    for (const auto& item : list.lit) {
+        float scale = lods.scale(item.id, *item.model, item.model_matrix);
+        for (const auto& mesh : item.model->get_meshes()) {
+            auto index = static_cast<std::uint32_t>(scratch.draws.size());
+            scratch.draws.push_back(DrawData{item.model_matrix,
+                                             item.normal_matrix,
+                                             glm::vec4{1.0f},
+                                             item.shininess,
+                                             mesh.material(),
+                                             {},
+                                             quantization(mesh)});
+            const auto& shader = shaders.get(mesh.features() | light_features);
+            auto lod = LodSelector::select(mesh, scale);
+            scratch.lit.push_back({&mesh, &item.model->get_bounds(),
+                                   shader.id(), mesh.vertex_array_id(),
+                                   mesh.texture_key(), index, lod,
+                                   lod == 0 && !mesh.meshlets().empty()});
+        }
+    }
+    for (const auto& item : list.emissive) {
+        float scale = lods.scale(item.id, *item.model, item.model_matrix);
+        for (const auto& mesh : item.model->get_meshes()) {
+            auto index = static_cast<std::uint32_t>(scratch.draws.size());
+            scratch.draws.push_back(DrawData{item.model_matrix,
+                                             glm::mat4{1.0f},
+                                             glm::vec4{item.color, 1.0f},
+                                             0.0f,
+                                             0,
+                                             {},
+                                             quantization(mesh)});
+            scratch.emissive.push_back({&mesh, &item.model->get_bounds(),
+                                        light_shader.id(),
+                                        mesh.vertex_array_id(), 0, index,
+                                        LodSelector::select(mesh, scale),
+                                        false});
+        }
+    }
+
+    commands.bind_uniforms(VIEW_BLOCK_BINDING, ViewBlock::from(view));
+    commands.bind_storage(DRAW_STORAGE_BINDING, scratch.draws.data(),
+                          scratch.draws.size());
+}
+
+// Sort the draws by the state they need, and call f(begin, end) on each run
+// of draws with equal state
+template <class F>
+void forEachBatch(std::vector<MeshDraw>& draws, bool textured, F&& f) {
+    std::sort(draws.begin(), draws.end(),
+              [](const MeshDraw& a, const MeshDraw& b) {
+                  if (a.program != b.program)
+                      return a.program < b.program;
+                  if (a.vertex_array != b.vertex_array)
+                      return a.vertex_array < b.vertex_array;
+                  return a.textures < b.textures;
+              });
+
+    for (std::size_t begin = 0; begin < draws.size();) {
+        const auto& first = draws[begin];
+        std::size_t end = begin + 1;
+        for (; end < draws.size(); ++end) {
+            const auto& draw = draws[end];
+            if (draw.program != first.program ||
+                draw.vertex_array != first.vertex_array ||
+                (textured && draw.textures != first.textures))
+                break;
+        }
+        f(begin, end);
+        begin = end;
+    }
+}
+
+// Record the state of the batch starting with first. The program is bound
+// only if it differs from the one of the previous batch.
+void recordBatchState(const MeshDraw& first, bool textured,
+                      std::uint32_t& program, CommandBuffer& commands) {
+    if (first.program != program) {
+        program = first.program;
+        commands.bind_program(program);
+    }
+    if (textured)
+        first.mesh->record_textures(commands);
+    commands.bind_vertex_array(first.vertex_array);
+}
+
+// Record one multi draw for each batch. The meshlets of clustered draws are
+// culled here, as there is no culling pass.
+void recordBatches(std::vector<MeshDraw>& draws, bool textured,
+                   const Frustum& frustum, const glm::vec3& camera,
+                   std::uint32_t& program, CommandBuffer& commands) {
+    auto& indirect = scratch.indirect;
+    forEachBatch(draws, textured, [&](std::size_t begin, std::size_t end) {
+        indirect.clear();
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& draw = draws[i];
+            if (!draw.clustered) {
+                indirect.push_back(draw.mesh->indirect(draw.index, draw.lod));
+                continue;
+            }
+            const auto& data = scratch.draws[draw.index];
+            for (const auto& meshlet : draw.mesh->meshlets())
+                if (visible(meshlet, data, frustum, camera))
+                    indirect.push_back(
+                            draw.mesh->indirect(draw.index, meshlet));
+        }
+        if (indirect.empty())
+            return;
+
+        recordBatchState(draws[begin], textured, program, commands);
+        commands.multi_draw_elements_indirect(indirect.data(),
+                                              indirect.size());
+    });
+}
+
+// Add a culling candidate for each draw, or for each meshlet of the
+// clustered ones, grouped in batches
+void addCandidates(std::vector<MeshDraw>& draws, bool textured) {
+    auto& candidates = scratch.candidates;
+    auto& batches = scratch.batches;
+    forEachBatch(draws, textured, [&](std::size_t begin, std::size_t end) {
+        auto batch = static_cast<std::uint32_t>(batches.size());
+        auto first = static_cast<std::uint32_t>(candidates.size());
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& draw = draws[i];
+            if (!draw.clustered) {
+                candidates.push_back(CullCandidate{
+                        glm::vec4{draw.bounds->center, draw.bounds->radius},
+                        NO_CONE, draw.mesh->indirect(draw.index, draw.lod),
+                        batch, first, 0});
+                continue;
+            }
+            for (const auto& meshlet : draw.mesh->meshlets())
+                candidates.push_back(CullCandidate{
+                        meshlet.sphere, meshlet.cone,
+                        draw.mesh->indirect(draw.index, meshlet), batch,
+                        first, 0});
+        }
+        auto size = static_cast<std::uint32_t>(candidates.size()) - first;
+        batches.push_back(CullBatch{&draws[begin], first, size, textured});
+    });
+}
+
+} // namespace
+
 void render(const Shader& shader, const Model& model,
             const Transform& transform) {
     shader.bind();
@@ -19,6 +248,119 @@ void render(const Shader& shader, const Model& model,
     shader.unbind();
 }
 
+void record(const ShaderVariants& shaders, std::uint32_t light_features,
+            const Shader& light_shader, const View& view, LodSelector& lods,
+            const DrawList& list, CommandBuffer& commands) {
+    collect(shaders, light_features, light_shader, view, lods, list,
+            commands);
+
+    std::uint32_t program = 0;
+    for (const auto* draws : {&scratch.lit, &scratch.emissive}) {
+        for (const auto& draw : *draws) {
+            if (draw.program != program) {
+                program = draw.program;
+                commands.bind_program(program);
+            }
+            draw.mesh->record(commands, draw.index, draw.lod);
+        }
+    }
+}
+
+void recordIndirect(const ShaderVariants& shaders,
+                    std::uint32_t light_features, const Shader& light_shader,
+                    const View& view, LodSelector& lods, const DrawList& list,
+                    CommandBuffer& commands) {
+    collect(shaders, light_features, light_shader, view, lods, list,
+            commands);
+
+    Frustum frustum{view};
+    std::uint32_t program = 0;
+    recordBatches(scratch.lit, true, frustum, view.position, program,
+                  commands);
+    // Light sources are not textured
+    recordBatches(scratch.emissive, false, frustum, view.position, program,
+                  commands);
+}
+
+void recordCulled(const ShaderVariants& shaders, std::uint32_t light_features,
+                  const Shader& light_shader, const Shader& cull_shader,
+                  const DepthPyramid& pyramid, const View& view,
+                  LodSelector& lods, const DrawList& list,
+                  CommandBuffer& commands) {
+    collect(shaders, light_features, light_shader, view, lods, list,
+            commands);
+
+    scratch.candidates.clear();
+    scratch.batches.clear();
+    addCandidates(scratch.lit, true);
+    addCandidates(scratch.emissive, false);
+    const auto& candidates = scratch.candidates;
+    const auto& batches = scratch.batches;
+
+    // Culling pass
+    // ------------
+    Frustum frustum{view};
+    CullBlock block{};
+    std::copy(frustum.get_planes().begin(), frustum.get_planes().end(),
+              block.planes);
+    block.pyramid_size = glm::vec2{static_cast<float>(pyramid.get_width()),
+                                   static_cast<float>(pyramid.get_height())};
+    block.pyramid_levels = pyramid.is_valid() ? pyramid.get_levels() : 0;
+    block.candidate_count = static_cast<std::uint32_t>(candidates.size());
+    block.z_near = view.z_near;
+
+    commands.bind_uniforms(CULL_BLOCK_BINDING, block);
+    commands.bind_storage(CANDIDATE_STORAGE_BINDING, candidates.data(),
+                          candidates.size());
+    // A slot for every candidate and a count for every batch
+    std::uint32_t culled = commands.bind_storage(
+            CULLED_STORAGE_BINDING,
+            candidates.size() * sizeof(DrawElementsIndirectCommand));
+    std::uint32_t counts = commands.bind_storage(
+            COUNT_STORAGE_BINDING, batches.size() * sizeof(std::uint32_t));
+    commands.bind_program(cull_shader.id());
+    commands.bind_texture(DEPTH_PYRAMID_TEXTURE_UNIT, pyramid.get_texture(),
+                          GL_TEXTURE_2D);
+    commands.dispatch_compute(static_cast<std::uint32_t>(
+            (candidates.size() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE));
+    commands.memory_barrier(GL_COMMAND_BARRIER_BIT);
+
+    // Draws
+    // -----
+    // The lit batches come first, then the light sources which are not
+    // textured. The culling program is still bound.
+    std::uint32_t program = cull_shader.id();
+    for (std::size_t i = 0; i < batches.size(); ++i) {
+        const auto& batch = batches[i];
+        recordBatchState(*batch.first, batch.textured, program, commands);
+        auto offset = static_cast<std::uint32_t>(
+                batch.first_candidate * sizeof(DrawElementsIndirectCommand));
+        auto count_offset =
+                static_cast<std::uint32_t>(i * sizeof(std::uint32_t));
+        commands.multi_draw_elements_indirect_count(
+                culled + offset, counts + count_offset, batch.size);
+    }
+}
+
+void requestMips(MaterialLibrary& library, const View& view,
+                 unsigned int height, const DrawList& list) {
+    // Pixels per unit of size at a distance of one
+    float scale = static_cast<float>(height) /
+                  std::tan(glm::radians(view.vertical_fov) / 2.0f);
+    for (const auto& item : list.lit) {
+        BoundingSphere bounds =
+                item.model->get_bounds().transformed(item.model_matrix);
+        float distance = glm::length(bounds.center - view.position);
+        float size = distance > bounds.radius
+                             ? bounds.radius * scale / distance
+                             : MAX_TEXTURE_REQUEST;
+        auto pixels = static_cast<unsigned int>(
+                std::min(size, MAX_TEXTURE_REQUEST));
+        for (const auto& mesh : item.model->get_meshes())
+            library.request(mesh.material(), pixels);
+    }
+}
+
 void render(const Shader& skybox_shader, const Skybox& skybox) {
     glDepthMask(GL_FALSE);
     glDepthFunc(GL_LEQUAL);
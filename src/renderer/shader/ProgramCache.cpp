@@ -0,0 +1,159 @@
+#include <rg/renderer/shader/ProgramCache.hpp>
+
+#include <glad/glad.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace rg {
+
+namespace {
+
+// Written before the binary, to reject files of another layout
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t format;
+    std::uint64_t key;
+};
+
+constexpr std::uint32_t MAGIC = 0x52475042; // RGPB
+
+// FNV-1a
+constexpr std::uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+std::uint64_t hash(std::uint64_t h, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+std::string glString(GLenum name) {
+    const auto* value = reinterpret_cast<const char*>(glGetString(name));
+    return value == nullptr ? std::string{} : std::string{value};
+}
+
+} // namespace
+
+ProgramCache::ProgramCache(std::string directory)
+        : directory_{std::move(directory)}, driver_{}, enabled_{false},
+          programs_{0}, hits_{0}, time_{0.0} {
+    driver_ = glString(GL_VENDOR) + '\n' + glString(GL_RENDERER) + '\n' +
+              glString(GL_VERSION);
+
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats == 0) {
+        spdlog::warn("RG::PROGRAM_CACHE: The driver supports no program "
+                     "binary formats, the cache is disabled");
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        spdlog::warn("RG::PROGRAM_CACHE: Failed to create \"{}\": {}",
+                     directory_, error.message());
+        return;
+    }
+    enabled_ = true;
+}
+
+std::uint64_t ProgramCache::key(const std::vector<Stage>& stages) const {
+    std::uint64_t h = hash(FNV_OFFSET, driver_.data(), driver_.size());
+    for (const auto& [type, source] : stages) {
+        h = hash(h, &type, sizeof(type));
+        h = hash(h, source->data(), source->size());
+    }
+    return h;
+}
+
+unsigned int ProgramCache::load(std::uint64_t key) {
+    if (!enabled_)
+        return 0;
+
+    std::ifstream file{path(key), std::ios::binary};
+    if (!file)
+        return 0;
+
+    Header header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::vector<char> binary{std::istreambuf_iterator<char>{file},
+                             std::istreambuf_iterator<char>{}};
+    file.close();
+    if (header.magic != MAGIC || header.key != key || binary.empty()) {
+        std::remove(path(key).c_str());
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+
+    int success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE) {
+        // Most likely written by another build of the driver
+        spdlog::info("RG::PROGRAM_CACHE: Binary {:016x} rejected, rebuilding",
+                     key);
+        glDeleteProgram(program);
+        std::remove(path(key).c_str());
+        return 0;
+    }
+
+    ++hits_;
+    return program;
+}
+
+void ProgramCache::store(std::uint64_t key, unsigned int program) const {
+    if (!enabled_ || program == 0)
+        return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    Header header{MAGIC, format, key};
+    std::ofstream file{path(key), std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if (!file)
+        spdlog::warn("RG::PROGRAM_CACHE: Failed to write {}", path(key));
+}
+
+void ProgramCache::count(std::chrono::duration<double, std::milli> time) {
+    ++programs_;
+    time_ += time;
+}
+
+void ProgramCache::report() const {
+    const char* kind = hits_ == 0 ? "cold" : hits_ == programs_ ? "warm"
+                                                                : "partial";
+    spdlog::info("RG::PROGRAM_CACHE: {} programs in {:.1f} ms, {} from the "
+                 "cache ({})",
+                 programs_, time_.count(), hits_, kind);
+}
+
+bool ProgramCache::is_enabled() const {
+    return enabled_;
+}
+
+std::string ProgramCache::path(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin",
+                  static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+} // namespace rg
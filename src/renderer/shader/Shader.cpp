@@ -1,68 +1,35 @@
 #include <rg/renderer/shader/Shader.hpp>
 
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+
 #include <glad/glad.h>
 
 #include <spdlog/spdlog.h>
 
 namespace rg {
 
-namespace {
-
-unsigned int compileShader(unsigned int type, const std::string& source) {
-    const char* c_string_source = source.c_str();
-    unsigned int id = glCreateShader(type);
-    glShaderSource(id, 1, &c_string_source, nullptr);
-    glCompileShader(id);
-
-    int success, required_size;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &success);
-    if (success == GL_FALSE) {
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &required_size);
-        std::vector<char> tmp(required_size);
-        glGetShaderInfoLog(id, required_size, nullptr, tmp.data());
-        std::string error(tmp.begin(), tmp.end());
-
-        spdlog::error("RG::SHADER::COMPILE_SHADER: {}", error);
-        return 0;
-    }
-
-    return id;
-}
-
-unsigned int linkProgram(unsigned int vs, unsigned int fs) {
-    unsigned int id = glCreateProgram();
-    glAttachShader(id, vs);
-    glAttachShader(id, fs);
-    glLinkProgram(id);
-
-    int success, required_size;
-    glGetProgramiv(id, GL_LINK_STATUS, &success);
-    if (success == GL_FALSE) {
-        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &required_size);
-        std::vector<char> tmp(required_size);
-        glGetProgramInfoLog(id, required_size, nullptr, tmp.data());
-        std::string error(tmp.begin(), tmp.end());
-
-        spdlog::error("RG::SHADER::LINK_PROGRAM: {}", error);
-    }
-
-    return id;
+Shader Shader::compile(const std::string& vertexSource,
+                       const std::string& fragmentSource,
+                       const std::vector<std::string>& defines) {
+    ShaderCompiler compiler;
+    Shader shader = compiler.submit(vertexSource, fragmentSource, defines);
+    compiler.finish();
+    return shader;
 }
 
-} // namespace
-
 Shader Shader::compile(const std::string& vertexSource,
                        const std::string& fragmentSource) {
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexSource);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
-    unsigned int program = linkProgram(vs, fs);
-
-    glUseProgram(program);
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    ShaderCompiler compiler;
+    Shader shader = compiler.submit(vertexSource, fragmentSource);
+    compiler.finish();
+    return shader;
+}
 
-    return Shader{program};
+Shader Shader::compile(const std::string& computeSource) {
+    ShaderCompiler compiler;
+    Shader shader = compiler.submit(computeSource);
+    compiler.finish();
+    return shader;
 }
 
 int Shader::get_uniform_location(const std::string& name) const {
@@ -84,9 +51,24 @@ void Shader::unbind() const {
     glUseProgram(0);
 }
 
+unsigned int Shader::id() const {
+    return shader_id_;
+}
+
 Shader::Shader(unsigned int id) : shader_id_{id} {
 }
 
+Shader::Shader(Shader&& other) noexcept : shader_id_{other.shader_id_} {
+    other.shader_id_ = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+    glDeleteProgram(shader_id_);
+    shader_id_ = other.shader_id_;
+    other.shader_id_ = 0;
+    return *this;
+}
+
 Shader::~Shader() {
     glDeleteProgram(shader_id_);
 }
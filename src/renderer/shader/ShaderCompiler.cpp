@@ -0,0 +1,218 @@
+#include <rg/renderer/shader/ShaderCompiler.hpp>
+
+#include <glad/glad.h>
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+
+namespace rg {
+
+namespace {
+
+// KHR_parallel_shader_compile, which glad is not generated with
+constexpr GLenum COMPLETION_STATUS = 0x91B1;
+using MaxShaderCompilerThreads = void (*)(GLuint count);
+
+// Whether COMPLETION_STATUS may be queried
+bool parallel = false;
+// Set with ShaderCompiler::use_cache
+ProgramCache* program_cache = nullptr;
+
+bool hasExtension(const char* name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; ++i) {
+        const auto* extension = reinterpret_cast<const char*>(
+                glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension != nullptr && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+unsigned int startShader(unsigned int type, const std::string& source) {
+    const char* c_string_source = source.c_str();
+    unsigned int id = glCreateShader(type);
+    glShaderSource(id, 1, &c_string_source, nullptr);
+    glCompileShader(id);
+    return id;
+}
+
+// Log the errors of the shader, if it failed to compile
+bool checkShader(unsigned int id) {
+    int success, required_size;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &success);
+    if (success == GL_FALSE) {
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &required_size);
+        std::vector<char> tmp(required_size);
+        glGetShaderInfoLog(id, required_size, nullptr, tmp.data());
+        std::string error(tmp.begin(), tmp.end());
+
+        spdlog::error("RG::SHADER::COMPILE_SHADER: {}", error);
+        return false;
+    }
+    return true;
+}
+
+unsigned int startProgram(const std::vector<unsigned int>& shaders) {
+    unsigned int id = glCreateProgram();
+    for (unsigned int shader : shaders)
+        glAttachShader(id, shader);
+    if (program_cache != nullptr && program_cache->is_enabled())
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(id);
+    return id;
+}
+
+// Log the errors of the program, if it failed to link
+bool checkProgram(unsigned int id) {
+    int success, required_size;
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE) {
+        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &required_size);
+        std::vector<char> tmp(required_size);
+        glGetProgramInfoLog(id, required_size, nullptr, tmp.data());
+        std::string error(tmp.begin(), tmp.end());
+
+        spdlog::error("RG::SHADER::LINK_PROGRAM: {}", error);
+        return false;
+    }
+    return true;
+}
+
+// Insert a #define line for each of the defines after the #version line,
+// which has to stay the first line of the source
+std::string injectDefines(const std::string& source,
+                          const std::vector<std::string>& defines) {
+    std::string lines;
+    for (const auto& define : defines)
+        lines += "#define " + define + "\n";
+
+    std::size_t version = source.find("#version");
+    std::size_t position = version == std::string::npos
+                                   ? 0
+                                   : source.find('\n', version);
+    if (position == std::string::npos)
+        return source + "\n" + lines;
+    if (version != std::string::npos)
+        ++position;
+
+    std::string result = source;
+    result.insert(position, lines);
+    return result;
+}
+
+} // namespace
+
+void ShaderCompiler::enableParallel(ProcLoader get_proc_address) {
+    const char* name = nullptr;
+    if (hasExtension("GL_KHR_parallel_shader_compile"))
+        name = "glMaxShaderCompilerThreadsKHR";
+    else if (hasExtension("GL_ARB_parallel_shader_compile"))
+        name = "glMaxShaderCompilerThreadsARB";
+    if (name == nullptr) {
+        spdlog::info("RG::SHADER_COMPILER: No parallel shader compilation");
+        return;
+    }
+
+    auto max_threads = reinterpret_cast<MaxShaderCompilerThreads>(
+            get_proc_address(name));
+    if (max_threads != nullptr)
+        // Let the driver pick the number of threads
+        max_threads(0xFFFFFFFFU);
+    parallel = true;
+    spdlog::info("RG::SHADER_COMPILER: Compiling in parallel");
+}
+
+void ShaderCompiler::use_cache(ProgramCache* cache) {
+    program_cache = cache;
+}
+
+ShaderCompiler::~ShaderCompiler() {
+    finish();
+}
+
+Shader ShaderCompiler::submit(const std::string& vertex_source,
+                              const std::string& fragment_source) {
+    return submit({{GL_VERTEX_SHADER, &vertex_source},
+                   {GL_FRAGMENT_SHADER, &fragment_source}});
+}
+
+Shader ShaderCompiler::submit(const std::string& vertex_source,
+                              const std::string& fragment_source,
+                              const std::vector<std::string>& defines) {
+    return submit(injectDefines(vertex_source, defines),
+                  injectDefines(fragment_source, defines));
+}
+
+Shader ShaderCompiler::submit(const std::string& compute_source) {
+    return submit({{GL_COMPUTE_SHADER, &compute_source}});
+}
+
+Shader ShaderCompiler::submit(const std::vector<ProgramCache::Stage>& stages) {
+    auto start = Clock::now();
+
+    std::uint64_t key = 0;
+    if (program_cache != nullptr) {
+        key = program_cache->key(stages);
+        if (unsigned int program = program_cache->load(key)) {
+            program_cache->count(Clock::now() - start);
+            return Shader{program};
+        }
+    }
+
+    Pending pending{0, {}, key, {}};
+    for (const auto& [type, source] : stages)
+        pending.shaders.push_back(startShader(type, *source));
+    pending.program = startProgram(pending.shaders);
+    pending.time = Clock::now() - start;
+    pending_.push_back(pending);
+    return Shader{pending.program};
+}
+
+bool ShaderCompiler::ready() const {
+    if (!parallel)
+        return true;
+
+    for (const auto& pending : pending_) {
+        int done = GL_FALSE;
+        glGetProgramiv(pending.program, COMPLETION_STATUS, &done);
+        if (done == GL_FALSE)
+            return false;
+    }
+    return true;
+}
+
+bool ShaderCompiler::finish() {
+    bool success = true;
+    for (auto& pending : pending_) {
+        auto start = Clock::now();
+
+        bool compiled = true;
+        for (unsigned int shader : pending.shaders)
+            compiled = checkShader(shader) && compiled;
+        bool linked = compiled && checkProgram(pending.program);
+        success = success && linked;
+        for (unsigned int shader : pending.shaders) {
+            glDetachShader(pending.program, shader);
+            glDeleteShader(shader);
+        }
+
+        if (program_cache != nullptr) {
+            if (linked)
+                program_cache->store(pending.key, pending.program);
+            program_cache->count(pending.time + (Clock::now() - start));
+        }
+    }
+    pending_.clear();
+    return success;
+}
+
+bool ShaderCompiler::linked(const Shader& shader) {
+    int success = GL_FALSE;
+    glGetProgramiv(shader.id(), GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+} // namespace rg
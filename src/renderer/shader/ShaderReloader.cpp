@@ -0,0 +1,152 @@
+#include <rg/renderer/shader/ShaderReloader.hpp>
+
+#include <rg/util/FileLoader.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace rg {
+
+ShaderReloader::ShaderReloader(std::string directory)
+        : directory_{std::move(directory)}, watcher_{directory_},
+          entries_{}, compiler_{}, replacements_{} {
+}
+
+void ShaderReloader::watch(Shader& shader, std::string vertex_file,
+                           std::string fragment_file, Init init) {
+    entries_.push_back(Entry{{std::move(vertex_file), std::move(fragment_file)},
+                             &shader,
+                             nullptr,
+                             std::move(init)});
+}
+
+void ShaderReloader::watch(Shader& shader, std::string compute_file,
+                           Init init) {
+    entries_.push_back(Entry{{std::move(compute_file)}, &shader, nullptr,
+                             std::move(init)});
+}
+
+void ShaderReloader::watch(ShaderVariants& variants, std::string vertex_file,
+                           std::string fragment_file) {
+    entries_.push_back(Entry{{std::move(vertex_file), std::move(fragment_file)},
+                             nullptr,
+                             &variants,
+                             {}});
+}
+
+void ShaderReloader::update() {
+    if (compiler_ != nullptr) {
+        // Check again next frame, the driver is still compiling
+        if (!compiler_->ready())
+            return;
+        commit();
+    }
+
+    auto changed = watcher_.poll();
+    if (!changed.empty())
+        start(changed);
+}
+
+void ShaderReloader::start(const std::vector<std::string>& changed) {
+    // The resource pack was built before the edits
+    util::ResourcePack::unmount();
+
+    std::vector<std::size_t> affected;
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        const auto& files = entries_[i].files;
+        bool edited = std::any_of(
+                files.begin(), files.end(), [&](const std::string& file) {
+                    return std::find(changed.begin(), changed.end(), file) !=
+                           changed.end();
+                });
+        if (!edited)
+            continue;
+
+        affected.push_back(i);
+        for (const auto& file : files)
+            paths.push_back(directory_ + "/" + file);
+    }
+    if (affected.empty())
+        return;
+
+    // The sources of every affected program in one batch
+    auto sources = util::FileLoader::shared().read_files(paths);
+    if (compiler_ == nullptr)
+        compiler_ = std::make_unique<ShaderCompiler>();
+
+    std::size_t next = 0;
+    for (std::size_t i : affected) {
+        const auto& entry = entries_[i];
+        Replacement replacement{i, {}, std::nullopt, {}};
+        for (const auto& file : entry.files) {
+            auto& source = sources[next++];
+            if (!source)
+                spdlog::error("RG::SHADER_RELOADER: Cannot read {}", file);
+            replacement.sources.push_back(std::move(source).value_or(""));
+        }
+        const auto& stages = replacement.sources;
+
+        if (entry.variants != nullptr)
+            replacement.variants =
+                    entry.variants->rebuild(stages[0], stages[1], *compiler_);
+        else if (stages.size() == 1)
+            replacement.shader.emplace(compiler_->submit(stages[0]));
+        else
+            replacement.shader.emplace(compiler_->submit(stages[0], stages[1]));
+        replacements_.push_back(std::move(replacement));
+    }
+
+    for (const auto& replacement : replacements_)
+        spdlog::info("RG::SHADER_RELOADER: Reloading {}",
+                     entries_[replacement.entry].files.back());
+}
+
+void ShaderReloader::commit() {
+    // The errors are logged per program, the ones which linked are still
+    // swapped in
+    compiler_->finish();
+    compiler_.reset();
+
+    std::size_t reloaded = 0;
+    for (auto& replacement : replacements_) {
+        const auto& entry = entries_[replacement.entry];
+        auto& sources = replacement.sources;
+        if (entry.variants != nullptr) {
+            bool linked = std::all_of(
+                    replacement.variants.begin(), replacement.variants.end(),
+                    [](const auto& variant) {
+                        return ShaderCompiler::linked(variant.second);
+                    });
+            if (!linked) {
+                // Dropped along with their programs
+                spdlog::error("RG::SHADER_RELOADER: Keeping the previous "
+                              "programs of {}",
+                              entry.files.back());
+                continue;
+            }
+            entry.variants->replace(std::move(sources[0]),
+                                    std::move(sources[1]),
+                                    std::move(replacement.variants));
+        } else {
+            if (!ShaderCompiler::linked(*replacement.shader)) {
+                spdlog::error("RG::SHADER_RELOADER: Keeping the previous "
+                              "program of {}",
+                              entry.files.back());
+                continue;
+            }
+            *entry.shader = std::move(*replacement.shader);
+            if (entry.init)
+                entry.init(*entry.shader);
+        }
+        ++reloaded;
+    }
+    spdlog::info("RG::SHADER_RELOADER: {} of {} shaders reloaded", reloaded,
+                 replacements_.size());
+    replacements_.clear();
+}
+
+} // namespace rg
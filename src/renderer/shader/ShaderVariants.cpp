@@ -0,0 +1,125 @@
+#include <rg/renderer/shader/ShaderVariants.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <utility>
+
+namespace rg {
+
+namespace {
+
+constexpr std::uint32_t COMPLETE = SPECULAR_MAP | POINT_LIGHTS | SPOTLIGHTS;
+
+// Unlit variants shade with neither the lights nor the specular map, so they
+// all share a single program
+std::uint32_t normalize(std::uint32_t features) {
+    return (features & UNLIT) != 0 ? UNLIT : features;
+}
+
+std::vector<std::string> defines(std::uint32_t features) {
+    static const std::array<std::pair<std::uint32_t, const char*>, 4> names{{
+            {SPECULAR_MAP, "SPECULAR_MAP"},
+            {UNLIT, "UNLIT"},
+            {POINT_LIGHTS, "POINT_LIGHTS"},
+            {SPOTLIGHTS, "SPOTLIGHTS"},
+    }};
+
+    std::vector<std::string> result;
+    for (const auto& [feature, name] : names)
+        if ((features & feature) != 0)
+            result.emplace_back(name);
+    return result;
+}
+
+} // namespace
+
+ShaderVariants::ShaderVariants(std::string vertex_source,
+                               std::string fragment_source, Init init)
+        : vertex_source_{std::move(vertex_source)},
+          fragment_source_{std::move(fragment_source)}, init_{std::move(init)},
+          variants_{}, uninitialized_{} {
+}
+
+void ShaderVariants::precompile(
+        const std::vector<std::uint32_t>& material_features,
+        ShaderCompiler& compiler) {
+    static constexpr std::array<std::uint32_t, 4> lights{
+            0, POINT_LIGHTS, SPOTLIGHTS, POINT_LIGHTS | SPOTLIGHTS};
+    submit(COMPLETE, compiler);
+    for (std::uint32_t material : material_features)
+        for (std::uint32_t light : lights)
+            submit((material & MATERIAL_FEATURES) | light, compiler);
+    spdlog::info("RG::SHADER_VARIANTS: {} variants submitted",
+                 uninitialized_.size());
+}
+
+void ShaderVariants::initialize() {
+    if (init_)
+        for (std::uint32_t features : uninitialized_)
+            init_(features, variants_.at(features));
+    uninitialized_.clear();
+}
+
+void ShaderVariants::submit(std::uint32_t features,
+                            ShaderCompiler& compiler) {
+    features = normalize(features);
+    if (variants_.count(features) != 0)
+        return;
+
+    variants_.emplace(features, compiler.submit(vertex_source_,
+                                                fragment_source_,
+                                                defines(features)));
+    uninitialized_.push_back(features);
+}
+
+const Shader& ShaderVariants::compile(std::uint32_t features) {
+    features = normalize(features);
+    auto it = variants_.find(features);
+    if (it != variants_.end())
+        return it->second;
+
+    it = variants_
+                 .emplace(features,
+                          Shader::compile(vertex_source_, fragment_source_,
+                                          defines(features)))
+                 .first;
+    if (init_)
+        init_(features, it->second);
+    return it->second;
+}
+
+ShaderVariants::Replacements
+ShaderVariants::rebuild(const std::string& vertex_source,
+                        const std::string& fragment_source,
+                        ShaderCompiler& compiler) const {
+    Replacements replacements;
+    for (const auto& [features, shader] : variants_)
+        replacements.emplace_back(features,
+                                  compiler.submit(vertex_source,
+                                                  fragment_source,
+                                                  defines(features)));
+    return replacements;
+}
+
+void ShaderVariants::replace(std::string vertex_source,
+                             std::string fragment_source,
+                             Replacements replacements) {
+    vertex_source_ = std::move(vertex_source);
+    fragment_source_ = std::move(fragment_source);
+    for (auto& [features, shader] : replacements) {
+        auto& variant = variants_.at(features);
+        variant = std::move(shader);
+        if (init_)
+            init_(features, variant);
+    }
+}
+
+const Shader& ShaderVariants::get(std::uint32_t features) const {
+    auto it = variants_.find(normalize(features));
+    if (it == variants_.end())
+        it = variants_.find(COMPLETE);
+    return it->second;
+}
+
+} // namespace rg
@@ -0,0 +1,11 @@
+#include <rg/renderer/shader/UniformBlocks.hpp>
+
+namespace rg {
+
+ViewBlock ViewBlock::from(const View& view) {
+    return ViewBlock{view.get_view_matrix(), view.get_projection_matrix(),
+                     glm::vec4{view.position, 1.0f},
+                     glm::vec4{view.direction, 0.0f}};
+}
+
+} // namespace rg
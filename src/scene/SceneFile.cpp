@@ -0,0 +1,478 @@
+#include <rg/scene/SceneFile.hpp>
+
+#include <rg/renderer/light/lights.hpp>
+#include <rg/util/ResourcePack.hpp>
+#include <rg/util/json.hpp>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RG_SCENE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rg::scene {
+
+namespace {
+
+using util::Json;
+
+void read(const Json* json, float* out, std::size_t n, float fallback) {
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = fallback;
+    if (json == nullptr)
+        return;
+
+    if (json->type() == Json::Type::NUMBER) {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = json->as_float();
+        return;
+    }
+
+    if (json->size() != n)
+        throw std::runtime_error{"SCENE::COMPILE: expected " +
+                                 std::to_string(n) + " components"};
+    for (std::size_t i = 0; i < n; ++i)
+        out[i] = (*json)[i].as_float();
+}
+
+float read(const Json* json, float fallback) {
+    return json == nullptr ? fallback : json->as_float();
+}
+
+void write(const glm::vec3& value, float* out) {
+    out[0] = value.x;
+    out[1] = value.y;
+    out[2] = value.z;
+}
+
+TransformRecord readTransform(const Json& json) {
+    TransformRecord record{};
+    read(json.find("position"), record.position, 3, 0.0f);
+    read(json.find("scale"), record.scale, 3, 1.0f);
+
+    // Rotations are written as Euler angles in degrees
+    float euler[3];
+    read(json.find("rotation"), euler, 3, 0.0f);
+    glm::quat orientation{
+            glm::radians(glm::vec3{euler[0], euler[1], euler[2]})};
+    record.orientation[0] = orientation.w;
+    record.orientation[1] = orientation.x;
+    record.orientation[2] = orientation.y;
+    record.orientation[3] = orientation.z;
+    return record;
+}
+
+ColorRecord readColor(const Json* json) {
+    static const LightColor defaults;
+    ColorRecord record{};
+    write(defaults.ambient, record.ambient);
+    write(defaults.diffuse, record.diffuse);
+    write(defaults.specular, record.specular);
+    if (json == nullptr)
+        return record;
+
+    read(json->find("ambient"), record.ambient, 3, defaults.ambient.x);
+    read(json->find("diffuse"), record.diffuse, 3, defaults.diffuse.x);
+    read(json->find("specular"), record.specular, 3, defaults.specular.x);
+    return record;
+}
+
+AttenuationRecord readAttenuation(const Json* json) {
+    static const LightAttenuation defaults;
+    if (json == nullptr)
+        return {defaults.constant, defaults.linear, defaults.quadratic};
+
+    return {read(json->find("constant"), defaults.constant),
+            read(json->find("linear"), defaults.linear),
+            read(json->find("quadratic"), defaults.quadratic)};
+}
+
+SpotLightRecord readSpotLight(const Json& json) {
+    SpotLightRecord record{};
+    read(json.find("position"), record.position, 3, 0.0f);
+    read(json.find("direction"), record.direction, 3, 0.0f);
+    if (json.find("direction") == nullptr)
+        record.direction[2] = -1.0f;
+
+    // Angles are written in degrees and stored as cosines
+    record.cutoff_angle =
+            glm::cos(glm::radians(read(json.find("cutoff"), 80.0f)));
+    record.weaken_angle =
+            glm::cos(glm::radians(read(json.find("weaken"), 60.0f)));
+    record.attenuation = readAttenuation(json.find("attenuation"));
+    record.color = readColor(json.find("color"));
+
+    const Json* follow = json.find("follow_camera");
+    if (follow != nullptr && follow->as_bool())
+        record.flags |= SPOTLIGHT_FOLLOW_CAMERA;
+    return record;
+}
+
+class Compiler {
+public:
+    std::vector<std::byte> compile(const Json& document) {
+        if (const Json* models = document.find("models"))
+            for (const auto& [name, path] : models->as_object())
+                addModel(name, path.as_string());
+
+        if (const Json* lights = document.find("lights"))
+            compileLights(*lights);
+        if (const Json* objects = document.find("objects"))
+            for (const auto& object : objects->as_array())
+                compileObject(object);
+        if (const Json* floors = document.find("floors"))
+            for (const auto& floor : floors->as_array())
+                compileFloor(floor);
+        if (const Json* cameras = document.find("cameras"))
+            for (const auto& camera : cameras->as_array())
+                compileCamera(camera);
+
+        return layout();
+    }
+
+private:
+    std::vector<ModelRecord> models_;
+    std::vector<ObjectRecord> objects_;
+    std::vector<FloorRecord> floors_;
+    std::vector<DirectionalLightRecord> directional_lights_;
+    std::vector<PointLightRecord> point_lights_;
+    std::vector<SpotLightRecord> spotlights_;
+    std::vector<CameraRecord> cameras_;
+    std::string strings_;
+    std::unordered_map<std::string, std::uint32_t> model_indices_;
+
+    std::uint32_t addString(const std::string& string) {
+        auto offset = static_cast<std::uint32_t>(strings_.size());
+        strings_.append(string);
+        strings_.push_back('\0');
+        return offset;
+    }
+
+    void addModel(const std::string& name, const std::string& path) {
+        model_indices_[name] = static_cast<std::uint32_t>(models_.size());
+        models_.push_back({addString(name), addString(path)});
+    }
+
+    std::uint32_t modelIndex(const Json& json) const {
+        const auto& name = json["model"].as_string();
+        auto it = model_indices_.find(name);
+        if (it == model_indices_.end())
+            throw std::runtime_error{"SCENE::COMPILE: unknown model \"" +
+                                     name + "\""};
+        return it->second;
+    }
+
+    void compileLights(const Json& lights) {
+        if (const Json* directional = lights.find("directional")) {
+            for (const auto& light : directional->as_array()) {
+                DirectionalLightRecord record{};
+                read(light.find("direction"), record.direction, 3, 0.0f);
+                record.color = readColor(light.find("color"));
+                directional_lights_.push_back(record);
+            }
+        }
+
+        if (const Json* point = lights.find("point")) {
+            for (const auto& light : point->as_array()) {
+                PointLightRecord record{};
+                read(light.find("position"), record.position, 3, 0.0f);
+                record.attenuation = readAttenuation(light.find("attenuation"));
+                record.color = readColor(light.find("color"));
+                point_lights_.push_back(record);
+            }
+        }
+
+        if (const Json* spot = lights.find("spot"))
+            for (const auto& light : spot->as_array())
+                spotlights_.push_back(readSpotLight(light));
+    }
+
+    void compileObject(const Json& json) {
+        ObjectRecord record{};
+        record.model = modelIndex(json);
+        record.transform = readTransform(json);
+        record.shininess = read(json.find("shininess"), 32.0f);
+
+        if (const Json* body = json.find("rigid_body")) {
+            record.flags |= OBJECT_RIGID_BODY;
+            read(body->find("velocity"), record.velocity, 3, 0.0f);
+            record.radius = read(body->find("radius"), 0.25f);
+        }
+
+        const Json* emissive = json.find("emissive");
+        if (emissive != nullptr && emissive->as_bool())
+            record.flags |= OBJECT_EMISSIVE;
+
+        // Attached lights are appended after the free-standing ones
+        if (const Json* light = json.find("light")) {
+            record.flags |= OBJECT_LIGHT;
+            record.spotlight = static_cast<std::uint32_t>(spotlights_.size());
+            read(light->find("offset"), record.light_offset, 3, 0.0f);
+            read(light->find("direction"), record.light_direction, 3, 0.0f);
+            spotlights_.push_back(readSpotLight(*light));
+        }
+
+        objects_.push_back(record);
+    }
+
+    void compileFloor(const Json& json) {
+        FloorRecord record{};
+        record.model = modelIndex(json);
+        record.transform = readTransform(json);
+        record.shininess = read(json.find("shininess"), 32.0f);
+        record.width = json["width"].as_int();
+        record.height = json["height"].as_int();
+        floors_.push_back(record);
+    }
+
+    void compileCamera(const Json& json) {
+        CameraRecord record{};
+        read(json.find("position"), record.position, 3, 0.0f);
+        read(json.find("direction"), record.direction, 3, 0.0f);
+        if (json.find("direction") == nullptr)
+            record.direction[2] = -1.0f;
+        record.fov = read(json.find("fov"), 60.0f);
+        record.z_near = read(json.find("near"), 0.01f);
+        record.z_far = read(json.find("far"), 50.0f);
+        cameras_.push_back(record);
+    }
+
+    template <class T>
+    Section append(std::vector<std::byte>& out, const std::vector<T>& records) {
+        Section section{static_cast<std::uint32_t>(out.size()),
+                        static_cast<std::uint32_t>(records.size())};
+        std::size_t bytes = records.size() * sizeof(T);
+        out.resize(out.size() + bytes);
+        if (bytes != 0)
+            std::memcpy(out.data() + section.offset, records.data(), bytes);
+        return section;
+    }
+
+    std::vector<std::byte> layout() {
+        std::vector<std::byte> out(sizeof(Header));
+        Header header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.models = append(out, models_);
+        header.objects = append(out, objects_);
+        header.floors = append(out, floors_);
+        header.directional_lights = append(out, directional_lights_);
+        header.point_lights = append(out, point_lights_);
+        header.spotlights = append(out, spotlights_);
+        header.cameras = append(out, cameras_);
+
+        std::vector<char> strings{strings_.begin(), strings_.end()};
+        while (strings.size() % 4 != 0)
+            strings.push_back('\0');
+        header.strings = append(out, strings);
+
+        header.size = static_cast<std::uint32_t>(out.size());
+        std::memcpy(out.data(), &header, sizeof(Header));
+        return out;
+    }
+};
+
+} // namespace
+
+std::vector<std::byte> SceneFile::compile(const std::string& json_source) {
+    return Compiler{}.compile(Json::parse(json_source));
+}
+
+SceneFile SceneFile::open(const std::string& path) {
+    SceneFile scene;
+    bool is_json = path.size() >= 5 && path.substr(path.size() - 5) == ".json";
+
+    if (is_json) {
+        std::string source;
+        if (auto packed = util::ResourcePack::lookup(path)) {
+            source = *packed;
+        } else {
+            std::ifstream file{path};
+            if (!file)
+                throw std::runtime_error{"SCENE::OPEN: cannot open " + path};
+            std::stringstream stream;
+            stream << file.rdbuf();
+            source = stream.str();
+        }
+        scene.owned_ = compile(source);
+    } else {
+#ifdef RG_SCENE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::runtime_error{"SCENE::OPEN: cannot open " + path};
+        struct stat info {};
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                                 PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                scene.mapping_ = mapping;
+                scene.data_ = static_cast<const std::byte*>(mapping);
+                scene.size_ = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        close(fd);
+#endif
+        if (scene.mapping_ == nullptr) {
+            std::ifstream file{path, std::ios::binary};
+            if (!file)
+                throw std::runtime_error{"SCENE::OPEN: cannot open " + path};
+            file.seekg(0, std::ios::end);
+            scene.owned_.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0, std::ios::beg);
+            file.read(reinterpret_cast<char*>(scene.owned_.data()),
+                      static_cast<std::streamsize>(scene.owned_.size()));
+        }
+    }
+
+    if (scene.mapping_ == nullptr) {
+        scene.data_ = scene.owned_.data();
+        scene.size_ = scene.owned_.size();
+    }
+    scene.validate();
+    return scene;
+}
+
+SceneFile::SceneFile() : data_{nullptr}, size_{0}, mapping_{nullptr} {
+}
+
+SceneFile::SceneFile(SceneFile&& other) noexcept
+        : data_{other.data_}, size_{other.size_}, mapping_{other.mapping_},
+          owned_{std::move(other.owned_)} {
+    if (mapping_ == nullptr)
+        data_ = owned_.data();
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+}
+
+SceneFile& SceneFile::operator=(SceneFile&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    release();
+    size_ = other.size_;
+    mapping_ = other.mapping_;
+    owned_ = std::move(other.owned_);
+    data_ = mapping_ == nullptr ? owned_.data() : other.data_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+    return *this;
+}
+
+SceneFile::~SceneFile() {
+    release();
+}
+
+void SceneFile::release() {
+#ifdef RG_SCENE_MMAP
+    if (mapping_ != nullptr)
+        munmap(mapping_, size_);
+#endif
+    mapping_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    owned_.clear();
+}
+
+const Header& SceneFile::header() const {
+    return *reinterpret_cast<const Header*>(data_);
+}
+
+template <class T>
+Records<T> SceneFile::section(const Section& section) const {
+    return Records<T>{reinterpret_cast<const T*>(data_ + section.offset),
+                      section.count};
+}
+
+void SceneFile::validate() const {
+    if (size_ < sizeof(Header))
+        throw std::runtime_error{"SCENE::VALIDATE: file too small"};
+
+    const auto& h = header();
+    if (h.magic != MAGIC)
+        throw std::runtime_error{"SCENE::VALIDATE: not a scene file"};
+    if (h.version != VERSION)
+        throw std::runtime_error{"SCENE::VALIDATE: unsupported version " +
+                                 std::to_string(h.version)};
+    if (h.size != size_)
+        throw std::runtime_error{"SCENE::VALIDATE: truncated file"};
+
+    auto check = [this](const Section& s, std::size_t record_size) {
+        std::size_t end = s.offset + std::size_t{s.count} * record_size;
+        if (s.offset % 4 != 0 || s.offset < sizeof(Header) || end > size_)
+            throw std::runtime_error{"SCENE::VALIDATE: corrupt section"};
+    };
+    check(h.models, sizeof(ModelRecord));
+    check(h.objects, sizeof(ObjectRecord));
+    check(h.floors, sizeof(FloorRecord));
+    check(h.directional_lights, sizeof(DirectionalLightRecord));
+    check(h.point_lights, sizeof(PointLightRecord));
+    check(h.spotlights, sizeof(SpotLightRecord));
+    check(h.cameras, sizeof(CameraRecord));
+    check(h.strings, 1);
+    if (h.strings.count == 0 ||
+        data_[h.strings.offset + h.strings.count - 1] != std::byte{0})
+        throw std::runtime_error{"SCENE::VALIDATE: corrupt string table"};
+
+    for (const auto& model : models())
+        if (model.name >= h.strings.count || model.path >= h.strings.count)
+            throw std::runtime_error{"SCENE::VALIDATE: corrupt model record"};
+    for (const auto& object : objects()) {
+        bool bad_light = (object.flags & OBJECT_LIGHT) != 0U &&
+                         object.spotlight >= h.spotlights.count;
+        if (object.model >= h.models.count || bad_light)
+            throw std::runtime_error{"SCENE::VALIDATE: corrupt object record"};
+    }
+    for (const auto& floor : floors())
+        if (floor.model >= h.models.count)
+            throw std::runtime_error{"SCENE::VALIDATE: corrupt floor record"};
+}
+
+Records<ModelRecord> SceneFile::models() const {
+    return section<ModelRecord>(header().models);
+}
+
+Records<ObjectRecord> SceneFile::objects() const {
+    return section<ObjectRecord>(header().objects);
+}
+
+Records<FloorRecord> SceneFile::floors() const {
+    return section<FloorRecord>(header().floors);
+}
+
+Records<DirectionalLightRecord> SceneFile::directional_lights() const {
+    return section<DirectionalLightRecord>(header().directional_lights);
+}
+
+Records<PointLightRecord> SceneFile::point_lights() const {
+    return section<PointLightRecord>(header().point_lights);
+}
+
+Records<SpotLightRecord> SceneFile::spotlights() const {
+    return section<SpotLightRecord>(header().spotlights);
+}
+
+Records<CameraRecord> SceneFile::cameras() const {
+    return section<CameraRecord>(header().cameras);
+}
+
+std::string_view SceneFile::string(std::uint32_t offset) const {
+    const auto* table =
+            reinterpret_cast<const char*>(data_ + header().strings.offset);
+    return std::string_view{table + offset};
+}
+
+} // namespace rg::scene
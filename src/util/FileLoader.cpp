@@ -0,0 +1,444 @@
+#include <rg/util/FileLoader.hpp>
+
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RG_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace rg::util {
+
+namespace {
+
+// Opens each file of a batch once
+class FileTable {
+public:
+    FileTable() = default;
+    FileTable(const FileTable& other) = delete;
+    FileTable operator=(const FileTable& other) = delete;
+
+    ~FileTable() {
+        for (const auto& [path, fd] : files_)
+            if (fd >= 0)
+                close(fd);
+    }
+
+    // -1 if it cannot be opened
+    int open(const std::string& path) {
+        auto it = files_.find(path);
+        if (it == files_.end()) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            it = files_.emplace(path, fd).first;
+        }
+        return it->second;
+    }
+
+private:
+    std::unordered_map<std::string, int> files_;
+};
+
+class PreadLoader : public FileLoader {
+public:
+    [[nodiscard]] const char* name() const override {
+        return "pread";
+    }
+
+protected:
+    void readBatch(std::vector<FileRead>& reads,
+                   const Completion& completed) override {
+        FileTable files;
+        for (auto& read : reads) {
+            int fd = files.open(read.path);
+            std::uint64_t done = 0;
+            while (fd >= 0 && done < read.size) {
+                ssize_t n = pread(fd, read.destination + done,
+                                  read.size - done,
+                                  static_cast<off_t>(read.offset + done));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += static_cast<std::uint64_t>(n);
+            }
+            read.complete = done == read.size;
+            completed(read);
+        }
+    }
+};
+
+#ifdef RG_IO_URING
+
+// Reads in flight at once
+constexpr unsigned int QUEUE_DEPTH = 64;
+// The kernel registers at most this many buffers in one call
+constexpr std::size_t MAX_REGISTERED_BUFFERS = 1024;
+// Of a single submission, larger reads are split
+constexpr std::uint64_t MAX_READ_SIZE = 1U << 30U;
+
+int setup(unsigned int entries, io_uring_params& params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+}
+
+int enter(int fd, unsigned int submit, unsigned int wait) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait,
+                                    IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+int registerBuffers(int fd, const std::vector<iovec>& buffers) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd,
+                                    IORING_REGISTER_BUFFERS, buffers.data(),
+                                    static_cast<unsigned int>(buffers.size())));
+}
+
+void unregisterBuffers(int fd) {
+    syscall(__NR_io_uring_register, fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+}
+
+/**
+ * Talks to the kernel through the system calls and the shared rings
+ * directly. The destinations are registered as fixed buffers where the
+ * memory lock limit allows, which saves mapping them on every read.
+ */
+class UringLoader : public FileLoader {
+public:
+    // nullptr if the kernel has no io_uring or does not allow it
+    static std::unique_ptr<UringLoader> create() {
+        std::unique_ptr<UringLoader> loader{new UringLoader{}};
+        return loader->map() ? std::move(loader) : nullptr;
+    }
+
+    UringLoader(const UringLoader& other) = delete;
+    UringLoader operator=(const UringLoader& other) = delete;
+
+    ~UringLoader() override {
+        if (sqes_ != MAP_FAILED)
+            munmap(sqes_, sqes_size_);
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+            munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED)
+            munmap(sq_ring_, sq_ring_size_);
+        if (fd_ >= 0)
+            close(fd_);
+    }
+
+    [[nodiscard]] const char* name() const override {
+        return "io_uring";
+    }
+
+protected:
+    void readBatch(std::vector<FileRead>& reads,
+                   const Completion& completed) override {
+        FileTable files;
+        std::vector<int> fds;
+        fds.reserve(reads.size());
+        for (auto& read : reads) {
+            fds.push_back(files.open(read.path));
+            read.complete = false;
+        }
+
+        bool fixed = false;
+        if (reads.size() <= MAX_REGISTERED_BUFFERS) {
+            std::vector<iovec> buffers;
+            for (const auto& read : reads)
+                buffers.push_back(iovec{read.destination, read.size});
+            fixed = registerBuffers(fd_, buffers) == 0;
+        }
+
+        // Submission
+        // ----------
+        // Short reads go back into the queue for the rest
+        std::vector<std::uint64_t> done(reads.size(), 0);
+        std::vector<std::size_t> queue;
+        for (std::size_t i = reads.size(); i-- > 0;)
+            if (fds[i] >= 0 && reads[i].size > 0)
+                queue.push_back(i);
+            else
+                reads[i].complete = fds[i] >= 0;
+
+        // Queued in the ring but not yet taken by the kernel
+        unsigned int unsubmitted = 0;
+        unsigned int in_flight = 0;
+        // Once the ring fails, the reads in flight are only waited for
+        bool failed = false;
+        while (!queue.empty() || unsubmitted + in_flight > 0) {
+            while (!queue.empty() &&
+                   unsubmitted + in_flight < QUEUE_DEPTH) {
+                std::size_t i = queue.back();
+                queue.pop_back();
+                push(reads[i], fds[i], done[i], i, fixed);
+                ++unsubmitted;
+            }
+
+            int submitted = enter(fd_, unsubmitted, 1);
+            if (submitted < 0 && errno != EINTR && !failed) {
+                // The kernel writes into the destinations of the reads in
+                // flight until they complete, so the batch cannot return
+                // before them. The ones it never took are taken back out of
+                // the ring, or they would go out with the next batch.
+                failed = true;
+                queue.clear();
+                __atomic_store_n(sq_tail_, *sq_tail_ - unsubmitted,
+                                 __ATOMIC_RELEASE);
+                unsubmitted = 0;
+            }
+            if (submitted > 0) {
+                unsubmitted -= static_cast<unsigned int>(submitted);
+                in_flight += static_cast<unsigned int>(submitted);
+            }
+
+            // Completion
+            // ----------
+            unsigned int head = *cq_head_;
+            unsigned int tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const auto& cqe = cqes_[head & *cq_mask_];
+                auto i = static_cast<std::size_t>(cqe.user_data);
+                --in_flight;
+                if (failed)
+                    continue;
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    queue.push_back(i);
+                    continue;
+                }
+                if (cqe.res <= 0) {
+                    completed(reads[i]);
+                    continue;
+                }
+                done[i] += static_cast<std::uint64_t>(cqe.res);
+                if (done[i] < reads[i].size) {
+                    queue.push_back(i);
+                    continue;
+                }
+                reads[i].complete = true;
+                completed(reads[i]);
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+
+        if (fixed)
+            unregisterBuffers(fd_);
+    }
+
+private:
+    int fd_ = -1;
+    void* sq_ring_ = MAP_FAILED;
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = MAP_FAILED;
+    std::size_t cq_ring_size_ = 0;
+    void* sqes_ = MAP_FAILED;
+    std::size_t sqes_size_ = 0;
+
+    unsigned int* sq_tail_ = nullptr;
+    unsigned int* sq_mask_ = nullptr;
+    unsigned int* sq_array_ = nullptr;
+    unsigned int* cq_head_ = nullptr;
+    unsigned int* cq_tail_ = nullptr;
+    unsigned int* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+
+    UringLoader() = default;
+
+    bool map() {
+        io_uring_params params{};
+        fd_ = setup(QUEUE_DEPTH, params);
+        if (fd_ < 0)
+            return false;
+
+        sq_ring_size_ =
+                params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        cq_ring_size_ =
+                params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single)
+            sq_ring_size_ = cq_ring_size_ =
+                    std::max(sq_ring_size_, cq_ring_size_);
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED)
+            return false;
+        cq_ring_ = single ? sq_ring_
+                          : mmap(nullptr, cq_ring_size_,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, fd_,
+                                 IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED)
+            return false;
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED)
+            return false;
+
+        auto* sq = static_cast<std::byte*>(sq_ring_);
+        auto* cq = static_cast<std::byte*>(cq_ring_);
+        sq_tail_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        sq_mask_ =
+                reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        cq_mask_ =
+                reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queue the rest of the read, past the done bytes
+    void push(const FileRead& read, int fd, std::uint64_t done,
+              std::size_t index, bool fixed) {
+        unsigned int tail = *sq_tail_;
+        unsigned int slot = tail & *sq_mask_;
+        auto& sqe = static_cast<io_uring_sqe*>(sqes_)[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.off = read.offset + done;
+        sqe.addr = reinterpret_cast<std::uint64_t>(read.destination + done);
+        sqe.len = static_cast<std::uint32_t>(
+                std::min(read.size - done, MAX_READ_SIZE));
+        if (fixed)
+            sqe.buf_index = static_cast<std::uint16_t>(index);
+        sqe.user_data = index;
+        sq_array_[slot] = slot;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    }
+};
+
+#endif // RG_IO_URING
+
+// The contents of a whole file, either in the mounted pack or read into a
+// buffer of its own
+struct WholeFile {
+    bool valid = false;
+    std::optional<std::string_view> packed;
+    std::string buffer;
+
+    [[nodiscard]] std::optional<std::string_view> contents() const {
+        if (!valid)
+            return std::nullopt;
+        return packed ? *packed : std::string_view{buffer};
+    }
+};
+
+// Hand each whole file to handle(index, file): the packed ones right away,
+// the others as their reads complete
+template <class F>
+void readWhole(FileLoader& loader, const std::vector<std::string>& paths,
+               F&& handle) {
+    std::vector<FileRead> reads;
+    std::vector<std::size_t> indices;
+    std::vector<std::string> buffers(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (auto packed = ResourcePack::lookup(paths[i])) {
+            handle(i, WholeFile{true, packed, {}});
+            continue;
+        }
+
+        std::error_code error;
+        auto size = std::filesystem::file_size(paths[i], error);
+        if (error) {
+            handle(i, WholeFile{});
+            continue;
+        }
+        buffers[i].resize(size);
+        reads.push_back(FileRead{paths[i], 0, size,
+                                 reinterpret_cast<std::byte*>(
+                                         buffers[i].data())});
+        indices.push_back(i);
+    }
+
+    // The other buffers may still be written while one is handed over
+    loader.read(reads, [&](const FileRead& read) {
+        std::size_t i = indices[static_cast<std::size_t>(&read - &reads[0])];
+        handle(i, WholeFile{read.complete, std::nullopt,
+                            std::move(buffers[i])});
+    });
+}
+
+} // namespace
+
+std::unique_ptr<FileLoader> FileLoader::create() {
+#ifdef RG_IO_URING
+    if (auto loader = UringLoader::create())
+        return loader;
+#endif
+    return std::make_unique<PreadLoader>();
+}
+
+FileLoader& FileLoader::shared() {
+    static const std::unique_ptr<FileLoader> loader = create();
+    return *loader;
+}
+
+void FileLoader::read(std::vector<FileRead>& reads,
+                      const Completion& completed) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::vector<bool> reported(reads.size(), false);
+    readBatch(reads, [&](const FileRead& read) {
+        reported[static_cast<std::size_t>(&read - &reads[0])] = true;
+        if (completed)
+            completed(read);
+    });
+
+    // Such as the reads of files which could not be opened, or of a batch
+    // the kernel gave up on
+    for (std::size_t i = 0; i < reads.size(); ++i)
+        if (!reported[i] && completed)
+            completed(reads[i]);
+}
+
+std::vector<std::optional<std::string>>
+FileLoader::read_files(const std::vector<std::string>& paths) {
+    std::vector<std::optional<std::string>> contents(paths.size());
+    readWhole(*this, paths, [&contents](std::size_t i, WholeFile file) {
+        if (file.valid && file.packed)
+            contents[i] = std::string{*file.packed};
+        else if (file.valid)
+            contents[i] = std::move(file.buffer);
+    });
+    return contents;
+}
+
+void FileLoader::submit(std::vector<FileJob> files, JobSystem* jobs) {
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto& file : files)
+        paths.push_back(file.path);
+
+    // Without workers a job would only run once something waits on it. The
+    // files are held until the batch is read, so that done may read too.
+    if (jobs == nullptr || jobs->worker_count() == 0) {
+        std::vector<WholeFile> read(files.size());
+        readWhole(*this, paths, [&read](std::size_t i, WholeFile file) {
+            read[i] = std::move(file);
+        });
+        for (std::size_t i = 0; i < files.size(); ++i)
+            files[i].done(read[i].contents());
+        return;
+    }
+
+    readWhole(*this, paths, [&files, jobs](std::size_t i, WholeFile file) {
+        jobs->run(
+                [done = std::move(files[i].done), file = std::move(file)] {
+                    done(file.contents());
+                },
+                *files[i].counter);
+    });
+}
+
+} // namespace rg::util
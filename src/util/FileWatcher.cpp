@@ -0,0 +1,119 @@
+#include <rg/util/FileWatcher.hpp>
+
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace rg::util {
+
+#ifdef __linux__
+
+namespace {
+
+// How long the thread blocks before it checks whether to stop
+constexpr int POLL_TIMEOUT_MS = 100;
+constexpr std::uint32_t EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+} // namespace
+
+FileWatcher::FileWatcher(std::string directory)
+        : directory_{std::move(directory)}, fd_{-1}, subdirectories_{},
+          stop_{false}, mutex_{}, changed_{}, thread_{} {
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    int root = fd_ < 0 ? -1
+                       : inotify_add_watch(fd_, directory_.c_str(), EVENTS);
+    if (root < 0) {
+        spdlog::warn("RG::FILE_WATCHER: Cannot watch \"{}\": {}", directory_,
+                     std::strerror(errno));
+        if (fd_ >= 0)
+            close(fd_);
+        fd_ = -1;
+        return;
+    }
+    subdirectories_.emplace(root, std::string{});
+
+    // Each directory needs a watch of its own
+    namespace fs = std::filesystem;
+    std::error_code error;
+    for (fs::recursive_directory_iterator it{directory_, error}, end;
+         !error && it != end; it.increment(error)) {
+        if (!it->is_directory())
+            continue;
+        int wd = inotify_add_watch(fd_, it->path().c_str(), EVENTS);
+        if (wd >= 0)
+            subdirectories_.emplace(
+                    wd, fs::relative(it->path(), directory_).generic_string());
+    }
+    thread_ = std::thread{[this] { run(); }};
+}
+
+FileWatcher::~FileWatcher() {
+    stop_.store(true);
+    if (thread_.joinable())
+        thread_.join();
+    if (fd_ >= 0)
+        close(fd_);
+}
+
+void FileWatcher::run() {
+    // Aligned for the inotify_event structs read into it
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor{fd_, POLLIN, 0};
+
+    while (!stop_.load()) {
+        if (::poll(&descriptor, 1, POLL_TIMEOUT_MS) <= 0)
+            continue;
+
+        ssize_t length;
+        while ((length = read(fd_, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock{mutex_};
+            for (ssize_t i = 0; i < length;) {
+                const auto* event =
+                        reinterpret_cast<const inotify_event*>(buffer + i);
+                auto it = subdirectories_.find(event->wd);
+                if (event->len > 0 && (event->mask & EVENTS) != 0 &&
+                    it != subdirectories_.end())
+                    changed_.insert(it->second.empty()
+                                            ? std::string{event->name}
+                                            : it->second + "/" + event->name);
+                i += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+    }
+}
+
+#else
+
+FileWatcher::FileWatcher(std::string directory)
+        : directory_{std::move(directory)}, fd_{-1}, subdirectories_{},
+          stop_{false}, mutex_{}, changed_{}, thread_{} {
+    spdlog::warn("RG::FILE_WATCHER: Not supported on this platform, \"{}\" "
+                 "is not watched",
+                 directory_);
+}
+
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::run() {
+}
+
+#endif // __linux__
+
+std::vector<std::string> FileWatcher::poll() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    std::vector<std::string> result{changed_.begin(), changed_.end()};
+    changed_.clear();
+    return result;
+}
+
+} // namespace rg::util
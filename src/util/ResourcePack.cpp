@@ -0,0 +1,285 @@
+#include <rg/util/ResourcePack.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RG_PACK_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rg::util {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Set with ResourcePack::mount, loaders look files up from any thread
+std::atomic<const ResourcePack*> mounted{nullptr};
+fs::path mount_directory;
+
+// Of each read of ResourcePack::read
+constexpr std::uint64_t READ_SIZE = std::uint64_t{1} << 20U;
+
+std::uint64_t align(std::uint64_t offset) {
+    return (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+}
+
+} // namespace
+
+ResourcePack ResourcePack::open(const std::string& path) {
+#ifdef RG_PACK_MMAP
+    ResourcePack pack;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error{"PACK::OPEN: cannot open " + path};
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                             PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            pack.mapping_ = mapping;
+            pack.data_ = static_cast<const std::byte*>(mapping);
+            pack.size_ = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    close(fd);
+    if (pack.mapping_ != nullptr) {
+        pack.validate();
+        return pack;
+    }
+#endif
+    // Without a mapping the pack is copied anyway, in as few requests as
+    // the loader manages
+    auto loader = FileLoader::create();
+    return read(path, *loader);
+}
+
+ResourcePack ResourcePack::read(const std::string& path, FileLoader& loader) {
+    std::error_code error;
+    std::uint64_t size = fs::file_size(path, error);
+    if (error)
+        throw std::runtime_error{"PACK::READ: cannot open " + path};
+
+    ResourcePack pack;
+    pack.owned_.resize(static_cast<std::size_t>(size));
+    std::vector<FileRead> reads;
+    for (std::uint64_t offset = 0; offset < size; offset += READ_SIZE)
+        reads.push_back(FileRead{path, offset,
+                                 std::min(READ_SIZE, size - offset),
+                                 pack.owned_.data() + offset});
+    loader.read(reads);
+    if (!std::all_of(reads.begin(), reads.end(),
+                     [](const FileRead& read) { return read.complete; }))
+        throw std::runtime_error{"PACK::READ: cannot read " + path};
+
+    pack.data_ = pack.owned_.data();
+    pack.size_ = pack.owned_.size();
+    pack.validate();
+    return pack;
+}
+
+void ResourcePack::write(const std::string& directory,
+                         const std::string& output) {
+    std::vector<std::string> paths;
+    for (const auto& entry : fs::recursive_directory_iterator{directory})
+        if (entry.is_regular_file())
+            paths.push_back(
+                    fs::relative(entry.path(), directory).generic_string());
+    std::sort(paths.begin(), paths.end());
+
+    // Table of contents
+    // -----------------
+    std::vector<PackEntry> entries;
+    std::string strings;
+    for (const auto& path : paths) {
+        entries.push_back(PackEntry{
+                0, fs::file_size(fs::path{directory} / path),
+                static_cast<std::uint32_t>(strings.size()),
+                static_cast<std::uint32_t>(path.size())});
+        strings += path;
+    }
+    std::uint64_t offset = align(sizeof(PackHeader) +
+                                 entries.size() * sizeof(PackEntry) +
+                                 strings.size());
+    for (auto& entry : entries) {
+        entry.offset = offset;
+        offset = align(offset + entry.size);
+    }
+    PackHeader header{PACK_MAGIC, PACK_VERSION,
+                      static_cast<std::uint32_t>(entries.size()),
+                      static_cast<std::uint32_t>(strings.size()), offset};
+
+    std::ofstream file{output, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()),
+               static_cast<std::streamsize>(entries.size() *
+                                            sizeof(PackEntry)));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+    // Contents
+    // --------
+    std::vector<char> contents;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const auto& entry = entries[i];
+        std::ifstream in{fs::path{directory} / paths[i], std::ios::binary};
+        contents.resize(entry.size);
+        in.read(contents.data(), static_cast<std::streamsize>(entry.size));
+        if (!in)
+            throw std::runtime_error{"PACK::WRITE: cannot read " + paths[i]};
+
+        auto position = static_cast<std::uint64_t>(file.tellp());
+        std::fill_n(std::ostreambuf_iterator<char>{file},
+                    entry.offset - position, '\0');
+        file.write(contents.data(), static_cast<std::streamsize>(entry.size));
+    }
+    // The last file is padded too, so that the size is the one in the header
+    auto position = static_cast<std::uint64_t>(file.tellp());
+    std::fill_n(std::ostreambuf_iterator<char>{file}, header.size - position,
+                '\0');
+    if (!file)
+        throw std::runtime_error{"PACK::WRITE: cannot write " + output};
+}
+
+void ResourcePack::mount(const ResourcePack& pack,
+                         const std::string& directory) {
+    mount_directory = fs::path{directory}.lexically_normal();
+    mounted.store(&pack, std::memory_order_release);
+}
+
+void ResourcePack::unmount() {
+    mounted.store(nullptr, std::memory_order_release);
+}
+
+std::optional<std::string_view> ResourcePack::lookup(const std::string& path) {
+    const auto* pack = mounted.load(std::memory_order_acquire);
+    if (pack == nullptr)
+        return std::nullopt;
+    // Loaders join paths themselves, e.g. "objects/ball/./bball.png"
+    auto relative = fs::path{path}.lexically_normal().lexically_relative(
+            mount_directory);
+    return pack->find(relative.generic_string());
+}
+
+ResourcePack::ResourcePack() : data_{nullptr}, size_{0}, mapping_{nullptr} {
+}
+
+ResourcePack::ResourcePack(ResourcePack&& other) noexcept
+        : data_{other.data_}, size_{other.size_}, mapping_{other.mapping_},
+          owned_{std::move(other.owned_)} {
+    if (mapping_ == nullptr)
+        data_ = owned_.data();
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+}
+
+ResourcePack& ResourcePack::operator=(ResourcePack&& other) noexcept {
+    if (this == &other)
+        return *this;
+
+    release();
+    size_ = other.size_;
+    mapping_ = other.mapping_;
+    owned_ = std::move(other.owned_);
+    data_ = mapping_ == nullptr ? owned_.data() : other.data_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+    return *this;
+}
+
+ResourcePack::~ResourcePack() {
+    release();
+}
+
+void ResourcePack::release() {
+#ifdef RG_PACK_MMAP
+    if (mapping_ != nullptr)
+        munmap(mapping_, size_);
+#endif
+    mapping_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    owned_.clear();
+}
+
+std::optional<std::string_view>
+ResourcePack::find(std::string_view path) const {
+    const auto* begin = entries();
+    const auto* end = begin + header().entry_count;
+    const auto* it = std::lower_bound(
+            begin, end, path, [this](const PackEntry& entry,
+                                     std::string_view key) {
+                return this->path(entry) < key;
+            });
+    if (it == end || this->path(*it) != path)
+        return std::nullopt;
+    return std::string_view{reinterpret_cast<const char*>(data_ + it->offset),
+                            static_cast<std::size_t>(it->size)};
+}
+
+std::size_t ResourcePack::file_count() const {
+    return header().entry_count;
+}
+
+std::size_t ResourcePack::size() const {
+    return size_;
+}
+
+bool ResourcePack::is_mapped() const {
+    return mapping_ != nullptr;
+}
+
+const PackHeader& ResourcePack::header() const {
+    return *reinterpret_cast<const PackHeader*>(data_);
+}
+
+const PackEntry* ResourcePack::entries() const {
+    return reinterpret_cast<const PackEntry*>(data_ + sizeof(PackHeader));
+}
+
+std::string_view ResourcePack::path(const PackEntry& entry) const {
+    const auto* strings = reinterpret_cast<const char*>(
+            data_ + sizeof(PackHeader) +
+            std::size_t{header().entry_count} * sizeof(PackEntry));
+    return std::string_view{strings + entry.path, entry.path_size};
+}
+
+void ResourcePack::validate() const {
+    if (size_ < sizeof(PackHeader))
+        throw std::runtime_error{"PACK::VALIDATE: file too small"};
+
+    const auto& h = header();
+    if (h.magic != PACK_MAGIC)
+        throw std::runtime_error{"PACK::VALIDATE: not a resource pack"};
+    if (h.version != PACK_VERSION)
+        throw std::runtime_error{"PACK::VALIDATE: unsupported version " +
+                                 std::to_string(h.version)};
+    if (h.size != size_)
+        throw std::runtime_error{"PACK::VALIDATE: truncated file"};
+
+    std::uint64_t table_end = sizeof(PackHeader) +
+                              std::uint64_t{h.entry_count} * sizeof(PackEntry);
+    if (table_end + h.strings_size > size_)
+        throw std::runtime_error{"PACK::VALIDATE: corrupt table"};
+    const auto* begin = entries();
+    for (const auto* entry = begin; entry != begin + h.entry_count; ++entry) {
+        if (entry->offset % PACK_ALIGNMENT != 0 || entry->offset > size_ ||
+            entry->size > size_ - entry->offset ||
+            std::uint64_t{entry->path} + entry->path_size > h.strings_size)
+            throw std::runtime_error{"PACK::VALIDATE: corrupt entry"};
+        if (entry != begin && !(path(entry[-1]) < path(*entry)))
+            throw std::runtime_error{"PACK::VALIDATE: unsorted entries"};
+    }
+}
+
+} // namespace rg::util
@@ -4,11 +4,11 @@ namespace rg::util {
 
 namespace {
 
+template <class Layout>
 std::shared_ptr<MeshVertexData> generate(const float* vertices,
                                          unsigned int vertices_size,
                                          const unsigned int* indices,
-                                         unsigned int indices_count,
-                                         const VertexLayout& layout) {
+                                         unsigned int indices_count) {
     std::shared_ptr<MeshVertexData> mesh_data =
             std::make_shared<MeshVertexData>();
     mesh_data->vertex_array.bind();
@@ -18,7 +18,7 @@ std::shared_ptr<MeshVertexData> generate(const float* vertices,
     mesh_data->index_buffer = IndexBuffer{indices, indices_count};
     mesh_data->index_buffer.bind();
 
-    mesh_data->vertex_array.recordLayout(mesh_data->vertex_buffer, layout);
+    mesh_data->vertex_array.recordLayout<Layout>(mesh_data->vertex_buffer);
     mesh_data->vertex_array.unbind();
     mesh_data->index_buffer.unbind();
     mesh_data->vertex_buffer.unbind();
@@ -35,11 +35,11 @@ std::shared_ptr<MeshVertexData> surfaceQuad() {
     };
 
     static const unsigned int indices[] = {0, 1, 2, 0, 2, 3};
-    static const VertexLayout layout{rg::util::elementf(2),
-                                     rg::util::elementf(2)};
+    using Layout = StaticVertexLayout<Attribute<ElementType::FLOAT, 2>,
+                                      Attribute<ElementType::FLOAT, 2>>;
 
-    return generate(vertices, sizeof(vertices), indices,
-                    sizeof(indices) / sizeof(*indices), layout);
+    return generate<Layout>(vertices, sizeof(vertices), indices,
+                            sizeof(indices) / sizeof(*indices));
 }
 
 std::shared_ptr<MeshVertexData> fullCube() {
@@ -51,9 +51,9 @@ std::shared_ptr<MeshVertexData> fullCube() {
                                            0, 3, 4, 0, 4, 7, 5, 4, 3, 5, 3, 2,
                                            5, 2, 1, 5, 1, 6, 5, 6, 7, 5, 7, 4};
 
-    static const VertexLayout layout{rg::util::elementf(3)};
-    return generate(vertices, sizeof(vertices), indices,
-                    sizeof(indices) / sizeof(*indices), layout);
+    using Layout = StaticVertexLayout<Attribute<ElementType::FLOAT, 3>>;
+    return generate<Layout>(vertices, sizeof(vertices), indices,
+                            sizeof(indices) / sizeof(*indices));
 }
 
 } // namespace rg::util
@@ -0,0 +1,307 @@
+#include <rg/util/json.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace rg::util {
+
+class Json::Parser {
+public:
+    explicit Parser(const std::string& source) : source_{source}, at_{0} {
+    }
+
+    Json document() {
+        Json value = parseValue();
+        skipWhitespace();
+        if (at_ != source_.size())
+            fail("trailing characters after the document");
+        return value;
+    }
+
+private:
+    const std::string& source_;
+    std::size_t at_;
+
+    [[noreturn]] void fail(const std::string& reason) const {
+        std::size_t line = 1;
+        for (std::size_t i = 0; i < at_ && i < source_.size(); ++i)
+            if (source_[i] == '\n')
+                ++line;
+        throw std::runtime_error{"JSON::PARSE: line " + std::to_string(line) +
+                                 ": " + reason};
+    }
+
+    void skipWhitespace() {
+        while (at_ < source_.size()) {
+            char c = source_[at_];
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+                ++at_;
+            else
+                break;
+        }
+    }
+
+    char peek() {
+        skipWhitespace();
+        if (at_ >= source_.size())
+            fail("unexpected end of input");
+        return source_[at_];
+    }
+
+    void consume(char expected) {
+        if (peek() != expected)
+            fail(std::string{"expected '"} + expected + "'");
+        ++at_;
+    }
+
+    void keyword(const char* word) {
+        for (const char* c = word; *c != '\0'; ++c, ++at_)
+            if (at_ >= source_.size() || source_[at_] != *c)
+                fail(std::string{"invalid literal, expected "} + word);
+    }
+
+    Json parseValue() {
+        Json value;
+        switch (peek()) {
+            case '{':
+                value.type_ = Type::OBJECT;
+                parseObject(value.object_);
+                break;
+            case '[':
+                value.type_ = Type::ARRAY;
+                parseArray(value.array_);
+                break;
+            case '"':
+                value.type_ = Type::STRING;
+                value.string_ = parseString();
+                break;
+            case 't':
+                keyword("true");
+                value.type_ = Type::BOOLEAN;
+                value.boolean_ = true;
+                break;
+            case 'f':
+                keyword("false");
+                value.type_ = Type::BOOLEAN;
+                value.boolean_ = false;
+                break;
+            case 'n':
+                keyword("null");
+                break;
+            default:
+                value.type_ = Type::NUMBER;
+                value.number_ = parseNumber();
+                break;
+        }
+        return value;
+    }
+
+    void parseObject(std::vector<Member>& members) {
+        consume('{');
+        if (peek() == '}') {
+            ++at_;
+            return;
+        }
+
+        while (true) {
+            if (peek() != '"')
+                fail("expected a string key");
+            std::string key = parseString();
+            consume(':');
+            members.emplace_back(std::move(key), parseValue());
+
+            if (peek() == ',') {
+                ++at_;
+                continue;
+            }
+            consume('}');
+            return;
+        }
+    }
+
+    void parseArray(std::vector<Json>& elements) {
+        consume('[');
+        if (peek() == ']') {
+            ++at_;
+            return;
+        }
+
+        while (true) {
+            elements.push_back(parseValue());
+            if (peek() == ',') {
+                ++at_;
+                continue;
+            }
+            consume(']');
+            return;
+        }
+    }
+
+    std::string parseString() {
+        consume('"');
+        std::string result;
+        while (true) {
+            if (at_ >= source_.size())
+                fail("unterminated string");
+            char c = source_[at_++];
+            if (c == '"')
+                return result;
+            if (c != '\\') {
+                result.push_back(c);
+                continue;
+            }
+
+            if (at_ >= source_.size())
+                fail("unterminated escape sequence");
+            char escaped = source_[at_++];
+            switch (escaped) {
+                case '"':
+                case '\\':
+                case '/':
+                    result.push_back(escaped);
+                    break;
+                case 'b':
+                    result.push_back('\b');
+                    break;
+                case 'f':
+                    result.push_back('\f');
+                    break;
+                case 'n':
+                    result.push_back('\n');
+                    break;
+                case 'r':
+                    result.push_back('\r');
+                    break;
+                case 't':
+                    result.push_back('\t');
+                    break;
+                case 'u':
+                    appendCodepoint(result);
+                    break;
+                default:
+                    fail("invalid escape sequence");
+            }
+        }
+    }
+
+    void appendCodepoint(std::string& result) {
+        if (at_ + 4 > source_.size())
+            fail("truncated unicode escape");
+        auto codepoint = static_cast<unsigned int>(
+                std::strtoul(source_.substr(at_, 4).c_str(), nullptr, 16));
+        at_ += 4;
+
+        // Surrogate pairs are not needed for our files, so only the basic
+        // multilingual plane is encoded
+        if (codepoint < 0x80) {
+            result.push_back(static_cast<char>(codepoint));
+        } else if (codepoint < 0x800) {
+            result.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+            result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        } else {
+            result.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+            result.push_back(
+                    static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            result.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    double parseNumber() {
+        const char* begin = source_.c_str() + at_;
+        char* end = nullptr;
+        double number = std::strtod(begin, &end);
+        if (end == begin)
+            fail("unexpected character");
+        at_ += static_cast<std::size_t>(end - begin);
+        return number;
+    }
+};
+
+Json::Json() : type_{Type::NUL}, boolean_{false}, number_{0.0} {
+}
+
+Json Json::parse(const std::string& source) {
+    return Parser{source}.document();
+}
+
+Json::Type Json::type() const {
+    return type_;
+}
+
+bool Json::is_null() const {
+    return type_ == Type::NUL;
+}
+
+void Json::expect(Type type) const {
+    static const char* names[] = {"null",   "boolean", "number",
+                                  "string", "array",   "object"};
+    if (type_ != type) {
+        throw std::runtime_error{
+                std::string{"JSON::TYPE: expected "} +
+                names[static_cast<int>(type)] + ", found " +
+                names[static_cast<int>(type_)]};
+    }
+}
+
+bool Json::as_bool() const {
+    expect(Type::BOOLEAN);
+    return boolean_;
+}
+
+double Json::as_number() const {
+    expect(Type::NUMBER);
+    return number_;
+}
+
+float Json::as_float() const {
+    return static_cast<float>(as_number());
+}
+
+int Json::as_int() const {
+    return static_cast<int>(as_number());
+}
+
+const std::string& Json::as_string() const {
+    expect(Type::STRING);
+    return string_;
+}
+
+const std::vector<Json>& Json::as_array() const {
+    expect(Type::ARRAY);
+    return array_;
+}
+
+const std::vector<Json::Member>& Json::as_object() const {
+    expect(Type::OBJECT);
+    return object_;
+}
+
+const Json* Json::find(const std::string& key) const {
+    for (const auto& [name, value] : as_object())
+        if (name == key)
+            return &value;
+    return nullptr;
+}
+
+const Json& Json::operator[](const std::string& key) const {
+    const Json* value = find(key);
+    if (value == nullptr)
+        throw std::runtime_error{"JSON::KEY: missing key \"" + key + "\""};
+    return *value;
+}
+
+const Json& Json::operator[](std::size_t index) const {
+    const auto& elements = as_array();
+    if (index >= elements.size())
+        throw std::runtime_error{"JSON::INDEX: index " +
+                                 std::to_string(index) + " out of range"};
+    return elements[index];
+}
+
+std::size_t Json::size() const {
+    if (type_ == Type::OBJECT)
+        return object_.size();
+    return as_array().size();
+}
+
+} // namespace rg::util
@@ -0,0 +1,17 @@
+#ifndef RG_TESTS_CHECK_HPP
+#define RG_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+
+// Unlike assert, checks stay in release builds. A failed one aborts the test.
+#define CHECK(condition)                                                      \
+    do {                                                                      \
+        if (!(condition)) {                                                   \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,       \
+                         __LINE__, #condition);                               \
+            std::abort();                                                     \
+        }                                                                     \
+    } while (false)
+
+#endif // RG_TESTS_CHECK_HPP
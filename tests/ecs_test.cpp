@@ -0,0 +1,98 @@
+#include <check.hpp>
+
+#include <rg/ecs/Registry.hpp>
+
+#include <string>
+
+namespace {
+
+struct Position {
+    float x;
+    float y;
+};
+
+struct Name {
+    std::string value;
+};
+
+void testPool() {
+    rg::ecs::Pool<Position> pool;
+    pool.emplace(4, 1.0f, 2.0f);
+    pool.emplace(7, 3.0f, 4.0f);
+    pool.emplace(2, 5.0f, 6.0f);
+    CHECK(pool.size() == 3);
+    CHECK(pool.contains(7) && !pool.contains(3));
+
+    // A second emplace replaces the component and keeps the set intact
+    pool.emplace(7, 8.0f, 9.0f);
+    CHECK(pool.size() == 3);
+    CHECK(pool.get(7).x == 8.0f && pool.get(7).y == 9.0f);
+
+    // The last element fills the hole
+    pool.remove(4);
+    CHECK(pool.size() == 2);
+    CHECK(!pool.contains(4));
+    CHECK(pool.get(2).x == 5.0f);
+    CHECK(pool.get(7).x == 8.0f);
+    for (std::size_t i = 0; i < pool.size(); ++i)
+        CHECK(pool.index(pool.entities()[i]) == i);
+
+    pool.remove(2);
+    pool.remove(7);
+    CHECK(pool.empty());
+}
+
+void testRegistry() {
+    rg::ecs::Registry registry;
+    for (int i = 0; i < 10; ++i) {
+        rg::ecs::Entity entity = registry.create();
+        registry.emplace<Position>(entity, static_cast<float>(i), 0.0f);
+        if (i % 2 == 1)
+            registry.emplace<Name>(entity, std::to_string(i));
+    }
+    CHECK(registry.alive() == 10);
+
+    int visited = 0;
+    registry.each<Name, Position>(
+            [&visited](rg::ecs::Entity entity, Name& name, Position& position) {
+                CHECK(entity % 2 == 1);
+                CHECK(name.value == std::to_string(entity));
+                CHECK(position.x == static_cast<float>(entity));
+                ++visited;
+            });
+    CHECK(visited == 5);
+
+    // Destroying removes every component and recycles the id
+    registry.destroy(3);
+    CHECK(!registry.valid(3));
+    CHECK(!registry.has<Position>(3) && !registry.has<Name>(3));
+    rg::ecs::Entity recycled = registry.create();
+    CHECK(recycled == 3);
+    CHECK(!registry.has<Position>(recycled));
+    CHECK(registry.alive() == 10);
+
+    registry.remove<Name>(5);
+    registry.remove<Name>(5);
+    CHECK(!registry.has<Name>(5) && registry.has<Position>(5));
+
+    visited = 0;
+    const auto& view = registry;
+    view.each<Position, Name>(
+            [&visited](rg::ecs::Entity, const Position&, const Name&) {
+                ++visited;
+            });
+    CHECK(visited == 3);
+    CHECK(view.get<Position>(9).x == 9.0f);
+
+    struct Unused {};
+    CHECK(view.find<Unused>() == nullptr);
+    CHECK(!view.has<Unused>(0));
+}
+
+} // namespace
+
+int main() {
+    testPool();
+    testRegistry();
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <check.hpp>
+
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/util/FileLoader.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+using rg::util::FileLoader;
+using rg::util::ResourcePack;
+
+const fs::path ROOT = fs::temp_directory_path() / "rg-test-loader";
+
+// Relative path to contents
+std::map<std::string, std::string> makeFiles() {
+    std::string large(1 << 20U, '\0');
+    for (std::size_t i = 0; i < large.size(); ++i)
+        large[i] = static_cast<char>('a' + i % 26);
+
+    std::map<std::string, std::string> files{{"empty.txt", ""},
+                                             {"large.bin", large}};
+    for (int i = 0; i < 40; ++i)
+        files["small" + std::to_string(i) + ".txt"] = std::to_string(i);
+    return files;
+}
+
+void writeFiles(const fs::path& directory,
+                const std::map<std::string, std::string>& files) {
+    fs::remove_all(directory);
+    for (const auto& [path, contents] : files) {
+        fs::path file = directory / path;
+        fs::create_directories(file.parent_path());
+        std::ofstream{file, std::ios::binary} << contents;
+    }
+}
+
+// Every done runs once, as a job counted on its counter, with the whole file
+void testSubmit(rg::JobSystem& jobs,
+                const std::map<std::string, std::string>& files) {
+    std::vector<std::string> paths;
+    for (const auto& file : files)
+        paths.push_back((ROOT / file.first).string());
+    paths.push_back((ROOT / "missing.txt").string());
+
+    std::vector<std::optional<std::string>> results(paths.size());
+    std::vector<std::atomic<int>> calls(paths.size());
+    rg::JobCounter counter;
+    std::vector<rg::util::FileJob> reads;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        auto done = [&results, &calls, i](
+                            std::optional<std::string_view> contents) {
+            if (contents)
+                results[i] = std::string{*contents};
+            ++calls[i];
+        };
+        reads.push_back({paths[i], done, &counter});
+    }
+    FileLoader::shared().submit(std::move(reads), &jobs);
+    jobs.wait(counter);
+
+    CHECK(counter.done());
+    std::size_t i = 0;
+    for (const auto& file : files) {
+        CHECK(calls[i] == 1);
+        CHECK(results[i] && *results[i] == file.second);
+        ++i;
+    }
+    CHECK(calls[i] == 1);
+    CHECK(!results[i]);
+}
+
+// Files in the mounted pack are handed over without a read
+void testSubmitPacked(rg::JobSystem& jobs,
+                      const std::map<std::string, std::string>& files) {
+    fs::path output = ROOT.parent_path() / "rg-test-loader.pack";
+    ResourcePack::write(ROOT.string(), output.string());
+    ResourcePack pack = ResourcePack::open(output.string());
+    ResourcePack::mount(pack, ROOT.string());
+    fs::remove(ROOT / "large.bin");
+
+    std::optional<std::string> result;
+    rg::JobCounter counter;
+    std::vector<rg::util::FileJob> reads{
+            {(ROOT / "large.bin").string(),
+             [&result](std::optional<std::string_view> contents) {
+                 if (contents)
+                     result = std::string{*contents};
+             },
+             &counter}};
+    FileLoader::shared().submit(std::move(reads), &jobs);
+    jobs.wait(counter);
+    ResourcePack::unmount();
+    fs::remove(output);
+
+    CHECK(result && *result == files.at("large.bin"));
+}
+
+void testReadFiles(const std::map<std::string, std::string>& files) {
+    std::vector<std::string> paths;
+    for (const auto& file : files)
+        paths.push_back((ROOT / file.first).string());
+    paths.push_back((ROOT / "missing.txt").string());
+
+    auto contents = FileLoader::shared().read_files(paths);
+    CHECK(contents.size() == paths.size());
+    std::size_t i = 0;
+    for (const auto& file : files) {
+        CHECK(contents[i] && *contents[i] == file.second);
+        ++i;
+    }
+    CHECK(!contents[i]);
+}
+
+} // namespace
+
+int main() {
+    auto files = makeFiles();
+    for (unsigned int workers : {0U, 3U}) {
+        writeFiles(ROOT, files);
+        rg::JobSystem jobs{workers};
+        testSubmit(jobs, files);
+        testReadFiles(files);
+        testSubmitPacked(jobs, files);
+    }
+    fs::remove_all(ROOT);
+    return 0;
+}
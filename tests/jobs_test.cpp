@@ -0,0 +1,118 @@
+#include <check.hpp>
+
+#include <rg/jobs/JobSystem.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Every index is visited exactly once, whatever the split
+void testParallelFor(rg::JobSystem& jobs) {
+    std::vector<std::atomic<int>> visits(10007);
+    for (std::size_t grain : {1, 64, 20000}) {
+        for (auto& count : visits)
+            count = 0;
+        jobs.parallel_for(visits.size(), grain,
+                          [&visits](std::size_t begin, std::size_t end) {
+                              for (std::size_t i = begin; i < end; ++i)
+                                  ++visits[i];
+                          });
+        for (const auto& count : visits)
+            CHECK(count == 1);
+    }
+}
+
+void testDependencies(rg::JobSystem& jobs) {
+    std::atomic<int> finished{0};
+    int seen = -1;
+    rg::JobCounter first;
+    rg::JobCounter second;
+    for (int i = 0; i < 100; ++i)
+        jobs.run([&finished] { ++finished; }, first);
+    jobs.run_after(first, [&finished, &seen] { seen = finished; }, second);
+    jobs.wait(second);
+    CHECK(first.done() && second.done());
+    CHECK(seen == 100);
+}
+
+// Each link is held until the one before it is done, so a slow job in the
+// middle of a chain cannot leave a worker waiting on a job further up its
+// own stack
+void testChainedDependencies(rg::JobSystem& jobs) {
+    for (int round = 0; round < 20; ++round) {
+        std::atomic<int> step{0};
+        rg::JobCounter a;
+        rg::JobCounter b;
+        rg::JobCounter c;
+        rg::JobCounter d;
+        auto link = [&step](int expected, int milliseconds) {
+            return [&step, expected, milliseconds] {
+                std::this_thread::sleep_for(
+                        std::chrono::milliseconds{milliseconds});
+                CHECK(step == expected);
+                ++step;
+            };
+        };
+        jobs.run(link(0, 5), a);
+        jobs.run_after(a, link(1, 2), b);
+        jobs.run_after(b, link(2, 0), c);
+        jobs.run_after(c, link(3, 0), d);
+        // Started once the dependency is already done
+        jobs.wait(b);
+        rg::JobCounter late;
+        jobs.run_after(b, [] {}, late);
+        jobs.wait(d);
+        jobs.wait(late);
+        CHECK(step == 4);
+    }
+}
+
+// Jobs may wait on the jobs they start
+void testNestedWait(rg::JobSystem& jobs) {
+    std::atomic<int> leaves{0};
+    rg::JobCounter outer;
+    for (int i = 0; i < 8; ++i) {
+        jobs.run(
+                [&jobs, &leaves] {
+                    rg::JobCounter inner;
+                    for (int j = 0; j < 8; ++j)
+                        jobs.run([&leaves] { ++leaves; }, inner);
+                    jobs.wait(inner);
+                },
+                outer);
+    }
+    jobs.wait(outer);
+    CHECK(leaves == 64);
+}
+
+// A thread without a deque submits through the shared queue and steals
+// while it waits
+void testForeignThread(rg::JobSystem& jobs) {
+    std::atomic<int> done{0};
+    std::thread thread{[&jobs, &done] {
+        rg::JobCounter counter;
+        for (int i = 0; i < 1000; ++i)
+            jobs.run([&done] { ++done; }, counter);
+        jobs.wait(counter);
+    }};
+    thread.join();
+    CHECK(done == 1000);
+}
+
+} // namespace
+
+int main() {
+    for (unsigned int workers : {0U, 1U, 3U}) {
+        rg::JobSystem jobs{workers};
+        CHECK(jobs.worker_count() == workers);
+        testParallelFor(jobs);
+        testDependencies(jobs);
+        testChainedDependencies(jobs);
+        testNestedWait(jobs);
+        testForeignThread(jobs);
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <check.hpp>
+
+#include <rg/renderer/buffer/RangeAllocator.hpp>
+
+namespace {
+
+using Range = rg::RangeAllocator::Range;
+
+void testFirstFit() {
+    rg::RangeAllocator allocator{100};
+    auto a = allocator.allocate(30);
+    auto b = allocator.allocate(30);
+    auto c = allocator.allocate(30);
+    CHECK(a && a->offset == 0);
+    CHECK(b && b->offset == 30);
+    CHECK(c && c->offset == 60);
+    CHECK(allocator.used() == 90);
+    CHECK(!allocator.allocate(11));
+
+    // The first hole large enough is reused
+    allocator.free(*a);
+    auto d = allocator.allocate(10);
+    CHECK(d && d->offset == 0);
+    auto e = allocator.allocate(15);
+    CHECK(e && e->offset == 10);
+    auto f = allocator.allocate(8);
+    CHECK(f && f->offset == 90);
+    CHECK(allocator.used() == 93);
+}
+
+// Freed neighbours merge, so the whole space can be allocated again
+void testCoalescing() {
+    rg::RangeAllocator allocator{40};
+    Range ranges[4];
+    for (auto& range : ranges)
+        range = *allocator.allocate(10);
+
+    // Merge with the next, then the previous, then both
+    allocator.free(ranges[2]);
+    allocator.free(ranges[1]);
+    allocator.free(ranges[3]);
+    allocator.free(ranges[0]);
+    CHECK(allocator.used() == 0);
+    auto all = allocator.allocate(40);
+    CHECK(all && all->offset == 0 && all->size == 40);
+}
+
+void testGrow() {
+    rg::RangeAllocator allocator{0};
+    CHECK(!allocator.allocate(1));
+    CHECK(allocator.allocate(0));
+
+    allocator.grow(16);
+    auto a = allocator.allocate(12);
+    CHECK(a && a->offset == 0);
+
+    // The new space merges with the free tail
+    allocator.grow(32);
+    CHECK(allocator.capacity() == 32);
+    CHECK(allocator.used() == 12);
+    auto b = allocator.allocate(20);
+    CHECK(b && b->offset == 12);
+
+    allocator.grow(8);
+    CHECK(allocator.capacity() == 32);
+}
+
+} // namespace
+
+int main() {
+    testFirstFit();
+    testCoalescing();
+    testGrow();
+    return 0;
+}
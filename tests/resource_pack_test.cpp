@@ -0,0 +1,110 @@
+#include <check.hpp>
+
+#include <rg/util/FileLoader.hpp>
+#include <rg/util/ResourcePack.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+namespace fs = std::filesystem;
+using rg::util::ResourcePack;
+
+const fs::path ROOT = fs::temp_directory_path() / "rg-test-pack";
+
+// Relative path to contents
+std::map<std::string, std::string> makeFiles() {
+    std::string large(3 << 20U, '\0');
+    for (std::size_t i = 0; i < large.size(); ++i)
+        large[i] = static_cast<char>('a' + i % 26);
+
+    return {{"shaders/cull.cs.glsl", "#version 460 core\n"},
+            {"objects/ball/ball.obj", "v 0 0 0\n"},
+            {"empty.txt", ""},
+            {"textures/large.bin", large}};
+}
+
+void writeFiles(const fs::path& directory,
+                const std::map<std::string, std::string>& files) {
+    fs::remove_all(directory);
+    for (const auto& [path, contents] : files) {
+        fs::path file = directory / path;
+        fs::create_directories(file.parent_path());
+        std::ofstream{file, std::ios::binary} << contents;
+    }
+}
+
+void checkPack(const ResourcePack& pack,
+               const std::map<std::string, std::string>& files) {
+    CHECK(pack.file_count() == files.size());
+    for (const auto& [path, contents] : files) {
+        auto found = pack.find(path);
+        CHECK(found && *found == contents);
+    }
+    CHECK(!pack.find("missing.txt"));
+    CHECK(!pack.find("shaders"));
+}
+
+void testRoundTrip() {
+    auto files = makeFiles();
+    fs::path directory = ROOT / "res";
+    fs::path output = ROOT / "res.pack";
+    writeFiles(directory, files);
+    ResourcePack::write(directory.string(), output.string());
+
+    ResourcePack mapped = ResourcePack::open(output.string());
+    CHECK(mapped.is_mapped());
+    CHECK(mapped.size() == fs::file_size(output));
+    checkPack(mapped, files);
+
+    // Large enough to take several reads
+    auto loader = rg::util::FileLoader::create();
+    ResourcePack read = ResourcePack::read(output.string(), *loader);
+    CHECK(!read.is_mapped());
+    checkPack(read, files);
+
+    ResourcePack moved = std::move(read);
+    checkPack(moved, files);
+
+    // Loaders join paths themselves
+    ResourcePack::mount(mapped, directory.string());
+    auto shader = ResourcePack::lookup(
+            (directory / "shaders/./cull.cs.glsl").string());
+    CHECK(shader && *shader == files["shaders/cull.cs.glsl"]);
+    CHECK(!ResourcePack::lookup((ROOT / "elsewhere.txt").string()));
+    ResourcePack::unmount();
+    CHECK(!ResourcePack::lookup((directory / "empty.txt").string()));
+}
+
+void testMalformed() {
+    fs::path output = ROOT / "res.pack";
+    fs::resize_file(output, fs::file_size(output) - 1);
+    bool thrown = false;
+    try {
+        (void)ResourcePack::open(output.string());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    thrown = false;
+    try {
+        (void)ResourcePack::open((ROOT / "missing.pack").string());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testMalformed();
+    fs::remove_all(ROOT);
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <check.hpp>
+
+#include <rg/scene/SceneFile.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+using rg::scene::SceneFile;
+
+const char* const SOURCE = R"({
+  "models": { "ball": "objects/ball.obj", "lamp": "objects/lamp.obj" },
+  "lights": {
+    "directional": [{ "direction": [-2.0, -1.0, 3.0] }],
+    "point": [{ "position": [1.0, 2.0, 3.0] }],
+    "spot": [{ "cutoff": 60.0, "follow_camera": true }]
+  },
+  "objects": [
+    { "model": "ball", "position": [0.0, 1.0, 0.0],
+      "rigid_body": { "velocity": [1.0, 0.0, 0.0], "radius": 0.5 } },
+    { "model": "lamp", "scale": 2.0, "emissive": true,
+      "light": { "offset": [0.0, 1.0, 0.0], "color": { "diffuse": 0.5 } } }
+  ],
+  "floors": [{ "model": "lamp", "width": 3, "height": 4 }],
+  "cameras": [{ "position": [0.0, 1.0, 5.0], "fov": 45.0 }]
+})";
+
+bool near(float a, float b) {
+    return std::fabs(a - b) < 1e-5f;
+}
+
+std::filesystem::path write(const std::string& name,
+                            const std::vector<std::byte>& bytes) {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+template <class F>
+bool throws(F&& f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void checkScene(const SceneFile& scene) {
+    CHECK(scene.models().size() == 2);
+    CHECK(scene.string(scene.models()[0].name) == "ball");
+    CHECK(scene.string(scene.models()[1].path) == "objects/lamp.obj");
+
+    CHECK(scene.objects().size() == 2);
+    const auto& ball = scene.objects()[0];
+    CHECK(ball.model == 0);
+    CHECK(ball.flags == rg::scene::OBJECT_RIGID_BODY);
+    CHECK(ball.transform.position[1] == 1.0f);
+    CHECK(ball.velocity[0] == 1.0f && ball.radius == 0.5f);
+
+    // Attached lights come after the free-standing ones
+    const auto& lamp = scene.objects()[1];
+    CHECK(lamp.flags ==
+          (rg::scene::OBJECT_EMISSIVE | rg::scene::OBJECT_LIGHT));
+    CHECK(lamp.transform.scale[0] == 2.0f && lamp.transform.scale[2] == 2.0f);
+    CHECK(lamp.spotlight == 1);
+    CHECK(lamp.light_offset[1] == 1.0f);
+
+    CHECK(scene.floors().size() == 1);
+    CHECK(scene.floors()[0].width == 3 && scene.floors()[0].height == 4);
+
+    CHECK(scene.directional_lights().size() == 1);
+    CHECK(scene.directional_lights()[0].direction[2] == 3.0f);
+    CHECK(scene.point_lights().size() == 1);
+    CHECK(scene.point_lights()[0].position[1] == 2.0f);
+
+    CHECK(scene.spotlights().size() == 2);
+    const auto& spotlight = scene.spotlights()[0];
+    CHECK(near(spotlight.cutoff_angle, 0.5f));
+    CHECK(spotlight.direction[2] == -1.0f);
+    CHECK(spotlight.flags == rg::scene::SPOTLIGHT_FOLLOW_CAMERA);
+    CHECK(scene.spotlights()[1].color.diffuse[1] == 0.5f);
+
+    CHECK(scene.cameras().size() == 1);
+    CHECK(scene.cameras()[0].fov == 45.0f);
+    CHECK(scene.cameras()[0].z_far == 50.0f);
+}
+
+void testRoundTrip() {
+    std::vector<std::byte> bytes = SceneFile::compile(SOURCE);
+    auto binary = write("rg-test-scene.rgs", bytes);
+    checkScene(SceneFile::open(binary.string()));
+
+    auto source = std::filesystem::temp_directory_path() / "rg-test-scene.json";
+    std::ofstream{source} << SOURCE;
+    SceneFile compiled = SceneFile::open(source.string());
+    checkScene(compiled);
+
+    // Moving keeps the records readable
+    SceneFile moved = std::move(compiled);
+    checkScene(moved);
+
+    std::filesystem::remove(binary);
+    std::filesystem::remove(source);
+}
+
+void testMalformed() {
+    CHECK(throws([] {
+        (void)SceneFile::compile(R"({ "objects": [{ "model": "nope" }] })");
+    }));
+
+    std::vector<std::byte> bytes = SceneFile::compile(SOURCE);
+    bytes.pop_back();
+    auto truncated = write("rg-test-truncated.rgs", bytes);
+    CHECK(throws([&truncated] { SceneFile::open(truncated.string()); }));
+    std::filesystem::remove(truncated);
+
+    bytes = SceneFile::compile(SOURCE);
+    bytes[0] = std::byte{0};
+    auto foreign = write("rg-test-foreign.rgs", bytes);
+    CHECK(throws([&foreign] { SceneFile::open(foreign.string()); }));
+    std::filesystem::remove(foreign);
+
+    CHECK(throws([] { SceneFile::open("rg-test-missing.rgs"); }));
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testMalformed();
+    return 0;
+}
@@ -0,0 +1,150 @@
+// rg-bench-jobs: reports how the per-frame CPU work scales with the number
+// of job system threads. The workload mirrors the frame: physics, world
+// matrices and bounds, then culling for four cameras.
+//
+//   rg-bench-jobs [objects] [frames]
+
+#include <rg/jobs/JobSystem.hpp>
+#include <rg/renderer/camera/Frustum.hpp>
+#include <rg/renderer/camera/View.hpp>
+#include <rg/renderer/model/BoundingSphere.hpp>
+#include <rg/renderer/model/Transform.hpp>
+
+#include <glm/glm.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t GRAIN = 512;
+
+struct World {
+    std::vector<rg::Transform> transforms;
+    std::vector<glm::vec3> velocities;
+    std::vector<glm::mat4> model_matrices;
+    std::vector<glm::mat4> normal_matrices;
+    std::vector<rg::BoundingSphere> bounds;
+    std::array<std::vector<std::size_t>, 4> visible;
+};
+
+World makeWorld(std::size_t count) {
+    World world;
+    world.transforms.resize(count);
+    world.velocities.resize(count, glm::vec3{0.0f});
+    world.model_matrices.resize(count);
+    world.normal_matrices.resize(count);
+    world.bounds.resize(count);
+
+    auto side = static_cast<std::size_t>(std::ceil(std::sqrt(count)));
+    for (std::size_t i = 0; i < count; ++i) {
+        auto& transform = world.transforms[i];
+        transform.position = glm::vec3{0.6f * static_cast<float>(i % side),
+                                       1.0f + 0.5f * static_cast<float>(i % 7),
+                                       0.6f * static_cast<float>(i / side)};
+        transform.scale = glm::vec3{0.25f};
+    }
+    return world;
+}
+
+void frame(World& world, rg::JobSystem& jobs,
+           const std::array<rg::View, 4>& views) {
+    static constexpr glm::vec3 g = glm::vec3{0.0f, -9.81f, 0.0f};
+    static constexpr float delta = 1.0f / 60.0f;
+    static constexpr float radius = 0.25f;
+    std::size_t count = world.transforms.size();
+
+    jobs.parallel_for(count, GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto& velocity = world.velocities[i];
+            auto& position = world.transforms[i].position;
+            velocity += delta * g;
+            position += delta * velocity;
+            if (position.y <= radius) {
+                velocity = -velocity;
+                position.y = radius + (radius - position.y);
+            }
+        }
+    });
+
+    static const rg::BoundingSphere unit{glm::vec3{0.0f}, 1.0f};
+    jobs.parallel_for(count, GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            auto& model = world.model_matrices[i];
+            model = world.transforms[i].get_model_matrix();
+            world.normal_matrices[i] =
+                    glm::transpose(glm::inverse(glm::mat3{model}));
+            world.bounds[i] = unit.transformed(model);
+        }
+    });
+
+    rg::JobCounter counter;
+    for (std::size_t camera = 0; camera < views.size(); ++camera) {
+        jobs.run(
+                [&world, &views, &jobs, camera, count] {
+                    rg::Frustum frustum{views[camera]};
+                    std::size_t chunk_count = (count + GRAIN - 1) / GRAIN;
+                    std::vector<std::vector<std::size_t>> chunks(chunk_count);
+                    jobs.parallel_for(count, GRAIN, [&](std::size_t begin,
+                                                        std::size_t end) {
+                        auto& chunk = chunks[begin / GRAIN];
+                        for (std::size_t i = begin; i < end; ++i)
+                            if (frustum.intersects(world.bounds[i]))
+                                chunk.push_back(i);
+                    });
+
+                    auto& visible = world.visible[camera];
+                    visible.clear();
+                    for (const auto& chunk : chunks)
+                        visible.insert(visible.end(), chunk.begin(),
+                                       chunk.end());
+                },
+                counter);
+    }
+    jobs.wait(counter);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t objects = argc > 1 ? std::stoul(argv[1]) : 100000;
+    unsigned int frames = argc > 2 ? std::stoul(argv[2]) : 100;
+
+    std::array<rg::View, 4> views;
+    for (unsigned int i = 0; i < 4; ++i) {
+        float angle = glm::radians(45.0f + 90.0f * static_cast<float>(i));
+        views[i].position = glm::vec3{0.0f, 10.0f, 0.0f};
+        views[i].direction = glm::normalize(
+                glm::vec3{std::cos(angle), -0.5f, std::sin(angle)});
+        views[i].z_far = 500.0f;
+    }
+
+    unsigned int threads = rg::JobSystem::defaultWorkerCount() + 1;
+    double baseline = 0.0;
+    spdlog::info("rg-bench-jobs: {} objects, {} frames", objects, frames);
+    for (unsigned int t = 1; t <= threads; ++t) {
+        World world = makeWorld(objects);
+        rg::JobSystem jobs{t - 1};
+
+        // Warm up the caches and the allocator
+        frame(world, jobs, views);
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < frames; ++i)
+            frame(world, jobs, views);
+        std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+
+        double per_frame = elapsed.count() / frames;
+        if (t == 1)
+            baseline = per_frame;
+        spdlog::info("{:2} threads: {:8.3f} ms/frame, {:5.2f}x", t, per_frame,
+                     baseline / per_frame);
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+// rg-pack: packs the resource directory into a single file, which the
+// application maps at startup instead of opening every file on its own.
+//
+//   rg-pack <directory> <resources.pack>
+
+#include <rg/util/ResourcePack.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        spdlog::error("usage: rg-pack <directory> <resources.pack>");
+        return 1;
+    }
+
+    try {
+        rg::util::ResourcePack::write(argv[1], argv[2]);
+        // Check that the result loads the same way the application loads it
+        auto pack = rg::util::ResourcePack::open(argv[2]);
+        spdlog::info("rg-pack: {} -> {} ({} files, {} bytes)", argv[1],
+                     argv[2], pack.file_count(), pack.size());
+        return 0;
+    } catch (const std::exception& e) {
+        spdlog::error("rg-pack: {}", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,130 @@
+// rg-scenec: compiles JSON scene descriptions into the binary scene layout,
+// and generates large synthetic scenes for benchmarking.
+//
+//   rg-scenec <scene.json> <scene.rgs>
+//   rg-scenec --generate <objects> <scene.json>
+
+#include <rg/scene/SceneFile.hpp>
+
+#include <spdlog/spdlog.h>
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int usage() {
+    spdlog::error("usage: rg-scenec <scene.json> <scene.rgs>\n"
+                  "       rg-scenec --generate <objects> <scene.json>");
+    return 1;
+}
+
+int compile(const std::string& input, const std::string& output) {
+    std::ifstream in{input};
+    if (!in) {
+        spdlog::error("rg-scenec: cannot open {}", input);
+        return 1;
+    }
+    std::stringstream source;
+    source << in.rdbuf();
+
+    auto binary = rg::scene::SceneFile::compile(source.str());
+    std::ofstream out{output, std::ios::binary};
+    out.write(reinterpret_cast<const char*>(binary.data()),
+              static_cast<std::streamsize>(binary.size()));
+    if (!out) {
+        spdlog::error("rg-scenec: cannot write {}", output);
+        return 1;
+    }
+
+    // Check that the result loads the same way the application loads it
+    auto scene = rg::scene::SceneFile::open(output);
+    spdlog::info("rg-scenec: {} -> {} ({} bytes, {} objects, {} floors)",
+                 input, output, binary.size(), scene.objects().size(),
+                 scene.floors().size());
+    return 0;
+}
+
+// The court scene with a square grid of bouncing balls above it
+int generate(unsigned int count, const std::string& output) {
+    std::ofstream out{output};
+    if (!out) {
+        spdlog::error("rg-scenec: cannot write {}", output);
+        return 1;
+    }
+
+    out << R"({
+  "models": {
+    "ball": "objects/ball/ball.obj",
+    "court-tile": "objects/court-tile/tile.obj"
+  },
+  "lights": {
+    "directional": [
+      { "direction": [-2.0, -1.0, 3.0],
+        "color": { "ambient": 0.1, "diffuse": 0.3, "specular": 0.3 } }
+    ],
+    "spot": [
+      { "cutoff": 20.0, "weaken": 15.0,
+        "attenuation": { "constant": 1.0, "linear": 0.22, "quadratic": 0.2 },
+        "color": { "ambient": 0.1, "diffuse": [0.0, 1.0, 0.5],
+                   "specular": [0.0, 1.0, 0.5] },
+        "follow_camera": true }
+    ]
+  },
+  "objects": [
+)";
+
+    auto side = static_cast<unsigned int>(std::ceil(std::sqrt(count)));
+    const float spacing = 0.6f;
+    float extent = spacing * static_cast<float>(side) / 2.0f;
+    for (unsigned int i = 0; i < count; ++i) {
+        float x = spacing * static_cast<float>(i % side) - extent;
+        float z = spacing * static_cast<float>(i / side) - extent;
+        float y = 1.0f + 0.5f * static_cast<float>(i % 7);
+        out << "    { \"model\": \"ball\", \"position\": [" << x << ", " << y
+            << ", " << z << "], \"rigid_body\": { \"radius\": 0.25 } }"
+            << (i + 1 < count ? ",\n" : "\n");
+    }
+
+    auto floor_size = static_cast<int>(std::ceil(extent)) + 1;
+    out << R"(  ],
+  "floors": [
+    { "model": "court-tile", "width": )"
+        << floor_size << ", \"height\": " << floor_size
+        << R"(, "shininess": 12.0 }
+  ],
+  "cameras": [
+    { "position": [-2.5, 2.5, -2.5], "direction": [2.5, -1.5, 2.5] },
+    { "position": [-0.5, 1.5, 0.5], "direction": [0.5, -0.7, -0.5] },
+    { "position": [0.5, 1.5, -0.5], "direction": [-0.5, -0.7, 0.5] },
+    { "position": [0.5, 1.5, 0.5], "direction": [-0.5, -0.7, -0.5] }
+  ]
+}
+)";
+
+    spdlog::info("rg-scenec: generated {} objects into {}", count, output);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3 && argc != 4)
+        return usage();
+
+    try {
+        if (std::string{argv[1]} == "--generate") {
+            if (argc != 4)
+                return usage();
+            return generate(std::stoul(argv[2]), argv[3]);
+        }
+        if (argc != 3)
+            return usage();
+        return compile(argv[1], argv[2]);
+    } catch (const std::exception& e) {
+        spdlog::error("rg-scenec: {}", e.what());
+        return 1;
+    }
+}